@@ -3,6 +3,7 @@
 #include <api/prog_info.h>
 
 #include <api/pthread.h>
+#include <api/signal.h>
 #include <api/malloc.h>
 
 /* symbols from user.ld */
@@ -18,6 +19,7 @@ prog_info_t pi =
 	.entry =	PROG_START_FUNC,
 	.param =	NULL,
 	.exit =		pthread_exit,
+	.sigev_worker =	sigev_worker,
 	.prio =		THR_DEFAULT_PRIO,
 
 	.heap_size =	HEAP_SIZE,
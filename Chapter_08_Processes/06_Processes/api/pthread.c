@@ -6,6 +6,7 @@
 #include <api/syscall.h>
 #include <api/errno.h>
 #include <types/basic.h>
+#include <arch/processor.h>
 
 /*! Thread creation/exit/wait/cancel ---------------------------------------- */
 
@@ -31,7 +32,7 @@ pthread_t pthread_self (void)
 {
 	pthread_t self;
 
-	self.ptr = NULL;
+	self.index = -1;
 	self.id = 0;
 
 	syscall ( PTHREAD_SELF, &self );
@@ -52,6 +53,9 @@ int pthread_attr_init ( pthread_attr_t *attr )
 	attr->stackaddr = NULL;
 	attr->stacksize = 0;
 
+	attr->sigev_threads = 0;
+	attr->timer_slack = -1;
+
 	return EXIT_SUCCESS;
 }
 
@@ -71,6 +75,34 @@ int pthread_attr_setschedpolicy ( pthread_attr_t *attr, int policy )
 	return EXIT_SUCCESS;
 }
 
+/*!
+ * Set number of threads in process pool for SIGEV_THREAD notifications
+ * (attributes are given in sigev_notify_attributes; non-POSIX)
+ */
+int pthread_attr_setsigevthreads_np ( pthread_attr_t *attr, uint threads )
+{
+	ASSERT_ERRNO_AND_RETURN ( attr && threads > 0, EINVAL );
+
+	attr->sigev_threads = threads;
+
+	return EXIT_SUCCESS;
+}
+
+/*!
+ * Set default timer slack for thread (in microseconds; non-POSIX): its
+ * timers and sleeps may expire that much later, together with other timers
+ */
+int pthread_attr_settimerslack_np ( pthread_attr_t *attr, int slack )
+{
+	ASSERT_ERRNO_AND_RETURN ( attr, EINVAL );
+	ASSERT_ERRNO_AND_RETURN ( slack >= 0 && slack <= TIMER_SLACK_MAX,
+				  EINVAL );
+
+	attr->timer_slack = slack;
+
+	return EXIT_SUCCESS;
+}
+
 int pthread_attr_setschedparam ( pthread_attr_t *attr,
 				 struct sched_param *param )
 {
@@ -115,31 +147,95 @@ int posix_spawn ( pid_t *pid, char *path, void *file_actions,
 }
 
 
-/*! Mutex */
+/*! Futex - wait/wake on word in process memory */
+int futex_wait ( int *futex, int val )
+{
+	ASSERT_ERRNO_AND_RETURN ( futex, EINVAL );
+	return syscall ( FUTEX_WAIT, futex, val );
+}
+int futex_wake ( int *futex, int n )
+{
+	ASSERT_ERRNO_AND_RETURN ( futex, EINVAL );
+	return syscall ( FUTEX_WAKE, futex, n );
+}
+
+/*!
+ * Mutex
+ * Private mutexes are implemented in user space with futex word (syscall only
+ * when thread must block or when there are blocked threads to wake);
+ * process shared mutexes and mutexes with priority protocols (inheritance,
+ * ceiling) use kernel object.
+ */
 int pthread_mutex_init ( pthread_mutex_t *mutex, pthread_mutexattr_t *attr )
 {
 	ASSERT_ERRNO_AND_RETURN ( mutex, EINVAL );
-	return syscall ( PTHREAD_MUTEX_INIT, mutex, attr );
+
+	mutex->lock = 0;
+	mutex->flags = attr ? attr->flags : 0;
+	mutex->kobj.id = 0;
+	mutex->kobj.index = -1;
+
+	if ( mutex->flags & PTHREAD_MUTEX_KOBJECT )
+		return syscall ( PTHREAD_MUTEX_INIT, &mutex->kobj, attr );
+
+	return EXIT_SUCCESS;
 }
 int pthread_mutex_destroy ( pthread_mutex_t * mutex )
 {
 	ASSERT_ERRNO_AND_RETURN ( mutex, EINVAL );
-	return syscall ( PTHREAD_MUTEX_DESTROY, mutex );
+
+	if ( mutex->flags & PTHREAD_MUTEX_KOBJECT )
+		return syscall ( PTHREAD_MUTEX_DESTROY, &mutex->kobj );
+
+	ASSERT_ERRNO_AND_RETURN ( mutex->lock == 0, EBUSY );
+	return EXIT_SUCCESS;
 }
 int pthread_mutex_lock ( pthread_mutex_t *mutex )
 {
+	int c;
+
 	ASSERT_ERRNO_AND_RETURN ( mutex, EINVAL );
-	return syscall ( PTHREAD_MUTEX_LOCK, mutex );
+
+	if ( mutex->flags & PTHREAD_MUTEX_KOBJECT )
+		return syscall ( PTHREAD_MUTEX_LOCK, &mutex->kobj );
+
+	/* fast path: 0 -> 1 */
+	c = atomic_cmpxchg ( &mutex->lock, 0, 1 );
+	if ( c == 0 )
+		return EXIT_SUCCESS;
+
+	/* mark "locked with waiters" and block until unlocked */
+	if ( c != 2 )
+		c = atomic_xchg ( &mutex->lock, 2 );
+	while ( c != 0 )
+	{
+		futex_wait ( &mutex->lock, 2 );
+		c = atomic_xchg ( &mutex->lock, 2 );
+	}
+
+	return EXIT_SUCCESS;
 }
 int pthread_mutex_unlock ( pthread_mutex_t *mutex )
 {
 	ASSERT_ERRNO_AND_RETURN ( mutex, EINVAL );
-	return syscall ( PTHREAD_MUTEX_UNLOCK, mutex );
+
+	if ( mutex->flags & PTHREAD_MUTEX_KOBJECT )
+		return syscall ( PTHREAD_MUTEX_UNLOCK, &mutex->kobj );
+
+	/* fast path: 1 -> 0; otherwise there may be blocked threads */
+	if ( atomic_add ( &mutex->lock, -1 ) != 1 )
+	{
+		mutex->lock = 0;
+		futex_wake ( &mutex->lock, 1 );
+	}
+
+	return EXIT_SUCCESS;
 }
 int pthread_mutexattr_init ( pthread_mutexattr_t *attr )
 {
 	ASSERT_ERRNO_AND_RETURN ( attr, EINVAL );
-	*( (uint*) attr ) = 0;
+	attr->flags = 0;
+	attr->prioceiling = 0;
 	return EXIT_SUCCESS;
 }
 int pthread_mutexattr_destroy ( pthread_mutexattr_t *attr )
@@ -147,37 +243,124 @@ int pthread_mutexattr_destroy ( pthread_mutexattr_t *attr )
 	ASSERT_ERRNO_AND_RETURN ( attr, EINVAL );
 	return EXIT_SUCCESS;
 }
+int pthread_mutexattr_setprotocol ( pthread_mutexattr_t *attr, int protocol )
+{
+	ASSERT_ERRNO_AND_RETURN ( attr, EINVAL );
+	ASSERT_ERRNO_AND_RETURN ( protocol == PTHREAD_PRIO_NONE ||
+				  protocol == PTHREAD_PRIO_INHERIT ||
+				  protocol == PTHREAD_PRIO_PROTECT, EINVAL );
 
-/*! Condition variable */
+	attr->flags = ( attr->flags & ~PTHREAD_PRIO_MASK ) | protocol;
+	return EXIT_SUCCESS;
+}
+int pthread_mutexattr_getprotocol ( pthread_mutexattr_t *attr, int *protocol )
+{
+	ASSERT_ERRNO_AND_RETURN ( attr && protocol, EINVAL );
+	*protocol = attr->flags & PTHREAD_PRIO_MASK;
+	return EXIT_SUCCESS;
+}
+int pthread_mutexattr_setprioceiling ( pthread_mutexattr_t *attr,
+				       int prioceiling )
+{
+	ASSERT_ERRNO_AND_RETURN ( attr, EINVAL );
+	ASSERT_ERRNO_AND_RETURN ( prioceiling >= THREAD_MIN_PRIO &&
+				  prioceiling <= THREAD_MAX_PRIO, EINVAL );
+
+	attr->prioceiling = prioceiling;
+	return EXIT_SUCCESS;
+}
+int pthread_mutexattr_getprioceiling ( pthread_mutexattr_t *attr,
+				       int *prioceiling )
+{
+	ASSERT_ERRNO_AND_RETURN ( attr && prioceiling, EINVAL );
+	*prioceiling = attr->prioceiling;
+	return EXIT_SUCCESS;
+}
+
+/*! Condition variable (futex word is sequence number) */
 int pthread_cond_init ( pthread_cond_t *cond, pthread_condattr_t *attr )
 {
 	ASSERT_ERRNO_AND_RETURN ( cond, EINVAL );
-	return syscall ( PTHREAD_COND_INIT, cond );
+
+	cond->seq = 0;
+	cond->waiters = 0;
+	cond->flags = attr ? attr->flags : 0;
+	cond->kobj.id = 0;
+	cond->kobj.index = -1;
+
+	if ( cond->flags & PTHREAD_PROCESS_SHARED )
+		return syscall ( PTHREAD_COND_INIT, &cond->kobj );
+
+	return EXIT_SUCCESS;
 }
 int pthread_cond_destroy ( pthread_cond_t *cond )
 {
 	ASSERT_ERRNO_AND_RETURN ( cond, EINVAL );
-	return syscall ( PTHREAD_COND_DESTROY, cond );
+
+	if ( cond->flags & PTHREAD_PROCESS_SHARED )
+		return syscall ( PTHREAD_COND_DESTROY, &cond->kobj );
+
+	ASSERT_ERRNO_AND_RETURN ( cond->waiters == 0, EBUSY );
+	return EXIT_SUCCESS;
 }
 int pthread_cond_wait ( pthread_cond_t *cond, pthread_mutex_t *mutex )
 {
+	int seq;
+
 	ASSERT_ERRNO_AND_RETURN ( cond && mutex, EINVAL );
-	return syscall ( PTHREAD_COND_WAIT, cond, mutex );
+
+	if ( cond->flags & PTHREAD_PROCESS_SHARED )
+	{
+		ASSERT_ERRNO_AND_RETURN (
+			mutex->flags & PTHREAD_MUTEX_KOBJECT, EINVAL );
+		return syscall ( PTHREAD_COND_WAIT, &cond->kobj, &mutex->kobj );
+	}
+
+	/* signal after mutex is released changes 'seq' - futex_wait returns */
+	seq = cond->seq;
+	atomic_add ( &cond->waiters, 1 );
+	pthread_mutex_unlock ( mutex );
+
+	futex_wait ( &cond->seq, seq );
+
+	atomic_add ( &cond->waiters, -1 );
+	return pthread_mutex_lock ( mutex );
 }
 int pthread_cond_signal ( pthread_cond_t *cond )
 {
 	ASSERT_ERRNO_AND_RETURN ( cond, EINVAL );
-	return syscall ( PTHREAD_COND_SIGNAL, cond );
+
+	if ( cond->flags & PTHREAD_PROCESS_SHARED )
+		return syscall ( PTHREAD_COND_SIGNAL, &cond->kobj );
+
+	if ( cond->waiters )
+	{
+		atomic_add ( &cond->seq, 1 );
+		futex_wake ( &cond->seq, 1 );
+	}
+
+	return EXIT_SUCCESS;
 }
 int pthread_cond_broadcast ( pthread_cond_t *cond )
 {
 	ASSERT_ERRNO_AND_RETURN ( cond, EINVAL );
-	return syscall ( PTHREAD_COND_BROADCAST, cond );
+
+	if ( cond->flags & PTHREAD_PROCESS_SHARED )
+		return syscall ( PTHREAD_COND_BROADCAST, &cond->kobj );
+
+	if ( cond->waiters )
+	{
+		atomic_add ( &cond->seq, 1 );
+		futex_wake ( &cond->seq, cond->waiters );
+	}
+
+	return EXIT_SUCCESS;
 }
 
 int pthread_condattr_init ( pthread_condattr_t *attr )
 {
 	ASSERT_ERRNO_AND_RETURN ( attr, EINVAL );
+	attr->flags = 0;
 	return EXIT_SUCCESS;
 }
 int pthread_condattr_destroy ( pthread_condattr_t *attr )
@@ -186,26 +369,69 @@ int pthread_condattr_destroy ( pthread_condattr_t *attr )
 	return EXIT_SUCCESS;
 }
 
-/*! Semaphore */
+/*! Semaphore (futex word is semaphore value; kernel object if pshared) */
 int sem_init ( sem_t *sem, int pshared, int value )
 {
-	ASSERT_ERRNO_AND_RETURN ( sem, EINVAL );
-	return syscall ( SEM_INIT, sem, pshared, value );
+	ASSERT_ERRNO_AND_RETURN ( sem && value >= 0, EINVAL );
+
+	sem->value = value;
+	sem->waiters = 0;
+	sem->flags = pshared ? PTHREAD_PROCESS_SHARED : 0;
+	sem->kobj.id = 0;
+	sem->kobj.index = -1;
+
+	if ( pshared )
+		return syscall ( SEM_INIT, &sem->kobj, pshared, value );
+
+	return EXIT_SUCCESS;
 }
 int sem_destroy ( sem_t *sem )
 {
 	ASSERT_ERRNO_AND_RETURN ( sem, EINVAL );
-	return syscall ( SEM_DESTROY, sem );
+
+	if ( sem->flags & PTHREAD_PROCESS_SHARED )
+		return syscall ( SEM_DESTROY, &sem->kobj );
+
+	ASSERT_ERRNO_AND_RETURN ( sem->waiters == 0, ENOTEMPTY );
+	return EXIT_SUCCESS;
 }
 int sem_post ( sem_t *sem )
 {
 	ASSERT_ERRNO_AND_RETURN ( sem, EINVAL );
-	return syscall ( SEM_POST, sem );
+
+	if ( sem->flags & PTHREAD_PROCESS_SHARED )
+		return syscall ( SEM_POST, &sem->kobj );
+
+	atomic_add ( &sem->value, 1 );
+	if ( sem->waiters )
+		futex_wake ( &sem->value, 1 );
+
+	return EXIT_SUCCESS;
 }
 int sem_wait ( sem_t *sem )
 {
+	int v;
+
 	ASSERT_ERRNO_AND_RETURN ( sem, EINVAL );
-	return syscall ( SEM_WAIT, sem );
+
+	if ( sem->flags & PTHREAD_PROCESS_SHARED )
+		return syscall ( SEM_WAIT, &sem->kobj );
+
+	for (;;)
+	{
+		v = sem->value;
+		if ( v > 0 )
+		{
+			if ( atomic_cmpxchg ( &sem->value, v, v - 1 ) == v )
+				return EXIT_SUCCESS;
+			continue;
+		}
+
+		/* value is 0: block until sem_post changes it */
+		atomic_add ( &sem->waiters, 1 );
+		futex_wait ( &sem->value, 0 );
+		atomic_add ( &sem->waiters, -1 );
+	}
 }
 
 /*! Message queue */
@@ -215,7 +441,7 @@ mqd_t mq_open ( char *name, int oflag, mode_t mode, struct mq_attr *attr )
 	if ( !name )
 	{
 		mqdes.id = -1;
-		mqdes.ptr = (void *) -1;
+		mqdes.index = -1;
 		set_errno (EINVAL);
 	}
 	else {
@@ -225,20 +451,20 @@ mqd_t mq_open ( char *name, int oflag, mode_t mode, struct mq_attr *attr )
 }
 int mq_close ( mqd_t mqdes )
 {
-	ASSERT_ERRNO_AND_RETURN ( mqdes.id != -1 && mqdes.ptr != (void *) -1,
+	ASSERT_ERRNO_AND_RETURN ( mqdes.id != -1 && mqdes.index != -1,
 				  EINVAL );
 	return syscall ( MQ_CLOSE, &mqdes );
 }
 int mq_send ( mqd_t mqdes, char *msg_ptr, size_t msg_len, uint msg_prio )
 {
-	ASSERT_ERRNO_AND_RETURN ( mqdes.id != -1 && mqdes.ptr != (void *) -1,
+	ASSERT_ERRNO_AND_RETURN ( mqdes.id != -1 && mqdes.index != -1,
 				  EINVAL );
 	ASSERT_ERRNO_AND_RETURN ( msg_ptr, EINVAL );
 	return syscall ( MQ_SEND, &mqdes, msg_ptr, msg_len, msg_prio );
 }
 ssize_t mq_receive (mqd_t mqdes, char *msg_ptr, size_t msg_len, uint *msg_prio)
 {
-	ASSERT_ERRNO_AND_RETURN ( mqdes.id != -1 && mqdes.ptr != (void *) -1,
+	ASSERT_ERRNO_AND_RETURN ( mqdes.id != -1 && mqdes.index != -1,
 				  EINVAL );
 	ASSERT_ERRNO_AND_RETURN ( msg_ptr, EINVAL );
 	return syscall ( MQ_RECEIVE, &mqdes, msg_ptr, msg_len, msg_prio );
@@ -246,7 +472,8 @@ ssize_t mq_receive (mqd_t mqdes, char *msg_ptr, size_t msg_len, uint *msg_prio)
 
 
 /*! EDF scheduling */
-int edf_set ( timespec_t deadline, timespec_t period, int flags )
+int edf_set ( timespec_t deadline, timespec_t period, timespec_t wcet,
+	      int flags )
 {
 	pthread_t thread;
 	sched_param_t param;
@@ -255,6 +482,7 @@ int edf_set ( timespec_t deadline, timespec_t period, int flags )
 	param.sched_priority = 0; /* don't change priority */
 	param.supp.edf.deadline = deadline;
 	param.supp.edf.period = period;
+	param.supp.edf.wcet = wcet;
 	param.supp.edf.flags = flags | EDF_SET ;
 
 	return pthread_setschedparam ( thread, SCHED_EDF, &param );
@@ -283,3 +511,17 @@ int edf_exit ()
 
 	return pthread_setschedparam ( thread, SCHED_EDF, &param );
 }
+
+/*! RM scheduling */
+int rm_set ( timespec_t period, timespec_t wcet )
+{
+	pthread_t thread;
+	sched_param_t param;
+
+	thread = pthread_self ();
+	param.sched_priority = 0; /* priority is assigned by RM */
+	param.supp.rm.period = period;
+	param.supp.rm.wcet = wcet;
+
+	return pthread_setschedparam ( thread, SCHED_RM, &param );
+}
@@ -2,6 +2,7 @@
 
 #include <api/signal.h>
 
+#include <api/pthread.h>
 #include <api/syscall.h>
 #include <types/basic.h>
 #include <api/stdio.h>
@@ -64,3 +65,19 @@ int pthread_sigmask ( int how, sigset_t *set, sigset_t *oset )
 
 	return syscall ( PTHREAD_SIGMASK, how, set, oset );
 }
+
+/*!
+ * SIGEV_THREAD notification worker: thread from process pool, created by
+ * kernel (started from pi.sigev_worker); waits for notifications and calls
+ * their functions until kernel releases it (when process ends)
+ */
+void sigev_worker ( void *param )
+{
+	void (*func) ( sigval_t );
+	sigval_t value;
+
+	while ( syscall ( SIGEV_WAIT, &func, &value ) == EXIT_SUCCESS )
+		func ( value );
+
+	pthread_exit ( NULL );
+}
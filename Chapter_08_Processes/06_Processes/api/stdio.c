@@ -18,7 +18,7 @@ int stdio_init ()
 	for ( i = 0; i < MAX_USER_DESCRIPTORS; i++ )
 	{
 		std_desc[i].id = 0;
-		std_desc[i].ptr = NULL;
+		std_desc[i].index = -1;
 	}
 
 	_stdin =  open ( U_STDIN,  O_RDONLY | CONSOLE_ASCII, 0 ); /* 0 */
@@ -53,7 +53,8 @@ int open ( char *pathname, int flags, mode_t mode )
 		return EXIT_FAILURE;
 
 	std_desc[i].id = desc.id;
-	std_desc[i].ptr = desc.ptr;
+	std_desc[i].index = desc.index;
+	std_desc[i].gen = desc.gen;
 
 	return i;
 }
@@ -64,7 +65,7 @@ int close ( int fd )
 	int retval;
 
 	if ( 	fd < 0 || fd >= MAX_USER_DESCRIPTORS ||
-		!std_desc[fd].id || !std_desc[fd].ptr )
+		!std_desc[fd].id || std_desc[fd].index < 0 )
 	{
 		set_errno ( EBADF );
 		return EXIT_FAILURE;
@@ -76,7 +77,7 @@ int close ( int fd )
 		return EXIT_FAILURE;
 
 	std_desc[fd].id = 0;
-	std_desc[fd].ptr = NULL;
+	std_desc[fd].index = -1;
 
 	return EXIT_SUCCESS;
 }
@@ -85,7 +86,8 @@ int close ( int fd )
 ssize_t read ( int fd, void *buffer, size_t count )
 {
 	if ( 	fd < 0 || fd >= MAX_USER_DESCRIPTORS ||
-		!std_desc[fd].id || !std_desc[fd].ptr || !buffer || !count )
+		!std_desc[fd].id || std_desc[fd].index < 0 ||
+		!buffer || !count )
 	{
 		set_errno ( EBADF );
 		return EXIT_FAILURE;
@@ -98,7 +100,8 @@ ssize_t read ( int fd, void *buffer, size_t count )
 ssize_t write ( int fd, void *buffer, size_t count )
 {
 	if ( 	fd < 0 || fd >= MAX_USER_DESCRIPTORS ||
-		!std_desc[fd].id || !std_desc[fd].ptr || !buffer || !count )
+		!std_desc[fd].id || std_desc[fd].index < 0 ||
+		!buffer || !count )
 	{
 		set_errno ( EBADF );
 		return EXIT_FAILURE;
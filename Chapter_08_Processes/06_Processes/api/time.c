@@ -17,8 +17,7 @@
  */
 int clock_gettime ( clockid_t clockid, timespec_t *time )
 {
-	ASSERT_ERRNO_AND_RETURN ( time && ( clockid == CLOCK_REALTIME ||
-				  clockid == CLOCK_MONOTONIC ), EINVAL        );
+	ASSERT_ERRNO_AND_RETURN ( time && CLOCK_IS_VALID ( clockid ), EINVAL );
 
 	return syscall ( CLOCK_GETTIME, clockid, time);
 }
@@ -79,8 +78,8 @@ int nanosleep ( timespec_t *request, timespec_t *remain )
  */
 int timer_create ( clockid_t clockid, sigevent_t *evp, timer_t *timer )
 {
-	ASSERT_ERRNO_AND_RETURN ( evp && timer && ( clockid == CLOCK_REALTIME
-				  || clockid == CLOCK_MONOTONIC ), EINVAL     );
+	ASSERT_ERRNO_AND_RETURN ( evp && timer && CLOCK_IS_VALID ( clockid ),
+				  EINVAL );
 
 	return syscall ( TIMER_CREATE, clockid, evp, timer );
 }
@@ -100,7 +99,7 @@ int timer_delete ( timer_t *timer )
 /*!
  * Arm/disarm timer
  * \param timerid	Timer descriptor (user descriptor)
- * \param flags		Various flags (TIMER_ABSTIME)
+ * \param flags		Various flags (TIMER_ABSTIME, TIMER_SLACK(us))
  * \param value		Set timer values (it_value+it_period)
  * \param ovalue	Where to store time to next timer expiration (+period)
  * \return status	0 for success
@@ -125,3 +124,15 @@ int timer_gettime ( timer_t *timer, itimerspec_t *value )
 
 	return syscall ( TIMER_GETTIME, timer, value );
 }
+
+/*!
+ * Get timer overrun count
+ * \param timerid	Timer descriptor
+ * \return number of expirations lost before last SIGEV_THREAD notification
+ */
+int timer_getoverrun ( timer_t *timer )
+{
+	ASSERT_ERRNO_AND_RETURN ( timer, EINVAL );
+
+	return syscall ( TIMER_GETOVERRUN, timer );
+}
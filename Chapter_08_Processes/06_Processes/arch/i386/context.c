@@ -6,6 +6,7 @@
 #include "interrupt.h"
 #include "descriptor.h"
 #include <kernel/memory.h>
+#include <kernel/errno.h>
 
 /*! kernel (interrupt) stack (defined in memory.c) */
 extern uint8 system_stack [];
@@ -18,7 +19,34 @@ uint32 arch_thr_context_ss;
 uint32 *arch_thr_context;
 #ifdef USE_SSE
 uint32 arch_sse_supported = 0; /* is SSE supported by processor? */
-uint32 arch_sse_mmx_fpu;	/* where to save extended thread context */
+
+/*
+ * Extended context (FPU, MMX, SSE) is switched lazily: on thread switch only
+ * CR0.TS is set (if selected thread is not FPU owner); first FPU instruction
+ * then raises #NM, where registers are saved to owner's context and loaded
+ * from selected thread's context. Threads that do not use FPU never get
+ * extended context area, nor pay for its save and restore.
+ */
+static context_t *fpu_owner = NULL;	/* whose state is in FPU registers */
+static context_t *fpu_active = NULL;	/* context of active thread */
+static int fpu_ts_set = FALSE;		/* is CR0.TS currently set? */
+
+#define CR0_TS	8
+
+static inline void fpu_set_ts ()
+{
+	uint32 cr0;
+
+	asm volatile ( "movl %%cr0, %0" : "=r" (cr0) );
+	asm volatile ( "movl %0, %%cr0" :: "r" (cr0 | CR0_TS) );
+}
+#define fpu_clear_ts()	asm volatile ( "clts" )
+#define fpu_save(c)	\
+	asm volatile ( "fxsave (%0)" :: "r" ((c)->sse_mmx_fpu) : "memory" )
+#define fpu_restore(c)	\
+	asm volatile ( "fxrstor (%0)" :: "r" ((c)->sse_mmx_fpu) : "memory" )
+
+static void arch_sse_not_available ( uint irqn, void *device );
 #endif
 
 /*! Set up context (normal and interrupt=kernel) */
@@ -31,6 +59,57 @@ void arch_context_init ()
 	arch_descriptors_init (); /* GDT, IDT, ... */
 }
 
+#ifdef USE_SSE
+/*! Register #NM handler (for lazy FPU context switch) */
+void arch_sse_init ()
+{
+	if ( arch_sse_supported )
+		arch_register_interrupt_handler ( INT_NM,
+						  arch_sse_not_available, NULL );
+}
+
+/*!
+ * Device not available (#NM) handler: thread used FPU/SSE instruction while
+ * CR0.TS was set - save registers for previous owner and load its own
+ */
+static void arch_sse_not_available ( uint irqn, void *device )
+{
+	static uint32 mxcsr_init = SSE_MXCSR_INIT;
+	context_t *context = fpu_active;
+
+	ASSERT ( irqn == INT_NM && context );
+
+	fpu_clear_ts ();
+	fpu_ts_set = FALSE;
+
+	if ( fpu_owner == context )
+		return;
+
+	if ( fpu_owner )
+		fpu_save ( fpu_owner );
+
+	if ( !context->sse_mmx_fpu_start )
+	{
+		/* first use of FPU: allocate area, start with initial state */
+		context->sse_mmx_fpu_start =
+			kmalloc ( SSE_CNTX_SIZE + SSE_CNTX_ALIGN );
+		ASSERT ( context->sse_mmx_fpu_start );
+		/* align on 16 byte address */
+		context->sse_mmx_fpu =
+			( ( (uint32) context->sse_mmx_fpu_start ) +
+			  SSE_CNTX_ALIGN - 1 ) & ~( SSE_CNTX_ALIGN - 1 );
+
+		asm volatile ( "fninit" );
+		asm volatile ( "ldmxcsr %0" :: "m" (mxcsr_init) );
+	}
+	else {
+		fpu_restore ( context );
+	}
+
+	fpu_owner = context;
+}
+#endif /* USE_SSE */
+
 /*! context manipulation ---------------------------------------------------- */
 
 /*! Create initial context for thread - it should start with defined function
@@ -70,13 +149,20 @@ void arch_create_thread_context ( context_t *context,
 	/* stack pointer (as eip) must be in process relative addresses */
 
 #ifdef USE_SSE
-	if ( arch_sse_supported )
+	if ( fpu_owner == context )
 	{
-	context->sse_mmx_fpu_start = kmalloc ( SSE_CNTX_SIZE + SSE_CNTX_ALIGN );
-	/* align on 16 byte address */
-	context->sse_mmx_fpu =
-	(((uint32) context->sse_mmx_fpu_start) + SSE_CNTX_ALIGN-1) & 0xfffffff0;
+		/* context is replaced with new one (previous is saved by
+		   caller with its extended area): save FPU registers there */
+		if ( fpu_ts_set )
+			fpu_clear_ts ();
+		fpu_save ( context );
+		if ( fpu_ts_set )
+			fpu_set_ts ();
+		fpu_owner = NULL;
 	}
+	/* extended context area is allocated on first FPU use */
+	context->sse_mmx_fpu_start = NULL;
+	context->sse_mmx_fpu = 0;
 #endif
 
 }
@@ -85,8 +171,15 @@ void arch_create_thread_context ( context_t *context,
 void arch_destroy_thread_context ( context_t *context )
 {
 #ifdef USE_SSE
-	if ( arch_sse_supported )
+	if ( fpu_owner == context )
+		fpu_owner = NULL;
+
+	if ( context->sse_mmx_fpu_start )
+	{
 		kfree ( context->sse_mmx_fpu_start );
+		context->sse_mmx_fpu_start = NULL;
+		context->sse_mmx_fpu = 0;
+	}
 #endif
 }
 
@@ -97,7 +190,18 @@ void arch_select_thread ( context_t *context )
 	arch_tss_update(((void *) &context->context) + sizeof (arch_context_t));
 
 #ifdef USE_SSE
-	arch_sse_mmx_fpu = context->sse_mmx_fpu;
+	fpu_active = context;
+
+	/* FPU instruction must trap (#NM) if registers hold other's state */
+	if ( arch_sse_supported && ( context == fpu_owner ) == fpu_ts_set )
+	{
+		if ( fpu_ts_set )
+			fpu_clear_ts ();
+		else
+			fpu_set_ts ();
+
+		fpu_ts_set = !fpu_ts_set;
+	}
 #endif
 
 	/* update segment descriptors */
@@ -92,6 +92,12 @@ static inline void arch_switch_to_uthread ( ucontext_t *from, ucontext_t *to )
 /* for storing extended context: FPU, MMX, SSE */
 #define SSE_CNTX_SIZE	512
 #define SSE_CNTX_ALIGN	16	/* context start must be aligned */
+#define SSE_MXCSR_INIT	0x1f80	/* MXCSR after reset: all exceptions masked */
 #endif
 
 #endif /* _ARCH_ */
+
+#ifdef USE_SSE
+/*! Register handler for lazy FPU/SSE context switch */
+void arch_sse_init ();
+#endif
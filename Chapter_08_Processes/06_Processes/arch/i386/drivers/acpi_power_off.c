@@ -116,6 +116,25 @@ static int acpiCheckHeader ( unsigned int *ptr, char *sig )
 
 
 
+/*! Find ACPI table with given signature (e.g. "APIC" for MADT) */
+void *acpiGetTable ( char *sig )
+{
+	unsigned int *ptr = acpiGetRSDPtr ();
+	int entrys;
+
+	if ( ptr == NULL || acpiCheckHeader ( ptr, "RSDT" ) != 0 )
+		return NULL;
+
+	entrys = ( *(ptr + 1) - 36 ) / 4;
+	ptr += 36/4;	// skip header information
+
+	for ( ; 0 < entrys--; ptr++ )
+		if ( acpiCheckHeader ( (unsigned int *) *ptr, sig ) == 0 )
+			return (void *) *ptr;
+
+	return NULL;
+}
+
 static int acpiEnable (void)
 {
 	// check if acpi is enabled
@@ -6,6 +6,7 @@
 #pragma once
 
 void acpiPowerOff(void);
+void *acpiGetTable ( char *sig );
 
 #ifdef _ACPI_POWER_OFF_C_ //rest only for acpi_power_off.h
 
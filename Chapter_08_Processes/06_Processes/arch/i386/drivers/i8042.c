@@ -344,7 +344,7 @@ device_t i8042_dev = (device_t)
 	.send =		i8042_send,
 	.recv =		i8042_get,
 
-	.flags = 	DEV_TYPE_SHARED,
+	.flags = 	DEV_TYPE_SHARED | DEV_TYPE_BLOCKING,
 	.params = 	NULL,
 };
 
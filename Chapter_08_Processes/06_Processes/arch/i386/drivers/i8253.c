@@ -101,4 +101,34 @@ static void i8253_register_interrupt ( void *handler )
 	arch_register_interrupt_handler ( IRQ_TIMER, handler, &i8253 );
 }
 
+/*!
+ * Count ticks of other counter during 'cnt' i8253 ticks, for calibration of
+ * that counter (channel 2 is used, so channel 0 and its interrupts are not
+ * disturbed)
+ * \param read Function that reads other counter
+ * \param cnt Number of i8253 ticks to wait (less than 65536)
+ * \return Number of ticks other counter made
+ */
+uint64 i8253_calibrate ( uint64 (*read) (), uint cnt )
+{
+	uint8 port_b;
+	uint64 start, end;
+
+	port_b = inb ( I8253_PORT_B );
+	outb ( I8253_PORT_B, ( port_b & ~I8253_SPEAKER ) | I8253_GATE2 );
+
+	outb ( I8253_CMD, I8253_CMD_CH2 );
+	outb ( I8253_CH2, (uint8) ( cnt & 0x00ff ) );
+	outb ( I8253_CH2, (uint8) ( ( cnt >> 8 ) & 0x00ff ) );
+
+	start = read ();
+	while ( !( inb ( I8253_PORT_B ) & I8253_OUT2 ) )
+		;
+	end = read ();
+
+	outb ( I8253_PORT_B, port_b );
+
+	return end - start;
+}
+
 #endif /* I8253 */
@@ -30,10 +30,17 @@ do { C = mul_div_32 ( (T)->tv_nsec, I8253_FREQ, N1E9 ); } while(0)
 /* i8253 ports and commands */
 #define	I8253_CH0	0x40
 #define	I8253_CH1	0x41	/* channel 1 not used */
-#define	I8253_CH2	0x42	/* channel 2 not used */
+#define	I8253_CH2	0x42	/* channel 2 used only for calibration */
 #define	I8253_CMD	0x43
 #define	I8253_CMD_LOAD	0x34
 #define	I8253_CMD_LATCH	0x04
+#define	I8253_CMD_CH2	0xb0	/* channel 2, mode 0 (single count) */
+
+/* channel 2 gate and output are in "port B" of keyboard controller */
+#define	I8253_PORT_B	0x61
+#define	I8253_GATE2	0x01	/* enable counting on channel 2 */
+#define	I8253_SPEAKER	0x02	/* connect channel 2 output to speaker */
+#define	I8253_OUT2	0x20	/* channel 2 output (set when count ends) */
 
 static void i8253_init ();
 static void i8253_set ( uint cnt );
@@ -21,7 +21,10 @@ arch_ic_t i8259 = (arch_ic_t)
 	.disable_irq = i8259_irq_disable,
 	.enable_irq = i8259_irq_enable,
 	.at_exit = i8259_at_exit,
-	.int_descr = i8259_interrupt_description
+	.int_descr = i8259_interrupt_description,
+	.set_level = NULL,
+	.get_level = NULL,
+	.irq_number = NULL
 };
 
 #define	PIC1_CMD	0x20	/* master PIC-a command port	*/
@@ -59,6 +62,8 @@ static void i8259_init ()
 static void i8259_irq_enable ( unsigned int irq )
 {
 	irq -= IRQ_OFFSET;
+	if ( irq >= PIC_IRQS )
+		return; /* not PIC interrupt */
 	if ( irq < 8 )
 		outb ( PIC1_DATA, inb (PIC1_DATA) & ~(1 << irq) );
 	else
@@ -72,6 +77,8 @@ static void i8259_irq_enable ( unsigned int irq )
 static void i8259_irq_disable ( unsigned int irq )
 {
 	irq -= IRQ_OFFSET;
+	if ( irq >= PIC_IRQS )
+		return; /* not PIC interrupt */
 	if ( irq < 8 )
 		outb ( PIC1_DATA, inb (PIC1_DATA) | (1 << irq) );
 	else
@@ -84,7 +91,7 @@ static void i8259_irq_disable ( unsigned int irq )
  */
 static void i8259_at_exit ( unsigned int irq )
 {
-	if ( irq >= IRQ_OFFSET && irq < HW_INTERRUPTS )
+	if ( irq >= IRQ_OFFSET && irq < IRQ_OFFSET + PIC_IRQS )
 	{
 		outb ( PIC1_CMD, PIC_EOI );
 		if ( irq >= IRQ_OFFSET + 8 )
@@ -149,9 +156,6 @@ static char *arch_int_desc[] =
 	"IRQ_COPROCESSOR",
 	"IRQ_HARD_DISK",
 	"IRQ_RESERVED4",
-
-	/* Software interrupt, using first available = 48 */
-	"Software interrupt"
 };
 
 /*!
@@ -161,8 +165,16 @@ static char *arch_int_desc[] =
  */
 static char *i8259_interrupt_description ( unsigned int n )
 {
-	if ( n < INTERRUPTS )
+	if ( n < sizeof (arch_int_desc) / sizeof (char *) )
 		return arch_int_desc[n];
+	else if ( n == IRQ_LAPIC_TIMER )
+		return "IRQ_LAPIC_TIMER";
+	else if ( n == IRQ_LAPIC_SPURIOUS )
+		return "IRQ_LAPIC_SPURIOUS";
+	else if ( n == SOFT_IRQ )
+		return "Software interrupt";
+	else if ( n < INTERRUPTS )
+		return "Unused";
 	else
 		return "Unknown interrupt number";
 }
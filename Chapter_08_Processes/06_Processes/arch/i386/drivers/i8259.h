@@ -26,6 +26,13 @@ enum {
 	IRQ_HARD_DISK,
 	IRQ_RESERVED4,
 
+	/* with I/O APIC, ISA interrupts are also delivered through vectors
+	 * in higher priority classes, up to IRQ_OFFSET + 0x4f (ioapic.h) */
+
+	/* local APIC: timer and spurious interrupt (low 4 bits set) */
+	IRQ_LAPIC_TIMER = IRQ_OFFSET + 0x5e,
+	IRQ_LAPIC_SPURIOUS,
+
 	HW_INTERRUPTS
 };
 
@@ -33,10 +40,12 @@ enum {
 
 #else /* ASM_FILE */
 
-#define SOFT_IRQ	48 /* NOTE: adjust to match 'HW_INTERRUPTS' !!! */
+#define SOFT_IRQ	128 /* NOTE: adjust to match 'HW_INTERRUPTS' !!! */
 
 #endif /* ASM_FILE */
 
 #define NUM_IRQS	( SOFT_IRQ + 1 )
 
+#define PIC_IRQS	16 /* interrupts (from IRQ_OFFSET) connected to PIC */
+
 #endif /* I8259 */
@@ -0,0 +1,275 @@
+/*! I/O APIC with local APIC (interrupt controller)
+ *
+ * ISA interrupts are routed through I/O APIC to vectors in priority classes
+ * given by their priority (IOAPIC_IRQ_PRIO, see ioapic.h), and translated
+ * back to same interrupt numbers as with i8259 (IRQ_OFFSET + irq), so device
+ * drivers are not changed. End of interrupt is a single write into (memory
+ * mapped) local APIC register. Local APIC task priority holds back
+ * interrupts in lower priority classes (set_level).
+ */
+#ifdef IOAPIC
+
+#define _IOAPIC_C_
+#include "ioapic.h"
+
+#include "lapic.h"
+#include "acpi_power_off.h"
+#include "../interrupt.h"
+#include "../processor.h"
+
+#include <kernel/errno.h>
+
+/*! interface to arch layer - arch_ic_t */
+arch_ic_t ioapic = (arch_ic_t)
+{
+	.init = ioapic_init,
+	.disable_irq = ioapic_irq_disable,
+	.enable_irq = ioapic_irq_enable,
+	.at_exit = ioapic_at_exit,
+	.int_descr = ioapic_interrupt_description,
+	.set_level = ioapic_set_level,
+	.get_level = ioapic_get_level,
+	.irq_number = ioapic_irq_number
+};
+
+static volatile uint32 *ioapic_addr;	/* I/O APIC registers */
+static uint32 gsi_base;			/* first input of I/O APIC */
+static uint32 gsi_count;		/* number of its inputs */
+static int pcat_compat;			/* are i8259 also present? */
+
+/*! I/O APIC input and redirection flags for each ISA interrupt */
+static uint32 irq_gsi[IOAPIC_IRQS];
+static uint32 irq_flags[IOAPIC_IRQS];
+static uint8 irq_prio[IOAPIC_IRQS] = IOAPIC_IRQ_PRIO;
+
+#ifdef I8259
+extern arch_ic_t i8259;
+#endif
+
+/*! Initialize local APIC and I/O APIC (all interrupts masked) */
+static void ioapic_init ()
+{
+	uint32 dest, reg, i;
+
+	if ( lapic_enable () || ioapic_parse_madt () )
+	{
+		LOG ( ERROR, "APIC not present!\n" );
+		halt ();
+	}
+
+#ifdef I8259
+	/* PIC is initialized (moved from exception interrupt numbers) and
+	 * left masked */
+	if ( pcat_compat )
+		i8259.init ();
+#endif
+	/* PIC interrupts are not used through local APIC either */
+	lapic_write ( LAPIC_LVT_LINT0, LAPIC_LVT_EXTINT | LAPIC_LVT_MASKED );
+
+	gsi_count = ( ( ioapic_read ( IOAPIC_VER ) >> 16 ) & 0xff ) + 1;
+
+	/* mask all inputs */
+	for ( i = 0; i < gsi_count; i++ )
+		ioapic_write ( IOAPIC_REDTBL ( i ), IOAPIC_MASKED );
+
+	/* deliver to this processor (fixed mode, physical destination) */
+	dest = lapic_read ( LAPIC_ID ) & 0xff000000;
+
+	for ( i = 0; i < IOAPIC_IRQS; i++ )
+	{
+		reg = ioapic_entry ( i );
+		if ( !reg )
+			continue;
+
+		ioapic_write ( reg + 1, dest );
+		ioapic_write ( reg, IOAPIC_VECTOR ( i, irq_prio[i] ) |
+				    irq_flags[i] | IOAPIC_MASKED );
+	}
+
+	ioapic_set_level ( 0 );
+}
+
+/*!
+ * Find I/O APIC and ISA interrupt routing in ACPI MADT table
+ * \return 0 if I/O APIC is found, -1 otherwise
+ */
+static int ioapic_parse_madt ()
+{
+	struct madt *madt;
+	struct madt_ioapic *io;
+	struct madt_override *ovr;
+	uint8 *entry, *end;
+	uint8 overridden[IOAPIC_IRQS];
+	uint32 i, j;
+
+	madt = acpiGetTable ( "APIC" );
+	if ( !madt )
+		return -1;
+
+	/* ISA interrupts: identity mapped, active high, edge triggered */
+	for ( i = 0; i < IOAPIC_IRQS; i++ )
+	{
+		irq_gsi[i] = i;
+		irq_flags[i] = 0;
+		overridden[i] = FALSE;
+	}
+
+	pcat_compat = madt->flags & MADT_PCAT_COMPAT;
+	ioapic_addr = NULL;
+	end = (uint8 *) madt + *( (uint32 *) madt->header + 1 );
+
+	entry = madt->entries;
+	for ( ; entry < end && entry[1]; entry += entry[1] )
+	{
+		if ( entry[0] == MADT_IOAPIC && !ioapic_addr )
+		{
+			/* first I/O APIC is used (ISA interrupts are there) */
+			io = (struct madt_ioapic *) entry;
+			ioapic_addr = (volatile uint32 *) io->addr;
+			gsi_base = io->gsi_base;
+		}
+		else if ( entry[0] == MADT_OVERRIDE )
+		{
+			ovr = (struct madt_override *) entry;
+			if ( ovr->bus || ovr->source >= IOAPIC_IRQS )
+				continue;
+
+			irq_gsi[ovr->source] = ovr->gsi;
+			irq_flags[ovr->source] = 0;
+			overridden[ovr->source] = TRUE;
+			if ( MADT_POLARITY ( ovr->flags ) == MADT_ACTIVE_LOW )
+				irq_flags[ovr->source] |= IOAPIC_LOW_ACTIVE;
+			if ( MADT_TRIGGER ( ovr->flags ) == MADT_LEVEL )
+				irq_flags[ovr->source] |= IOAPIC_LEVEL;
+		}
+	}
+
+	/* identity mapped IRQ whose GSI is taken by other source's override
+	 * (e.g. IRQ2 when IRQ0 -> GSI2) is not connected: unmap it */
+	for ( i = 0; i < IOAPIC_IRQS; i++ )
+		for ( j = 0; j < IOAPIC_IRQS && !overridden[i]; j++ )
+			if ( j != i && overridden[j] && irq_gsi[j] == i )
+				irq_gsi[i] = IOAPIC_NO_GSI;
+
+	return ioapic_addr ? 0 : -1;
+}
+
+/*!
+ * Enable particular external interrupt in I/O APIC
+ * \param irq Interrupt request number
+ */
+static void ioapic_irq_enable ( unsigned int irq )
+{
+	uint32 reg = ioapic_entry ( irq - IRQ_OFFSET );
+
+	if ( reg )
+		ioapic_write ( reg, ioapic_read ( reg ) & ~IOAPIC_MASKED );
+}
+
+/*!
+ * Disable particular external interrupt in I/O APIC
+ * \param irq Interrupt request number
+ */
+static void ioapic_irq_disable ( unsigned int irq )
+{
+	uint32 reg = ioapic_entry ( irq - IRQ_OFFSET );
+
+	if ( reg )
+		ioapic_write ( reg, ioapic_read ( reg ) | IOAPIC_MASKED );
+}
+
+/*!
+ * At end of interrupt processing, signal end of interrupt to local APIC
+ * (local APIC timer does it itself; spurious interrupt, which must not do
+ * it, has its own vector outside this range)
+ * \param irq Interrupt request number
+ */
+static void ioapic_at_exit ( unsigned int irq )
+{
+	if ( irq >= IRQ_OFFSET && irq < IRQ_OFFSET + IOAPIC_IRQS )
+		lapic_write ( LAPIC_EOI, 0 );
+}
+
+/*!
+ * Hold back interrupts with priority class (vector / 16) at or
+ * below 'level' (local APIC task priority)
+ * \param level Priority class (0 - accept all interrupts)
+ * \return Previous level
+ */
+static unsigned int ioapic_set_level ( unsigned int level )
+{
+	unsigned int prev = lapic_read ( LAPIC_TPR ) >> LAPIC_TPR_SHIFT;
+
+	lapic_write ( LAPIC_TPR, ( level & 0x0f ) << LAPIC_TPR_SHIFT );
+
+	return prev;
+}
+
+/*!
+ * Priority class of interrupt (class of vector it is delivered through)
+ * \param irq Interrupt request number
+ * \return Priority class (level for set_level that holds it back)
+ */
+static unsigned int ioapic_get_level ( unsigned int irq )
+{
+	if ( irq >= IRQ_OFFSET && irq < IRQ_OFFSET + IOAPIC_IRQS )
+		irq = IOAPIC_VECTOR ( irq - IRQ_OFFSET,
+				      irq_prio[irq - IRQ_OFFSET] );
+
+	return irq >> LAPIC_TPR_SHIFT;
+}
+
+/*!
+ * Interrupt number for handlers: ISA interrupts delivered through vectors
+ * of higher priority classes are translated to their i8259 numbers
+ * \param vector Interrupt vector
+ * \return Interrupt number
+ */
+static unsigned int ioapic_irq_number ( unsigned int vector )
+{
+	if ( vector >= IOAPIC_VECTOR ( 0, 1 ) &&
+	     vector < IOAPIC_VECTOR ( 0, IOAPIC_PRIO_LEVELS ) )
+		return IRQ_OFFSET + vector % 16;
+	else
+		return vector;
+}
+
+/*!
+ * Return info for requested interrupt number (same numbers as for i8259)
+ * \param n Interrupt number
+ * \return Pointer to description string
+ */
+static char *ioapic_interrupt_description ( unsigned int n )
+{
+#ifdef I8259
+	return i8259.int_descr ( n );
+#else
+	return "Descriptions unavailable in this build";
+#endif
+}
+
+/*! Redirection entry for ISA interrupt (0 if not routed through I/O APIC) */
+static uint32 ioapic_entry ( uint32 irq )
+{
+	if ( irq >= IOAPIC_IRQS || irq_gsi[irq] < gsi_base ||
+	     irq_gsi[irq] - gsi_base >= gsi_count )
+		return 0;
+
+	return IOAPIC_REDTBL ( irq_gsi[irq] - gsi_base );
+}
+
+/*! Read I/O APIC register */
+static uint32 ioapic_read ( uint32 reg )
+{
+	ioapic_addr[IOAPIC_REGSEL / 4] = reg;
+	return ioapic_addr[IOAPIC_WIN / 4];
+}
+
+/*! Write I/O APIC register */
+static void ioapic_write ( uint32 reg, uint32 val )
+{
+	ioapic_addr[IOAPIC_REGSEL / 4] = reg;
+	ioapic_addr[IOAPIC_WIN / 4] = val;
+}
+
+#endif /* IOAPIC */
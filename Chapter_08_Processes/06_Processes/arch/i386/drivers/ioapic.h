@@ -0,0 +1,99 @@
+/*! I/O APIC with local APIC (interrupt controller) */
+#ifdef IOAPIC
+
+#pragma once
+
+#ifndef LAPIC
+#error	I/O APIC interrupt controller requires LAPIC in DEVICES
+#endif
+
+#define	IOAPIC_IRQS	16	/* ISA interrupts routed (as with i8259) */
+#define	IOAPIC_NO_GSI	0xffffffff /* ISA interrupt not connected */
+
+#ifdef _IOAPIC_C_ /* rest only for ioapic.c */
+
+#include <types/basic.h>
+
+/*
+ * ISA interrupt 'irq' with priority 'prio' is delivered through vector
+ * IRQ_OFFSET + 16 * prio + irq, which is in local APIC priority class
+ * 2 + prio (class = vector / 16). Priority 0 gives i8259 numbers. Handlers
+ * are registered and called with i8259 number (IRQ_OFFSET + irq) for any
+ * priority. Class 7 is left for local APIC timer (and spurious interrupt).
+ */
+#define	IOAPIC_PRIO_LEVELS	5
+#define	IOAPIC_VECTOR(irq, prio)	( IRQ_OFFSET + 16 * (prio) + (irq) )
+
+/* priority of ISA interrupts (0 - lowest), by default in i8259 order: timer,
+ * keyboard, slave PIC interrupts (8-15), then master PIC interrupts (3-7) */
+#ifndef IOAPIC_IRQ_PRIO
+#define	IOAPIC_IRQ_PRIO	{ 4, 3, 0, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2 }
+#endif
+
+/* I/O APIC registers: selected with IOREGSEL, accessed through IOWIN */
+#define	IOAPIC_REGSEL		0x00
+#define	IOAPIC_WIN		0x10
+#define	IOAPIC_VER		0x01	/* bits 16-23: max. redirection entry */
+#define	IOAPIC_REDTBL(n)	( 0x10 + 2 * (n) ) /* entry n (2 registers) */
+
+/* redirection entry (lower 32 bits; upper: destination in bits 24-31) */
+#define	IOAPIC_LOW_ACTIVE	0x2000
+#define	IOAPIC_LEVEL		0x8000
+#define	IOAPIC_MASKED		0x10000
+
+/* MADT ("APIC" ACPI table) */
+#define	MADT_PCAT_COMPAT	1	/* flags: i8259 present (mask it) */
+#define	MADT_IOAPIC		1	/* entry types */
+#define	MADT_OVERRIDE		2
+
+/* polarity and trigger mode in interrupt source override flags */
+#define	MADT_POLARITY(f)	( (f) & 3 )
+#define	MADT_TRIGGER(f)		( ( (f) >> 2 ) & 3 )
+#define	MADT_ACTIVE_LOW		3
+#define	MADT_LEVEL		3
+
+struct madt
+{
+	uint8	 header[36];	/* signature "APIC", length, ... */
+	uint32	 lapic_addr;
+	uint32	 flags;
+	uint8	 entries[];	/* type, length, ... */
+} __attribute__((packed));
+
+struct madt_ioapic
+{
+	uint8	 type;
+	uint8	 length;
+	uint8	 id;
+	uint8	 reserved;
+	uint32	 addr;
+	uint32	 gsi_base;
+} __attribute__((packed));
+
+struct madt_override
+{
+	uint8	 type;
+	uint8	 length;
+	uint8	 bus;
+	uint8	 source;	/* ISA interrupt */
+	uint32	 gsi;		/* I/O APIC input (global system interrupt) */
+	uint16	 flags;
+} __attribute__((packed));
+
+static void ioapic_init ();
+static void ioapic_irq_enable ( unsigned int irq );
+static void ioapic_irq_disable ( unsigned int irq );
+static void ioapic_at_exit ( unsigned int irq );
+static char *ioapic_interrupt_description ( unsigned int n );
+static unsigned int ioapic_set_level ( unsigned int level );
+static unsigned int ioapic_get_level ( unsigned int irq );
+static unsigned int ioapic_irq_number ( unsigned int vector );
+
+static int ioapic_parse_madt ();
+static uint32 ioapic_entry ( uint32 irq );
+static uint32 ioapic_read ( uint32 reg );
+static void ioapic_write ( uint32 reg, uint32 val );
+
+#endif /* _IOAPIC_C_ */
+
+#endif /* IOAPIC */
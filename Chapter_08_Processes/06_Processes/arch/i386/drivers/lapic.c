@@ -0,0 +1,268 @@
+/*! Local APIC timer (timer device) */
+#ifdef LAPIC
+
+#define _LAPIC_C_
+#include "lapic.h"
+
+#include "../interrupt.h"
+#include "../processor.h"
+
+#include <kernel/errno.h>
+
+/* fallback when calibration fails (i8253 is also used for calibration) */
+extern arch_timer_t i8253;
+
+/*! timer device lapic_timer, wrapper for arch_timer_t interface */
+arch_timer_t lapic_timer = (arch_timer_t)
+{
+	.min_interval = { 0, 0 },
+	.max_interval = { 0, 0 },
+	.init = lapic_timer_init,
+	.set_interval = lapic_timer_set,
+	.get_interval_remainder = lapic_timer_get,
+	.enable_interrupt = lapic_timer_enable_interrupt,
+	.disable_interrupt = lapic_timer_disable_interrupt,
+	.register_interrupt = lapic_timer_register_interrupt
+};
+/* accessed from 'arch' layer via: extern arch_timer_t lapic_timer */
+
+static int enabled;		/* is local APIC already enabled? */
+static int deadline_mode;	/* TSC-deadline mode, or one-shot mode */
+static uint32 freq_khz;		/* counter (TSC or timer) frequency */
+static uint64 deadline;		/* last TSC deadline (in deadline mode) */
+static uint32 lvt_timer;	/* LVT timer mode and vector */
+static void (*timer_handler) ();/* arch layer handler */
+
+/*!
+ * Enable local APIC, calibrate timer and calculate min and max interval;
+ * TSC-deadline mode is used if supported, one-shot mode otherwise
+ */
+static void lapic_timer_init ()
+{
+	timespec_t max;
+	uint64 ticks;
+	uint32 a, b, c, d;
+
+	if ( lapic_enable () )
+	{
+		LOG ( ERROR, "Local APIC not present!\n" );
+		halt ();
+	}
+
+	asm volatile ( "cpuid" : "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+		       : "a" (1) );
+	deadline_mode = ( c & CPUID_ECX_TSC_DEADLINE ) &&
+			arch_tsc_supported ();
+
+	lvt_timer = IRQ_LAPIC_TIMER | LAPIC_LVT_MASKED;
+	if ( deadline_mode )
+	{
+		lvt_timer |= LAPIC_TIMER_DEADLINE;
+		lapic_write ( LAPIC_LVT_TIMER, lvt_timer );
+		ticks = i8253_calibrate ( lapic_tsc_read,
+					  I8253_CALIBRATE_COUNT );
+	}
+	else {
+		lvt_timer |= LAPIC_TIMER_ONESHOT;
+		lapic_write ( LAPIC_LVT_TIMER, lvt_timer );
+		lapic_write ( LAPIC_TIMER_DCR, LAPIC_TIMER_DIV );
+		lapic_write ( LAPIC_TIMER_ICR, 0xffffffff );
+		ticks = i8253_calibrate ( lapic_timer_count,
+					  I8253_CALIBRATE_COUNT );
+		lapic_write ( LAPIC_TIMER_ICR, 0 );
+	}
+	deadline = 0;
+
+	/* calibration may fail (e.g. under emulator): use i8253 instead */
+	if ( ticks >> 32 || ticks < LAPIC_MIN_TICKS )
+	{
+		LOG ( WARN, "Local APIC timer not calibrated, using i8253" );
+		lapic_write ( LAPIC_LVT_TIMER, LAPIC_LVT_MASKED );
+		i8253.init ();
+		lapic_timer = i8253;
+		return;
+	}
+
+	/* ticks * I8253_CALIBRATE_FREQ / count [Hz] */
+	freq_khz = mul_div_32 ( (uint32) ticks, I8253_CALIBRATE_FREQ,
+				I8253_CALIBRATE_COUNT * 1000 );
+
+	lapic_timer.min_interval.tv_sec = 0;
+	lapic_timer.min_interval.tv_nsec = LAPIC_TIMER_MIN;
+
+	if ( deadline_mode )
+	{
+		lapic_timer.max_interval.tv_sec = LAPIC_DEADLINE_MAX;
+		lapic_timer.max_interval.tv_nsec = 0;
+	}
+	else {
+		lapic_ticks_to_time ( 0xffffffff, &max );
+		lapic_timer.max_interval = max;
+	}
+}
+
+/*!
+ * Enable local APIC (in "virtual wire" mode: PIC interrupts are forwarded
+ * through LINT0; APIC interrupt controller masks LINT0 after this call)
+ * \return 0 if local APIC is present (and enabled), error number otherwise
+ */
+int lapic_enable ()
+{
+	uint64 base;
+	uint32 a, b, c, d;
+
+	if ( enabled )
+		return 0;
+
+	asm volatile ( "cpuid" : "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+		       : "a" (1) );
+	if ( !( d & CPUID_EDX_APIC ) )
+		return ENODEV;
+
+	/* registers are accessed through memory (not in x2APIC mode) */
+	base = arch_rdmsr ( MSR_APIC_BASE );
+	if ( base & MSR_APIC_BASE_X2APIC )
+		return ENODEV;
+
+	/* (re)map to default address and enable, keep other flags */
+	base = ( base & MSR_APIC_BASE_FLAGS ) | LAPIC_ADDR |
+		MSR_APIC_BASE_ENABLE;
+	arch_wrmsr ( MSR_APIC_BASE, base );
+
+	arch_register_interrupt_handler ( LAPIC_SPURIOUS,
+					  lapic_spurious_interrupt, NULL );
+	lapic_write ( LAPIC_SVR, LAPIC_SPURIOUS | LAPIC_SVR_ENABLE );
+	lapic_write ( LAPIC_TPR, 0 );
+	lapic_write ( LAPIC_LVT_LINT0, LAPIC_LVT_EXTINT );
+	lapic_write ( LAPIC_LVT_LINT1, LAPIC_LVT_NMI );
+
+	enabled = TRUE;
+
+	return 0;
+}
+
+/*! Start counting: interrupt after 'time' */
+static void lapic_timer_set ( timespec_t *time )
+{
+	uint64 ticks, now;
+
+	ASSERT ( time );
+
+	ticks = lapic_time_to_ticks ( time );
+
+	if ( deadline_mode )
+	{
+		/* if previous deadline expired, arch layer counts time from
+		 * it, so next interval should also start from it */
+		now = arch_rdtsc ();
+		if ( !deadline || deadline > now )
+			deadline = now;
+		deadline += ticks;
+		arch_wrmsr ( MSR_TSC_DEADLINE, deadline );
+	}
+	else {
+		if ( ticks > 0xffffffff )
+			ticks = 0xffffffff;
+		else if ( !ticks )
+			ticks = 1;
+		lapic_write ( LAPIC_TIMER_ICR, (uint32) ticks );
+	}
+}
+
+/*! Get time remaining until interrupt */
+static void lapic_timer_get ( timespec_t *time )
+{
+	uint64 ticks, now;
+
+	ASSERT ( time );
+
+	if ( deadline_mode )
+	{
+		now = arch_rdtsc ();
+		ticks = deadline > now ? deadline - now : 0;
+	}
+	else {
+		ticks = lapic_read ( LAPIC_TIMER_CCR );
+	}
+
+	lapic_ticks_to_time ( ticks, time );
+}
+
+/*! Enable timer interrupts */
+static void lapic_timer_enable_interrupt ()
+{
+	lvt_timer &= ~LAPIC_LVT_MASKED;
+	lapic_write ( LAPIC_LVT_TIMER, lvt_timer );
+}
+
+/*! Disable timer interrupts */
+static void lapic_timer_disable_interrupt ()
+{
+	lvt_timer |= LAPIC_LVT_MASKED;
+	lapic_write ( LAPIC_LVT_TIMER, lvt_timer );
+}
+
+/*! Register function for timer interrupts */
+static void lapic_timer_register_interrupt ( void *handler )
+{
+	timer_handler = handler;
+	arch_register_interrupt_handler ( IRQ_LAPIC_TIMER,
+					  lapic_timer_interrupt, &lapic_timer );
+}
+
+/*! Timer interrupt: acknowledge it in local APIC and forward it */
+static void lapic_timer_interrupt ()
+{
+	lapic_write ( LAPIC_EOI, 0 );
+
+	if ( timer_handler )
+		timer_handler ();
+}
+
+/*! Spurious interrupt: ignore (local APIC does not expect EOI for it) */
+static void lapic_spurious_interrupt ()
+{
+}
+
+/*! Timer ticks since initial count was loaded (for calibration) */
+static uint64 lapic_timer_count ()
+{
+	return 0xffffffff - lapic_read ( LAPIC_TIMER_CCR );
+}
+
+/*! Read TSC (for calibration) */
+static uint64 lapic_tsc_read ()
+{
+	return arch_rdtsc ();
+}
+
+/*! Convert time to counter ticks */
+static uint64 lapic_time_to_ticks ( timespec_t *time )
+{
+	uint32 ms, ns;
+
+	/* (ms * khz) + (ns * khz / 10^6); ns < 10^6 so it fits 32 bits */
+	ms = time->tv_nsec / 1000000;
+	ns = time->tv_nsec % 1000000;
+
+	return ( (uint64) time->tv_sec * 1000 + ms ) * freq_khz +
+		mul_div_32 ( ns, freq_khz, 1000000 );
+}
+
+/*! Convert counter ticks to time */
+static void lapic_ticks_to_time ( uint64 ticks, timespec_t *time )
+{
+	uint32 ms, rem;
+
+	/* ms = ticks / khz: fits 32 bits for intervals shorter than 49 days,
+	 * so single 64/32 bit division is used */
+	asm ( "divl %4" : "=a" (ms), "=d" (rem)
+	      : "0" ( (uint32) ticks ), "1" ( (uint32) ( ticks >> 32 ) ),
+	        "rm" (freq_khz) );
+
+	time->tv_sec = ms / 1000;
+	time->tv_nsec = ( ms % 1000 ) * 1000000 +
+			mul_div_32 ( rem, 1000000, freq_khz );
+}
+
+#endif /* LAPIC */
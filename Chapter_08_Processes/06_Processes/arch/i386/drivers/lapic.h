@@ -0,0 +1,76 @@
+/*! Local APIC (timer device, and part of APIC interrupt controller) */
+#ifdef LAPIC
+
+#pragma once
+
+#include <types/basic.h>
+
+/* local APIC registers (memory mapped, default address) */
+#define LAPIC_ADDR		0xfee00000
+#define LAPIC_ID		0x020
+#define LAPIC_TPR		0x080	/* task priority */
+#define LAPIC_EOI		0x0b0	/* end of interrupt */
+#define LAPIC_SVR		0x0f0	/* spurious interrupt vector */
+#define LAPIC_LVT_TIMER		0x320
+#define LAPIC_LVT_LINT0		0x350
+#define LAPIC_LVT_LINT1		0x360
+#define LAPIC_TIMER_ICR		0x380	/* initial count */
+#define LAPIC_TIMER_CCR		0x390	/* current count */
+#define LAPIC_TIMER_DCR		0x3e0	/* divide configuration */
+
+#define LAPIC_SVR_ENABLE	0x100	/* software enable */
+#define LAPIC_SPURIOUS		IRQ_LAPIC_SPURIOUS
+#define LAPIC_LVT_MASKED	0x10000
+#define LAPIC_LVT_EXTINT	0x700	/* delivery mode: PIC (virtual wire) */
+#define LAPIC_LVT_NMI		0x400	/* delivery mode: NMI */
+#define LAPIC_TIMER_ONESHOT	0x00000
+#define LAPIC_TIMER_DEADLINE	0x40000	/* TSC-deadline mode */
+
+#define LAPIC_TPR_SHIFT		4	/* priority class = vector >> 4 */
+
+/* model specific registers and cpuid (function 1) flags */
+#define MSR_APIC_BASE		0x1b
+#define MSR_APIC_BASE_ENABLE	0x800
+#define MSR_APIC_BASE_X2APIC	0x400
+#define MSR_APIC_BASE_FLAGS	0xfff	/* BSP, x2APIC, enable (not address) */
+#define MSR_TSC_DEADLINE	0x6e0
+#define CPUID_EDX_APIC		( 1 << 9 )
+#define CPUID_ECX_TSC_DEADLINE	( 1 << 24 )
+
+#define LAPIC_REG(REG)		( (volatile uint32 *) ( LAPIC_ADDR + (REG) ) )
+#define lapic_read(REG)		( *LAPIC_REG ( REG ) )
+#define lapic_write(REG, VAL)	do { *LAPIC_REG ( REG ) = (VAL); } while (0)
+
+int lapic_enable ();
+
+#ifdef _LAPIC_C_ /* rest only for lapic.c */
+
+#include "../time.h"
+#include <kernel/time.h>
+#include <types/bits.h>
+
+#define LAPIC_TIMER_DIV		0x3	/* DCR value: divide by 16 */
+
+#define LAPIC_TIMER_MIN		10000	/* min. interval [ns] */
+#define LAPIC_DEADLINE_MAX	3600	/* max. interval in TSC-deadline mode
+					 * [s]; one-shot: max. 32 bit count */
+#define LAPIC_MIN_TICKS		1000	/* in calibration (10 ms): at least
+					 * 100 kHz, otherwise i8253 is used */
+
+static void lapic_timer_init ();
+static void lapic_timer_set ( timespec_t *time );
+static void lapic_timer_get ( timespec_t *time );
+static void lapic_timer_enable_interrupt ();
+static void lapic_timer_disable_interrupt ();
+static void lapic_timer_register_interrupt ( void *handler );
+
+static void lapic_timer_interrupt ();
+static void lapic_spurious_interrupt ();
+static uint64 lapic_timer_count ();
+static uint64 lapic_tsc_read ();
+static uint64 lapic_time_to_ticks ( timespec_t *time );
+static void lapic_ticks_to_time ( uint64 ticks, timespec_t *time );
+
+#endif /* _LAPIC_C_ */
+
+#endif /* LAPIC */
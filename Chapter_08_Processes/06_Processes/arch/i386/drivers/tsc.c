@@ -0,0 +1,56 @@
+/*! Time stamp counter (clocksource device) */
+#ifdef TSC
+
+#include "tsc.h"
+
+#include "../processor.h"
+
+#include <kernel/errno.h>
+#include <types/bits.h>
+
+/*! clocksource device tsc, wrapper for arch_clocksource_t interface */
+arch_clocksource_t tsc = (arch_clocksource_t)
+{
+	.name = "TSC",
+	.freq_khz = 0,
+	.mult = 0,
+	.shift = 0,
+	.init = tsc_init,
+	.read = tsc_read
+};
+/* accessed from 'arch' layer via: extern arch_clocksource_t tsc */
+
+/*! Check for TSC and measure its frequency with i8253 */
+static int tsc_init ()
+{
+	uint64 ticks, min = (uint64) -1;
+	int i;
+
+	if ( !arch_tsc_supported () )
+		return ENODEV;
+
+	/* interrupts or emulator delays may only lengthen measurement */
+	for ( i = 0; i < TSC_CALIBRATE_TRIES; i++ )
+	{
+		ticks = i8253_calibrate ( tsc_read, I8253_CALIBRATE_COUNT );
+		if ( ticks < min )
+			min = ticks;
+	}
+
+	if ( min >> 32 || min < TSC_MIN_TICKS )
+		return ENODEV;
+
+	/* freq = ticks * I8253_CALIBRATE_FREQ / cnt [Hz] */
+	tsc.freq_khz = mul_div_32 ( (uint32) min, I8253_CALIBRATE_FREQ,
+				    I8253_CALIBRATE_COUNT * 1000 );
+
+	return 0;
+}
+
+/*! Read counter */
+static uint64 tsc_read ()
+{
+	return arch_rdtsc ();
+}
+
+#endif /* TSC */
@@ -0,0 +1,14 @@
+/*! Time stamp counter (clocksource) - included from only tsc.c ! */
+#ifdef TSC
+
+#pragma once
+
+#include "../time.h"
+
+#define TSC_CALIBRATE_TRIES	3	/* shortest measurement is used */
+#define TSC_MIN_TICKS		10000	/* per try: at least 1 MHz */
+
+static int tsc_init ();
+static uint64 tsc_read ();
+
+#endif /* TSC */
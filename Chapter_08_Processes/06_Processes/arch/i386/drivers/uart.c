@@ -162,7 +162,7 @@ static int uart_interrupt_handler ( int irq_num, void *device )
 		iir = inb ( up->port + IIR );
 
 		if ( !( iir & IIR_INT_PENDING ) )
-			return 0; /* no interrupt pending from this device */
+			return rcv; /* no (more) interrupts pending */
 
 		if ( iir & IIR_TIMEOUT )
 			brk = TRUE;
@@ -361,7 +361,8 @@ device_t uart_com1 = (device_t)
 	.send =		uart_send,
 	.recv =		uart_recv,
 
-	.flags = 	DEV_TYPE_SHARED | DEV_TYPE_CONSOLE,
+	.flags = 	DEV_TYPE_SHARED | DEV_TYPE_CONSOLE |
+			DEV_TYPE_BLOCKING,
 	.params = 	&com1_params
 };
 
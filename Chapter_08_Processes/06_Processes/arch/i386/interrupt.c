@@ -2,11 +2,13 @@
 
 #define _ARCH_INTERRUPTS_C_
 #include "interrupt.h"
+#include "context.h"
 
 #include <arch/processor.h>
 #include <kernel/errno.h>
 #include <lib/list.h>
 #include <kernel/memory.h>
+#include <kernel/latency.h>
 
 /*! Interrupt controller device */
 extern arch_ic_t IC_DEV;
@@ -30,15 +32,25 @@ struct ihndlr
 	list_h list;
 };
 
+/*! interrupt handler descriptors */
+static kmem_cache_t *ihndlr_cache;
+
 /*! Initialize interrupt subsystem (in 'arch' layer) */
 void arch_init_interrupts ()
 {
 	int i;
 
-	icdev->init ();
-
 	for ( i = 0; i < INTERRUPTS; i++ )
 		list_init ( &ihandlers[i] );
+
+	ihndlr_cache = kmem_cache_create ( "ihndlr", sizeof (struct ihndlr) );
+
+	/* controller may register its own handlers (e.g. spurious) */
+	icdev->init ();
+
+#ifdef USE_SSE
+	arch_sse_init ();
+#endif
 }
 
 /*!
@@ -54,6 +66,22 @@ void arch_irq_disable ( unsigned int irq )
 	icdev->disable_irq ( irq );
 }
 
+/*! interrupt priority levels (see include/arch/interrupt.h) */
+unsigned int arch_irq_set_level ( unsigned int level )
+{
+	if ( icdev->set_level )
+		return icdev->set_level ( level );
+	else
+		return 0;
+}
+unsigned int arch_irq_get_level ( unsigned int irq )
+{
+	if ( icdev->get_level )
+		return icdev->get_level ( irq );
+	else
+		return 0;
+}
+
 /*! Register handler function for particular interrupt number */
 void arch_register_interrupt_handler ( unsigned int inum, void *handler,
 				       void *device )
@@ -62,7 +90,7 @@ void arch_register_interrupt_handler ( unsigned int inum, void *handler,
 
 	if ( inum < INTERRUPTS )
 	{
-		ih = kmalloc ( sizeof (struct ihndlr) );
+		ih = kmem_cache_alloc ( ihndlr_cache );
 		ASSERT ( ih );
 
 		ih->device = device;
@@ -91,7 +119,10 @@ void arch_unregister_interrupt_handler ( unsigned int irq_num, void *handler,
 		next = list_get_next ( &ih->list );
 
 		if ( ih->ihandler == handler && ih->device == device )
+		{
 			list_remove ( &ihandlers[irq_num], FIRST, &ih->list );
+			kmem_cache_free ( ihndlr_cache, ih );
+		}
 
 		ih = next;
 	}
@@ -108,6 +139,14 @@ void arch_interrupt_handler ( int irq_num )
 	prev_mode = new_mode;
 	new_mode = KERNEL_MODE;
 
+	/* controller may deliver interrupt through other vector */
+	if ( icdev->irq_number )
+		irq_num = icdev->irq_number ( irq_num );
+
+#ifdef LATENCY_TRACE
+	klatency_interrupt ( irq_num );
+#endif
+
 	if ( irq_num < INTERRUPTS && (ih = list_get (&ihandlers[irq_num], FIRST)) )
 	{
 		/* Call registered handlers */
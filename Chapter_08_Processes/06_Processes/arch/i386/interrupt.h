@@ -3,6 +3,7 @@
 #pragma once
 
 /* Constants */
+#define INT_NM			7	/* Device Not Available (FPU/SSE) */
 #define INT_STF			12	/* Stack Fault */
 #define INT_GPF			13	/* General Protection Fault */
 
@@ -22,12 +23,23 @@ typedef struct _interrupt_controller_
 	void   (*at_exit) ( unsigned int irq );
 
 	char  *(*int_descr) ( unsigned int irq );
+
+	unsigned int (*set_level) ( unsigned int level );
+		/* hold back interrupts with priority class <= level
+		 * (optional: NULL if controller has no priorities) */
+	unsigned int (*get_level) ( unsigned int irq );
+		/* priority class of interrupt (optional, as set_level) */
+
+	unsigned int (*irq_number) ( unsigned int vector );
+		/* interrupt number for handlers when controller delivers
+		 * it through other vector (optional: NULL if same) */
 }
 arch_ic_t;
 
 #endif /* ASM_FILE */
 
-/* Programmable Interrupt controllers (currently implemented only one, i8259) */
+/* Programmable Interrupt controllers: i8259, or I/O APIC with local APIC;
+ * both use interrupt numbers defined for i8259 */
 #include <ARCH/drivers/i8259.h>
 
 #define INTERRUPTS		(SOFT_IRQ + 1)
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <types/basic.h>
+
 #define arch_disable_interrupts()	asm volatile ( "cli\n\t" )
 #define arch_enable_interrupts()	asm volatile ( "sti\n\t" )
 
@@ -15,6 +17,77 @@
 
 #define arch_memory_barrier()		asm ("" : : : "memory")
 
+/*! atomic operations on (aligned) 32 bit word in memory */
+
+/* if *adr == old then *adr = new; return previous value of *adr */
+static inline int arch_atomic_cmpxchg ( volatile int *adr, int old, int new )
+{
+	int prev;
+
+	asm volatile (	"lock cmpxchgl %2, %1\n\t"
+			: "=a" (prev), "+m" (*adr)
+			: "r" (new), "0" (old)
+			: "memory" );
+	return prev;
+}
+
+/* *adr = val; return previous value of *adr */
+static inline int arch_atomic_xchg ( volatile int *adr, int val )
+{
+	asm volatile (	"xchgl %0, %1\n\t"
+			: "+r" (val), "+m" (*adr)
+			:
+			: "memory" );
+	return val;
+}
+
+/* *adr += val; return previous value of *adr */
+static inline int arch_atomic_add ( volatile int *adr, int val )
+{
+	asm volatile (	"lock xaddl %0, %1\n\t"
+			: "+r" (val), "+m" (*adr)
+			:
+			: "memory" );
+	return val;
+}
+
+/*! read time stamp counter (processor cycles since reset) */
+static inline uint64 arch_rdtsc ()
+{
+	uint64 tsc;
+
+	asm volatile ( "rdtsc" : "=A" (tsc) );
+
+	return tsc;
+}
+
+/*! is time stamp counter present? (cpuid: function 1, edx bit 4) */
+static inline int arch_tsc_supported ()
+{
+	uint32 a, b, c, d;
+
+	asm volatile ( "cpuid" : "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+		       : "a" (1) );
+
+	return ( d >> 4 ) & 1;
+}
+
+/*! read model specific register */
+static inline uint64 arch_rdmsr ( uint32 msr )
+{
+	uint64 val;
+
+	asm volatile ( "rdmsr" : "=A" (val) : "c" (msr) );
+
+	return val;
+}
+
+/*! write model specific register */
+static inline void arch_wrmsr ( uint32 msr, uint64 val )
+{
+	asm volatile ( "wrmsr" :: "c" (msr), "A" (val) : "memory" );
+}
+
 #include <ARCH/drivers/acpi_power_off.h>
 #define arch_power_off()			\
 do {						\
@@ -0,0 +1,229 @@
+/*! Memory copy and fill functions (rep movs/stos, SSE2 for copy) */
+#pragma once
+
+#include <types/basic.h>
+
+/* define which operations are implemented with hardware support */
+#define ARCH_MEMSET
+#define ARCH_MEMCPY
+#define ARCH_MEMMOVE
+
+/*
+ * SSE2 is used only in programs: their threads get FPU/SSE context on first
+ * use (lazy switching); kernel code runs with context of interrupted thread
+ * and must not change its SSE registers
+ */
+#if defined(USE_SSE) && !defined(_KERNEL_)
+#define ARCH_MEM_SSE
+#define ARCH_MEM_SSE_MIN	128	/* smaller blocks: rep movs */
+#endif
+
+/* smaller blocks are copied in a loop (rep has a startup cost) */
+#define ARCH_MEM_REP_MIN	64
+
+/* word that may alias any other type (for copying in a loop) */
+typedef uint32 __attribute__ (( __may_alias__ )) arch_mem_word_t;
+
+/*!
+ * Fill memory with 32-bit words (destination is first aligned to 4 bytes)
+ * \param s Block of memory to fill
+ * \param c Value to be set (lowest 8 bits)
+ * \param n Number of bytes
+ * \return s
+ */
+static inline void *arch_memset_words ( void *s, int c, size_t n )
+{
+	uint8 *d = s;
+	uint32 v = (uint8) c;
+	size_t cnt;
+
+	v |= v << 8;
+	v |= v << 16;
+
+	if ( n < ARCH_MEM_REP_MIN )
+	{
+		for ( ; n >= 4; n -= 4, d += 4 )
+			*( (arch_mem_word_t *) d ) = v;
+		for ( ; n > 0; n--, d++ )
+			*d = (uint8) v;
+
+		return s;
+	}
+
+	cnt = ( - (size_t) d ) & 3;
+	n -= cnt;
+	asm volatile ( "rep stosb" : "+D" (d), "+c" (cnt) : "a" (v)
+		       : "memory" );
+
+	cnt = n >> 2;
+	n &= 3;
+	asm volatile ( "rep stosl" : "+D" (d), "+c" (cnt) : "a" (v)
+		       : "memory" );
+	asm volatile ( "rep stosb" : "+D" (d), "+c" (n) : "a" (v) : "memory" );
+
+	return s;
+}
+
+/*!
+ * Copy memory with 32-bit words (destination is first aligned to 4 bytes)
+ * \param dest Destination address
+ * \param src Source address
+ * \param n Number of bytes
+ * \return dest
+ */
+static inline void *arch_memcpy_words ( void *dest, const void *src, size_t n )
+{
+	uint8 *d = dest;
+	const uint8 *s = src;
+	size_t cnt;
+
+	if ( n < ARCH_MEM_REP_MIN )
+	{
+		for ( ; n >= 4; n -= 4, d += 4, s += 4 )
+			*( (arch_mem_word_t *) d ) =
+				*( (const arch_mem_word_t *) s );
+		for ( ; n > 0; n--, d++, s++ )
+			*d = *s;
+
+		return dest;
+	}
+
+	cnt = ( - (size_t) d ) & 3;
+	n -= cnt;
+	asm volatile ( "rep movsb" : "+D" (d), "+S" (s), "+c" (cnt)
+		       :: "memory" );
+
+	cnt = n >> 2;
+	n &= 3;
+	asm volatile ( "rep movsl" : "+D" (d), "+S" (s), "+c" (cnt)
+		       :: "memory" );
+	asm volatile ( "rep movsb" : "+D" (d), "+S" (s), "+c" (n) :: "memory" );
+
+	return dest;
+}
+
+#ifdef ARCH_MEM_SSE
+/* compiler uses xmm registers only when SSE is enabled for it (e.g. -msse) */
+#ifdef __SSE__
+#define ARCH_XMM_CLOBBERS	"xmm0", "xmm1", "xmm2", "xmm3",
+#else
+#define ARCH_XMM_CLOBBERS
+#endif
+
+/*! Is SSE2 supported by processor? (cpuid is checked on first call) */
+static inline int arch_sse2_supported ()
+{
+	static int sse2 = -1;
+	uint32 a, b, c, d;
+
+	if ( sse2 == -1 )
+	{
+		asm volatile ( "cpuid" : "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+			       : "a" (1) );
+		sse2 = ( d >> 26 ) & 1;
+	}
+
+	return sse2;
+}
+
+/*!
+ * Copy memory with 16-byte SSE2 loads and stores, 64 bytes per iteration
+ * (destination is first aligned to 16 bytes; less than 64 bytes may remain)
+ * Forward copy: it is also safe for overlapping blocks when dest < src.
+ * \param dest Destination address (updated to first byte not copied)
+ * \param src Source address (updated to first byte not copied)
+ * \param n Number of bytes (updated to number of bytes not copied)
+ */
+static inline void arch_memcpy_sse ( void **dest, const void **src, size_t *n )
+{
+	uint8 *d = *dest;
+	const uint8 *s = *src;
+	size_t cnt;
+
+	cnt = ( - (size_t) d ) & 15;
+	*n -= cnt;
+	asm volatile ( "rep movsb" : "+D" (d), "+S" (s), "+c" (cnt)
+		       :: "memory" );
+
+	cnt = *n >> 6;
+	if ( cnt )
+		asm volatile ( "1:\n\t"
+			       "movdqu   (%1), %%xmm0\n\t"
+			       "movdqu 16(%1), %%xmm1\n\t"
+			       "movdqu 32(%1), %%xmm2\n\t"
+			       "movdqu 48(%1), %%xmm3\n\t"
+			       "movdqa %%xmm0,   (%0)\n\t"
+			       "movdqa %%xmm1, 16(%0)\n\t"
+			       "movdqa %%xmm2, 32(%0)\n\t"
+			       "movdqa %%xmm3, 48(%0)\n\t"
+			       "add $64, %0\n\t"
+			       "add $64, %1\n\t"
+			       "dec %2\n\t"
+			       "jnz 1b"
+			       : "+r" (d), "+r" (s), "+r" (cnt)
+			       :: ARCH_XMM_CLOBBERS "memory" );
+
+	*n &= 63;
+	*dest = d;
+	*src = s;
+}
+#undef ARCH_XMM_CLOBBERS
+#endif /* ARCH_MEM_SSE */
+
+/*!
+ * Fill memory (rep stosl; SSE2 stores were not faster in measurements with
+ * lib/test/string_test.c, since "fast strings" microcode handles rep stos)
+ */
+static inline void *arch_memset ( void *s, int c, size_t n )
+{
+	return arch_memset_words ( s, c, n );
+}
+
+/*! Copy memory: SSE2 for large blocks (if available), words otherwise */
+static inline void *arch_memcpy ( void *dest, const void *src, size_t n )
+{
+#ifdef ARCH_MEM_SSE
+	void *d = dest;
+	const void *s = src;
+
+	if ( n >= ARCH_MEM_SSE_MIN && arch_sse2_supported () )
+	{
+		arch_memcpy_sse ( &d, &s, &n );
+		arch_memcpy_words ( d, s, n );
+		return dest;
+	}
+#endif
+	return arch_memcpy_words ( dest, src, n );
+}
+
+/*!
+ * Copy memory, blocks may overlap
+ * (if dest is before src forward copy is safe; otherwise copy backward, with
+ * direction flag set: first n % 4 last bytes, then words)
+ */
+static inline void *arch_memmove ( void *dest, const void *src, size_t n )
+{
+	uint8 *d;
+	const uint8 *s;
+	size_t cnt;
+
+	if ( dest <= src || (const uint8 *) src + n <= (uint8 *) dest )
+		return arch_memcpy ( dest, src, n );
+
+	d = (uint8 *) dest + n - 1;
+	s = (const uint8 *) src + n - 1;
+
+	cnt = n & 3;
+	asm volatile ( "std\n\t"
+		       "rep movsb\n\t"
+		       "cld" : "+D" (d), "+S" (s), "+c" (cnt) :: "memory" );
+
+	d -= 3;
+	s -= 3;
+	cnt = n >> 2;
+	asm volatile ( "std\n\t"
+		       "rep movsl\n\t"
+		       "cld" : "+D" (d), "+S" (s), "+c" (cnt) :: "memory" );
+
+	return dest;
+}
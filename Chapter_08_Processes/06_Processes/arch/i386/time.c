@@ -2,11 +2,30 @@
 
 #include "time.h"
 
+#include <kernel/errno.h>
+#include <types/bits.h>
 #include <types/time.h>
 
 extern arch_timer_t TIMER;
 static arch_timer_t *timer = &TIMER;
 
+/* clocksource: if defined (and present), time is read from it, not timer */
+#ifdef CLOCKSOURCE
+extern arch_clocksource_t CLOCKSOURCE;
+static arch_clocksource_t *clocksource = &CLOCKSOURCE;
+#else
+static arch_clocksource_t *clocksource = NULL;
+#endif
+
+static timespec_t cs_time;	/* time when clocksource had 'cs_last' */
+static uint64 cs_last;		/* clocksource value at 'cs_time' */
+static uint32 cs_frac;		/* nanosecond fraction (<< shift) at cs_time */
+static uint32 cs_max_cycles;	/* max. cycles converted at once (~1 s) */
+
+static void clocksource_init ();
+static uint32 clocksource_add ( timespec_t *time, uint64 cycles,
+				uint32 frac );
+
 static timespec_t clock;	/* system time starting from 0:00 at power on */
 static timespec_t delay;	/* delay set by kernel, or timer->max_count */
 static timespec_t last_load;/* last time equivalent loaded to counter */
@@ -45,9 +64,84 @@ void arch_timer_init ()
 	if ( timer->min_interval.tv_sec % 2 )
 		threshold.tv_nsec += 1000000000L / 2; /* + half second */
 
+	clocksource_init ();
+
 	return;
 }
 
+/*! Initialize clocksource (if present) and its conversion to nanoseconds */
+static void clocksource_init ()
+{
+	uint32 khz;
+
+	if ( !clocksource )
+		return;
+
+	if ( clocksource->init () || !clocksource->freq_khz )
+	{
+		LOG ( WARN, "Clocksource %s not usable", clocksource->name );
+		clocksource = NULL;
+		return;
+	}
+	khz = clocksource->freq_khz;
+
+	/*
+	 * ns = cycles * 10^6 / khz = ( cycles * mult ) >> shift, where
+	 * mult = ( 10^6 << shift ) / khz; largest shift (most precise mult)
+	 * for which mult fits in 32 bits
+	 */
+	clocksource->shift = 31;
+	while ( clocksource->shift &&
+		( ( (uint64) 1000000 << clocksource->shift ) >> 32 ) >= khz )
+		clocksource->shift--;
+	clocksource->mult = mul_div_32 ( 1000000, 1U << clocksource->shift,
+					 khz );
+
+	/* cycles in one second, so that converted nanoseconds fit 32 bits */
+	if ( khz < 0xffffffff / 1000 )
+		cs_max_cycles = khz * 1000;
+	else
+		cs_max_cycles = 0xffffffff;
+
+	cs_time = clock;
+	cs_frac = 0;
+	cs_last = clocksource->read ();
+}
+
+/*!
+ * Convert clocksource cycles to time and add it to 'time'
+ * \param time Time to update
+ * \param cycles Number of clocksource cycles to add
+ * \param frac Nanosecond fraction (<< shift) already in 'time'
+ * \return Nanosecond fraction (<< shift) remaining after conversion
+ */
+static uint32 clocksource_add ( timespec_t *time, uint64 cycles,
+				uint32 frac )
+{
+	timespec_t add;
+	uint64 ns;
+	uint32 part;
+
+	while ( cycles )
+	{
+		if ( cycles > cs_max_cycles )
+			part = cs_max_cycles;
+		else
+			part = (uint32) cycles;
+		cycles -= part;
+
+		ns = (uint64) part * clocksource->mult + frac;
+		frac = (uint32) ns & ( ( 1U << clocksource->shift ) - 1 );
+		ns >>= clocksource->shift; /* ns < 2^32 */
+
+		add.tv_sec = (uint32) ns / 1000000000;
+		add.tv_nsec = (uint32) ns % 1000000000;
+		time_add ( time, &add );
+	}
+
+	return frac;
+}
+
 /*!
  * Set next timer activation
  * \param time Time of next activation
@@ -83,6 +177,14 @@ void arch_get_time ( timespec_t *time )
 {
 	timespec_t remainder;
 
+	if ( clocksource )
+	{
+		*time = cs_time;
+		clocksource_add ( time, clocksource->read () - cs_last,
+				  cs_frac );
+		return;
+	}
+
 	timer->get_interval_remainder ( &remainder );
 
 	*time = last_load;
@@ -101,6 +203,13 @@ void arch_set_time ( timespec_t *time )
 
 	clock = *time;
 
+	if ( clocksource )
+	{
+		cs_time = clock;
+		cs_frac = 0;
+		cs_last = clocksource->read ();
+	}
+
 	/* let kernel handle time shift problems */
 	if ( alarm_handler )
 	{
@@ -117,9 +226,18 @@ void arch_set_time ( timespec_t *time )
 static void arch_timer_handler ()
 {
 	void (*k_handler) ();
+	uint64 now;
 
 	time_add ( &clock, &last_load );
 
+	/* move clocksource base, so that cycles since base stay few */
+	if ( clocksource )
+	{
+		now = clocksource->read ();
+		cs_frac = clocksource_add ( &cs_time, now - cs_last, cs_frac );
+		cs_last = now;
+	}
+
 	time_sub ( &delay, &last_load );
 	last_load = timer->max_interval;
 
@@ -19,4 +19,31 @@ typedef struct _arch_timer_t_
 }
 arch_timer_t;
 
+/*!
+ * (arch) clocksource interface: free running counter used for reading time,
+ * independent of timer device (which is used only for interrupts)
+ */
+typedef struct _arch_clocksource_t_
+{
+	char	 *name;
+
+	uint32	  freq_khz;
+		  /* counter frequency, set by 'init' */
+
+	uint32	  mult;
+	uint32	  shift;
+		  /* conversion: ns = ( cycles * mult ) >> shift */
+
+	int	(*init) ();
+		  /* detect and calibrate counter; 0 if counter can be used */
+
+	uint64	(*read) ();
+}
+arch_clocksource_t;
+
+/* reference counter for calibration of other counters (i8253.c) */
+uint64 i8253_calibrate ( uint64 (*read) (), uint cnt );
+#define I8253_CALIBRATE_FREQ	1193180	/* i8253 counter frequency */
+#define I8253_CALIBRATE_COUNT	11932	/* i8253 ticks in 10 ms */
+
 #include <arch/time.h>
@@ -11,6 +11,7 @@ typedef struct _prog_info_t_
 	void   *entry;		/* starting user function */
 	void   *param;		/* parameter to starting function */
 	void   *exit;		/* terminating function */
+	void   *sigev_worker;	/* SIGEV_THREAD notification thread */
 	uint    prio;
 
 	size_t  heap_size;
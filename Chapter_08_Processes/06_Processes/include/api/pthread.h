@@ -12,6 +12,8 @@ pthread_t pthread_self (void);
 
 int pthread_attr_init ( pthread_attr_t *attr );
 int pthread_attr_destroy ( pthread_attr_t *attr );
+int pthread_attr_setsigevthreads_np ( pthread_attr_t *attr, uint threads );
+int pthread_attr_settimerslack_np ( pthread_attr_t *attr, int slack );
 
 /*! Scheduling parameters */
 int pthread_attr_setschedpolicy ( pthread_attr_t *attr, int policy);
@@ -24,14 +26,22 @@ int pthread_getschedparam ( pthread_t thread, int *policy,
 			    struct sched_param *param );
 
 /*! EDF scheduling */
-int edf_set ( timespec_t deadline, timespec_t period, int flags );
+int edf_set ( timespec_t deadline, timespec_t period, timespec_t wcet,
+	      int flags );
 int edf_wait ();
 int edf_exit ();
 
+/*! RM scheduling */
+int rm_set ( timespec_t period, timespec_t wcet );
+
 /*! Create process */
 int posix_spawn ( pid_t *pid, char *path, void *file_actions,
 		  void *attrp, char *argv[], char *envp[] );
 
+/*! Futex (used for mutex, condition variable and semaphore) */
+int futex_wait ( int *futex, int val );
+int futex_wake ( int *futex, int n );
+
 /*! Mutex */
 int pthread_mutex_init ( pthread_mutex_t *mutex, pthread_mutexattr_t *attr );
 int pthread_mutex_destroy ( pthread_mutex_t * mutex );
@@ -40,6 +50,12 @@ int pthread_mutex_unlock ( pthread_mutex_t *mutex );
 
 int pthread_mutexattr_init ( pthread_mutexattr_t *attr );
 int pthread_mutexattr_destroy ( pthread_mutexattr_t *attr );
+int pthread_mutexattr_setprotocol ( pthread_mutexattr_t *attr, int protocol );
+int pthread_mutexattr_getprotocol ( pthread_mutexattr_t *attr, int *protocol );
+int pthread_mutexattr_setprioceiling ( pthread_mutexattr_t *attr,
+				       int prioceiling );
+int pthread_mutexattr_getprioceiling ( pthread_mutexattr_t *attr,
+				       int *prioceiling );
 
 /*! Condition variable */
 int pthread_cond_init ( pthread_cond_t *cond, pthread_condattr_t *attr );
@@ -15,3 +15,4 @@ int timer_delete ( timer_t *timer );
 int timer_settime ( timer_t *timer, int flags, itimerspec_t *value,
 		     itimerspec_t *ovalue );
 int timer_gettime ( timer_t *timer, itimerspec_t *value );
+int timer_getoverrun ( timer_t *timer );
@@ -18,7 +18,8 @@ struct _device_t_
 
 	int   (*irq_handler) ( int irq_num, void *device );
 		/* interrupt handler function (test if device is interrupt
-		 * source and handle it if it is) */
+		 * source and handle it if it is); returns >0 if new data
+		 * is received (threads blocked on read are then woken) */
 
 	int   (*callback) ( int irq_num, void *device );
 		/* callback function (to kernel) - when event require
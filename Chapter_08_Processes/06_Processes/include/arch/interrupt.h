@@ -28,6 +28,17 @@ void arch_return_to_thread ();
 void arch_irq_enable ( unsigned int irq );
 void arch_irq_disable ( unsigned int irq );
 
+/*!
+ * Interrupt priority levels (if controller supports them, as APIC does;
+ * otherwise level is always 0): arch_irq_set_level holds back interrupts
+ * with priority class at or below 'level' and returns previous level;
+ * arch_irq_get_level returns priority class of interrupt 'irq', so that
+ * arch_irq_set_level ( arch_irq_get_level ( irq ) ) holds back 'irq' and
+ * all interrupts with same or lower priority
+ */
+unsigned int arch_irq_set_level ( unsigned int level );
+unsigned int arch_irq_get_level ( unsigned int irq );
+
 /*! detecting segmentation faults - from threads or kernel */
 
 /*! return current processor operating mode (KERNEL_MODE or USER_MODE) */
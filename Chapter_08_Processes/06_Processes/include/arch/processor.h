@@ -20,5 +20,10 @@
 /*! memory barrier */
 #define memory_barrier()	arch_memory_barrier()
 
+/*! atomic operations on word (return previous value) */
+#define atomic_cmpxchg(adr,old,new)	arch_atomic_cmpxchg(adr,old,new)
+#define atomic_xchg(adr,val)		arch_atomic_xchg(adr,val)
+#define atomic_add(adr,val)		arch_atomic_add(adr,val)
+
 /*! power off, if supported */
 #define power_off()		arch_power_off()
@@ -0,0 +1,8 @@
+/*! Memory copy and fill functions
+ *
+ * define which operations are implemented with hardware support
+ * for example, if arch_memcpy is implemented define macro ARCH_MEMCPY
+ */
+#pragma once
+
+#include <ARCH/string.h>
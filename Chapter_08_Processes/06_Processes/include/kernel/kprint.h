@@ -6,5 +6,6 @@
 #include <types/io.h>
 
 int kprintf ( char *format, ... );
+int ksprintf ( char *str, size_t size, char *format, ... );
 
 #endif /* _KERNEL_ */
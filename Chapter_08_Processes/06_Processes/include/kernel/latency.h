@@ -0,0 +1,6 @@
+/*! Scheduling latency tracer - interface for arch layer */
+#pragma once
+
+#ifdef LATENCY_TRACE
+void klatency_interrupt ( unsigned int inum );
+#endif
@@ -15,6 +15,13 @@ extern inline int kfree ( void *chunk );
 struct _kobject_t_; typedef struct _kobject_t_ kobject_t;
 struct _kprog_t_; typedef struct _kprog_t_ kprog_t;
 struct _kprocess_t_; typedef struct _kprocess_t_ kprocess_t;
+struct _kmem_cache_t_; typedef struct _kmem_cache_t_ kmem_cache_t;
+
+/*! object caches (for frequently allocated fixed size objects) */
+kmem_cache_t *kmem_cache_create ( char *name, size_t size );
+void kmem_cache_destroy ( kmem_cache_t *cache );
+void *kmem_cache_alloc ( kmem_cache_t *cache );
+void kmem_cache_free ( kmem_cache_t *cache, void *obj );
 
 extern inline void *k_process_start_adr ( void *proc );
 extern inline size_t k_process_size ( void *proc );
@@ -13,6 +13,9 @@ int sys__pthread_setschedparam ( void *p );
 
 int sys__posix_spawn ( void *p );
 
+int sys__futex_wait ( void *p );
+int sys__futex_wake ( void *p );
+
 int sys__pthread_mutex_init ( void *p );
 int sys__pthread_mutex_destroy ( void *p );
 int sys__pthread_mutex_lock ( void *p );
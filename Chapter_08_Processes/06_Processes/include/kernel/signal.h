@@ -11,6 +11,9 @@ int sys__sigaction ( void *p );
 /*int sys__sigwaitinfo ( sigset_t *set, siginfo_t *info );*/
 int sys__sigwaitinfo ( void *p );
 
+/*int sys__sigev_wait ( void (**func) ( sigval_t ), sigval_t *value );*/
+int sys__sigev_wait ( void *p );
+
 /* int sys__sigqueue ( pid_t pid, int signo, sigval_t sigval ); */
 int sys__sigqueue ( void *p );
 
@@ -19,6 +19,7 @@ enum {
 	TIMER_DELETE,
 	TIMER_SETTIME,
 	TIMER_GETTIME,
+	TIMER_GETOVERRUN,
 
 	OPEN,
 	CLOSE,
@@ -33,6 +34,9 @@ enum {
 
 	PTHREAD_SETSCHEDPARAM,
 
+	FUTEX_WAIT,
+	FUTEX_WAKE,
+
 	PTHREAD_MUTEX_INIT,
 	PTHREAD_MUTEX_DESTROY,
 	PTHREAD_MUTEX_LOCK,
@@ -57,6 +61,7 @@ enum {
 	PTHREAD_SIGMASK,
 	SIGQUEUE,
 	SIGWAITINFO,
+	SIGEV_WAIT,
 
 	POSIX_SPAWN,
 
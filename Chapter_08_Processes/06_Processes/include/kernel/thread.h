@@ -4,12 +4,31 @@
 #ifdef _KERNEL_ /* (for kernel and arch layer) */
 
 #include <lib/list.h>
+#include <types/basic.h>
+
+/*
+ * Priority ordered queue: threads are in single list, sorted by priority
+ * (highest first, FIFO among equal). Bitmap 'mask' has one bit for each
+ * priority level present in queue, and for each such level its last thread
+ * is saved. New thread is inserted after last thread of its level or of first
+ * higher level present (found with lsb_index on bitmap words); thread in
+ * queue is recognized by its 'queue' pointer. Insert and remove are O(1).
+ */
+#define KTHREADQ_FIFO		0
+#define KTHREADQ_PRIO		1
+
+#define KTHREADQ_WORDS		( ( PRIO_LEVELS + 31 ) / 32 )
 
 /*! Thread queue (only structure required to be visible outside thread.c) */
 typedef struct _kthread_q_
 {
 	list_t  q;		/* queue implementation in list.h/list.c */
-	/* uint flags; */	/* various flags, e.g. sort order */
+	uint	flags;		/* order: KTHREADQ_FIFO or KTHREADQ_PRIO */
+
+	uint32	mask[KTHREADQ_WORDS];
+				/* priority order: levels present in queue */
+	void   *last[PRIO_LEVELS];
+				/* priority order: last thread on level */
 }
 kthread_q;
 
@@ -13,3 +13,4 @@ int sys__timer_create ( void *p );
 int sys__timer_delete ( void *p );
 int sys__timer_settime ( void *p );
 int sys__timer_gettime ( void *p );
+int sys__timer_getoverrun ( void *p );
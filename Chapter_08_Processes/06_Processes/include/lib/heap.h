@@ -0,0 +1,65 @@
+/*!
+ * Binary heap (priority queue) of objects
+ *
+ * properties:
+ * - top element is the "smallest" one, by compare function given at init
+ * - insert, remove (any element) and update are O(log n), get top is O(1)
+ * - objects for heap must have heap_h element included (as with list_h in
+ *   list.h); heap_h holds element position, so any element can be removed
+ * - heap does not allocate memory: array for element pointers is provided
+ *   by caller (and can be replaced with bigger one with heap_resize)
+ */
+#pragma once
+
+#ifdef MEM_TEST
+#include "test/test.h"
+#endif
+#include <types/basic.h>
+
+/*! Heap element */
+typedef struct _heap_h_
+{
+	void  *object;
+	       /* pointer to object (which contains this heap_h) */
+
+	int    index;
+	       /* position in heap array, -1 if not in heap */
+}
+heap_h;
+
+/*! Heap header */
+typedef struct _heap_t_
+{
+	heap_h	**elem;
+		  /* array of pointers to elements, elem[0] is on top */
+
+	uint	  size;
+		  /* number of elements in heap */
+
+	uint	  max;
+		  /* size of 'elem' array */
+
+	int	(*cmp) ( void *, void * );
+		  /* compare objects: <0 when first should be above second */
+}
+heap_t;
+
+void heap_init ( heap_t *heap, int (*cmp) ( void *, void * ),
+		 heap_h **mem, uint max );
+void heap_resize ( heap_t *heap, heap_h **mem, uint max );
+
+int heap_insert ( heap_t *heap, void *object, heap_h *hdr );
+void *heap_remove ( heap_t *heap, heap_h *hdr );
+void heap_update ( heap_t *heap, heap_h *hdr );
+
+/*! Get object on top of heap (NULL if heap is empty) */
+static inline void *heap_get ( heap_t *heap )
+{
+	return heap->size ? heap->elem[0]->object : NULL;
+}
+
+/*! Is heap full (new array must be given with heap_resize)? */
+static inline int heap_is_full ( heap_t *heap )
+{
+	return heap->size == heap->max;
+}
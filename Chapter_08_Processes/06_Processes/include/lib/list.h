@@ -38,6 +38,9 @@
 */
 #pragma once
 
+#ifdef MEM_TEST
+#include "test/test.h"
+#endif
 #include <types/basic.h>
 
 /*! List element pointers */
@@ -79,6 +82,10 @@ void list_append ( list_t *list, void *object, list_h *hdr );
 /*! Add element to list, add to head - as first element */
 void list_prepend ( list_t *list, void *object, list_h *hdr );
 
+/*! Add element to list, after given element (as first if 'after' is NULL) */
+void list_insert_after ( list_t *list, void *object, list_h *hdr,
+			 list_h *after );
+
 /*! Add element to sorted list */
 void list_sort_add ( list_t *list, void *object, list_h *hdr,
 				   int (*cmp) ( void *, void * ) );
@@ -0,0 +1,114 @@
+/*!
+ * Hierarchical bit mask for O(1) searching of highest set bit (priority)
+ *
+ * properties:
+ * - one bit per priority level in leaf words (32 levels per word)
+ * - every upper level word has one bit per (not empty) word of level below
+ * - top level is always single (summary) word
+ * - highest set bit is found with one 'msb_index' call per level
+ *
+ * With 32 bit words two levels cover 1024 priority levels and three levels
+ * cover 32768; number of levels is calculated at initialization, so for given
+ * configuration search cost is constant (does not depend on number of set
+ * bits or their position).
+ */
+#pragma once
+
+#ifdef MEM_TEST
+#include "test/test.h"
+#endif
+#include <types/basic.h>
+#include <types/bits.h>
+
+#define PRIO_BITMAP_WBITS	32	/* bits per word */
+#define PRIO_BITMAP_SHIFT	5	/* log2 ( PRIO_BITMAP_WBITS ) */
+#define PRIO_BITMAP_MAX_DEPTH	3	/* up to 32^3 = 32768 levels */
+
+/*! hierarchical bit mask */
+typedef struct _prio_bitmap_t_
+{
+	uint	 levels;
+		 /* number of bits (priority levels) */
+
+	uint	 depth;
+		 /* number of levels in hierarchy (1 - PRIO_BITMAP_MAX_DEPTH) */
+
+	uint32	*word[PRIO_BITMAP_MAX_DEPTH];
+		 /* word[0] is summary word, word[depth-1] are leaf words */
+}
+prio_bitmap_t;
+
+/*! interface */
+size_t prio_bitmap_size ( uint levels );
+void prio_bitmap_init ( prio_bitmap_t *bm, uint levels, void *mem );
+
+/*!
+ * Set bit 'prio' (and mark it in upper levels, if not already marked)
+ * \param bm Bit mask
+ * \param prio Bit index
+ */
+static inline void prio_bitmap_set ( prio_bitmap_t *bm, uint prio )
+{
+	int d;
+	uint32 *w, old;
+
+	for ( d = bm->depth - 1; d >= 0; d-- )
+	{
+		w = &bm->word[d][ prio >> PRIO_BITMAP_SHIFT ];
+		old = *w;
+		*w |= ( (uint32) 1 ) << ( prio & ( PRIO_BITMAP_WBITS - 1 ) );
+
+		if ( old ) /* upper levels already have this word marked */
+			break;
+
+		prio >>= PRIO_BITMAP_SHIFT;
+	}
+}
+
+/*!
+ * Clear bit 'prio' (and clear upper levels if word becomes empty)
+ * \param bm Bit mask
+ * \param prio Bit index
+ */
+static inline void prio_bitmap_clear ( prio_bitmap_t *bm, uint prio )
+{
+	int d;
+	uint32 *w;
+
+	for ( d = bm->depth - 1; d >= 0; d-- )
+	{
+		w = &bm->word[d][ prio >> PRIO_BITMAP_SHIFT ];
+		*w &= ~( ( (uint32) 1 ) << ( prio & ( PRIO_BITMAP_WBITS - 1 ) ) );
+
+		if ( *w ) /* other bits still set in this word */
+			break;
+
+		prio >>= PRIO_BITMAP_SHIFT;
+	}
+}
+
+/*!
+ * Find highest set bit
+ * \param bm Bit mask
+ * \return index of highest set bit, -1 if none is set
+ */
+static inline int prio_bitmap_highest ( prio_bitmap_t *bm )
+{
+	uint d, idx;
+
+	if ( !bm->word[0][0] )
+		return -1;
+
+	idx = 0;
+	for ( d = 0; d < bm->depth; d++ )
+		idx = ( idx << PRIO_BITMAP_SHIFT ) + msb_index ( bm->word[d][idx] );
+
+	return idx;
+}
+
+/*! Is bit 'prio' set? */
+static inline int prio_bitmap_is_set ( prio_bitmap_t *bm, uint prio )
+{
+	return ( bm->word[bm->depth - 1][ prio >> PRIO_BITMAP_SHIFT ] >>
+		 ( prio & ( PRIO_BITMAP_WBITS - 1 ) ) ) & 1;
+}
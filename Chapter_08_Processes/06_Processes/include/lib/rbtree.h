@@ -0,0 +1,62 @@
+/*!
+ * Red-black tree (balanced binary search tree) of objects
+ *
+ * properties:
+ * - objects are kept sorted by compare function given at init; objects that
+ *   compare equal are kept in insertion order (FIFO)
+ * - insert and remove (any element) are O(log n), get smallest is O(1)
+ *   (leftmost element is cached)
+ * - objects for tree must have rbtree_h element included (as with list_h in
+ *   list.h); tree does not allocate memory
+ */
+#pragma once
+
+#ifdef MEM_TEST
+#include "test/test.h"
+#endif
+#include <types/basic.h>
+
+/*! Tree element */
+typedef struct _rbtree_h_
+{
+	void		   *object;
+			    /* object (which contains this rbtree_h) */
+
+	struct _rbtree_h_  *parent;
+	struct _rbtree_h_  *left;
+	struct _rbtree_h_  *right;
+			    /* links to other elements (NULL if none) */
+
+	int		    red;
+			    /* element color: red or black */
+}
+rbtree_h;
+
+/*! Tree header */
+typedef struct _rbtree_t_
+{
+	rbtree_h  *root;
+		   /* root element, NULL if tree is empty */
+
+	rbtree_h  *first;
+		   /* leftmost ("smallest") element */
+
+	uint	   size;
+		   /* number of elements in tree */
+
+	int	 (*cmp) ( void *, void * );
+		   /* compare objects: <0 when first should be before second */
+}
+rbtree_t;
+
+void rbtree_init ( rbtree_t *tree, int (*cmp) ( void *, void * ) );
+
+void rbtree_insert ( rbtree_t *tree, void *object, rbtree_h *hdr );
+void *rbtree_remove ( rbtree_t *tree, rbtree_h *hdr );
+void *rbtree_next ( rbtree_h *hdr );
+
+/*! Get "smallest" object in tree (NULL if tree is empty) */
+static inline void *rbtree_get ( rbtree_t *tree )
+{
+	return tree->first ? tree->first->object : NULL;
+}
@@ -0,0 +1,85 @@
+/*! Segregated fit allocator for thread stacks
+ *
+ * Requests are grouped in few size classes (e.g. thread stack, signal handler
+ * stack, argument blocks). Each class has its own list of free blocks, all of
+ * class size: allocation takes first block from list, release puts block at
+ * list start (recently used stack, probably still in cache, is reused first).
+ * Both operations are O(1).
+ * Only when class list is empty new block is taken from underlying first fit
+ * pool (ff_simple). Class blocks are not returned to it on release, so pool
+ * does not fragment with repeated thread creation and termination. When first
+ * fit pool is exhausted, blocks kept in class lists are returned to it and
+ * request is retried. Requests greater than largest class size are forwarded
+ * to first fit pool.
+ */
+
+#pragma once
+
+#ifdef MEM_TEST
+#include "test/test.h"
+#endif
+#include <types/basic.h>
+
+#define SFS_CLASSES	4	/* maximal number of size classes */
+
+#ifndef _SF_STACK_C_
+
+typedef void sfs_mpool_t;
+
+/*! interface */
+void *sfs_init ( void *mem_segm, size_t size, size_t class_size[],
+		 uint classes );
+void *sfs_alloc ( sfs_mpool_t *mpool, size_t size );
+int sfs_free ( sfs_mpool_t *mpool, void *block );
+
+/*! rest is only for sf_stack.c */
+#else /* _SF_STACK_C_ */
+
+#include <lib/ff_simple.h>
+
+/* block header */
+typedef struct _sfs_hdr_t_
+{
+	size_t		     cls;
+			     /* class index (SFS_NO_CLASS if not from class) */
+	struct _sfs_hdr_t_  *next;
+			     /* next free block in class list (when free) */
+}
+sfs_hdr_t;
+
+#define SFS_NO_CLASS	( (size_t) -1 )
+
+/* size class */
+typedef struct _sfs_class_t_
+{
+	size_t	    size;
+		    /* block size (without header) */
+	sfs_hdr_t  *free;
+		    /* free blocks, last released first */
+}
+sfs_class_t;
+
+typedef struct _sfs_mpool_t_
+{
+	ffs_mpool_t  *ffs;
+		      /* first fit pool (memory for blocks) */
+	uint	      classes;
+		      /* number of size classes */
+	sfs_class_t   class[SFS_CLASSES];
+		      /* size classes, sorted by size */
+}
+sfs_mpool_t;
+
+#define ALIGN_VAL	( (size_t) sizeof(size_t) )
+#define ALIGN_FW(P)	\
+	do { (P) = ~( ALIGN_VAL - 1 ) & (((size_t) (P)) + (ALIGN_VAL - 1)); } \
+	while(0)
+
+void *sfs_init ( void *mem_segm, size_t size, size_t class_size[],
+		 uint classes );
+void *sfs_alloc ( sfs_mpool_t *mpool, size_t size );
+int sfs_free ( sfs_mpool_t *mpool, void *block );
+
+static int sfs_release_free ( sfs_mpool_t *mpool );
+
+#endif /* _SF_STACK_C_ */
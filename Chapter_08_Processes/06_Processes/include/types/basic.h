@@ -43,7 +43,10 @@ typedef struct _descriptor_
 	id_t   id;
 	       /* identification number of system resource */
 
-	void  *ptr;
-	       /* pointer to kernel descriptor (in kernel address space */
+	int    index;
+	       /* index in kernel handle table (-1 if not valid) */
+
+	uint   gen;
+	       /* generation of handle table entry (detects stale handles) */
 }
 descriptor_t;
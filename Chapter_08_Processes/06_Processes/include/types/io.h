@@ -53,6 +53,7 @@ console_cmd_t;
 #define DEV_TYPE_SHARED		( 1 << 28 )
 #define DEV_TYPE_NOTSHARED	( 1 << 29 )
 #define DEV_TYPE_CONSOLE	( 1 << 30 )	/* "console mode" = text mode */
+#define DEV_TYPE_BLOCKING	( 1 << 27 )	/* read can block */
 
 /*! limits for name lengths of named system objects (as message queues) */
 #define	PATH_MAX		255
@@ -35,6 +35,13 @@ typedef struct pthread_attr
 
 	void	      *stackaddr;
 	size_t	       stacksize;
+
+	uint	       sigev_threads;
+		       /* SIGEV_THREAD pool size (not in POSIX; 0 - default) */
+
+	int	       timer_slack;
+		       /* default timer slack in us (not in POSIX;
+			* -1 - same as in creating thread) */
 }
 pthread_attr_t;
 
@@ -46,22 +53,84 @@ pthread_attr_t;
 #define	PTHREAD_SCOPE_SYSTEM		(1<<4)
 #define	PTHREAD_SCOPE_PROCESS		(1<<5)
 
-/*! Mutex */
-typedef descriptor_t pthread_mutex_t;
+/*! Mutex (user space part is futex word; kernel object for shared mutex) */
+typedef struct pthread_mutex
+{
+	int	      lock;
+		      /* 0 - unlocked, 1 - locked, 2 - locked, with waiters */
+
+	uint	      flags;
+		      /* flags from pthread_mutexattr_t */
+
+	descriptor_t  kobj;
+		      /* kernel mutex (only with PTHREAD_MUTEX_KOBJECT flags) */
+}
+pthread_mutex_t;
 
 /*! Mutex creation parameters */
-typedef uint pthread_mutexattr_t;
+typedef struct pthread_mutexattr
+{
+	uint	       flags;
+		       /* process shared, protocol */
+	int	       prioceiling;
+		       /* priority ceiling (with PTHREAD_PRIO_PROTECT) */
+}
+pthread_mutexattr_t;
+
+/* flags for pthread_mutexattr_t and pthread_condattr_t */
 #define	PTHREAD_PROCESS_SHARED		(1<<6)
 #define	PTHREAD_PROCESS_PRIVATE		(1<<7)
 
+/* mutex protocols */
+#define	PTHREAD_PRIO_NONE		0
+#define	PTHREAD_PRIO_INHERIT		(1<<8)
+#define	PTHREAD_PRIO_PROTECT		(1<<9)
+#define	PTHREAD_PRIO_MASK	(PTHREAD_PRIO_INHERIT|PTHREAD_PRIO_PROTECT)
+
+/* mutexes implemented with kernel object (others use only futex word) */
+#define	PTHREAD_MUTEX_KOBJECT	(PTHREAD_PROCESS_SHARED|PTHREAD_PRIO_MASK)
+
 /*! Condition variable */
-typedef descriptor_t pthread_cond_t;
+typedef struct pthread_cond
+{
+	int	      seq;
+		      /* futex word: changed on every signal/broadcast */
+
+	int	      waiters;
+		      /* number of threads waiting on condition variable */
+
+	uint	      flags;
+		      /* flags from pthread_condattr_t */
+
+	descriptor_t  kobj;
+		      /* kernel condition variable (only if process shared) */
+}
+pthread_cond_t;
 
 /*! Condition variable creation parameters */
-typedef uint pthread_condattr_t;
+typedef struct pthread_condattr
+{
+	uint	       flags;
+		       /* process shared */
+}
+pthread_condattr_t;
 
 /*! Semaphore */
-typedef descriptor_t sem_t;
+typedef struct sem
+{
+	int	      value;
+		      /* futex word: semaphore value (>= 0) */
+
+	int	      waiters;
+		      /* number of threads blocked on semaphore */
+
+	uint	      flags;
+		      /* PTHREAD_PROCESS_SHARED if pshared was set */
+
+	descriptor_t  kobj;
+		      /* kernel semaphore (only if process shared) */
+}
+sem_t;
 
 /*! Message queue */
 typedef descriptor_t mqd_t;
@@ -8,6 +8,9 @@
 enum {
 	SCHED_RR = 1,
 	SCHED_EDF,
+	SCHED_CBS,
+	SCHED_FAIR,
+	SCHED_RM,
 
 	SCHED_NUM,
 };
@@ -38,10 +41,52 @@ typedef struct _sched_edf_t_
 {
 	timespec_t  deadline;
 	timespec_t  period;
+	timespec_t  wcet;
+		    /* worst case execution time per period, for admission
+		     * control (zero: no reservation, thread is not tested) */
 	int         flags;
 }
 sched_edf_t;
 
+/*!
+ * Constant Bandwidth Server: thread may execute 'budget' in each 'period';
+ * it is scheduled by EDF together with EDF threads, with server deadline
+ * that is postponed by 'period' whenever budget is exhausted
+ */
+typedef struct _sched_cbs_t_
+{
+	timespec_t  budget;
+	timespec_t  period;
+}
+sched_cbs_t;
+
+/*!
+ * Fair scheduler: threads share processor in proportion to their weights,
+ * given with nice value (-20 - largest share, 19 - smallest; 0 is default);
+ * each nice level is about 10% more (or less) processor time
+ */
+#define FAIR_NICE_MIN	-20
+#define FAIR_NICE_MAX	19
+
+typedef struct _sched_fair_t_
+{
+	int  nice;
+}
+sched_fair_t;
+
+/*!
+ * Rate Monotonic: periodic thread with worst case execution time 'wcet' in
+ * each 'period' (deadline is end of period); priority is assigned by
+ * scheduler (shorter period - higher priority) and thread is accepted only
+ * if response time analysis shows all deadlines are met
+ */
+typedef struct _sched_rm_t_
+{
+	timespec_t  period;
+	timespec_t  wcet;
+}
+sched_rm_t;
+
 /*!
  * Supplement scheduling parameters definable by thread
  * (beside policy and priority)
@@ -50,6 +95,9 @@ typedef union _sched_t_
 {
 	sched_rr_t   rr;
 	sched_edf_t  edf;
+	sched_cbs_t  cbs;
+	sched_fair_t fair;
+	sched_rm_t   rm;
 }
 sched_supp_t;
 
@@ -24,11 +24,32 @@ typedef uint clockid_t;
 
 #define CLOCK_REALTIME	1
 #define CLOCK_MONOTONIC	2
+#define CLOCK_PROCESS_CPUTIME_ID	3	/* processor time of process */
+#define CLOCK_THREAD_CPUTIME_ID		4	/* processor time of thread */
+
+#define CLOCK_IS_VALID(C)	\
+	( (C) >= CLOCK_REALTIME && (C) <= CLOCK_THREAD_CPUTIME_ID )
+#define CLOCK_IS_CPUTIME(C)	\
+	( (C) == CLOCK_PROCESS_CPUTIME_ID || (C) == CLOCK_THREAD_CPUTIME_ID )
 
 typedef descriptor_t timer_t;
 
 #define TIMER_ABSTIME	1
 
+/*
+ * Timer slack: timer may expire up to 'slack' later than set, so that more
+ * timers can expire with one timer interrupt. Thread has default slack for
+ * its timers (and sleeps); timer_settime can override it with flags:
+ * TIMER_SLACK(us) (TIMER_SLACK(0) for exact timer).
+ */
+#define TIMER_SLACK_SET		2
+#define TIMER_SLACK_SHIFT	8
+#define TIMER_SLACK(us)	\
+	( TIMER_SLACK_SET | ( (us) << TIMER_SLACK_SHIFT ) )
+#define TIMER_SLACK_GET(flags)	( (uint) (flags) >> TIMER_SLACK_SHIFT )
+#define TIMER_SLACK_MAX		8000000	/* max. slack [us] (fits in flags) */
+#define TIMER_SLACK_DEFAULT	50	/* thread default slack [us] */
+
 #define TIME_IS_SET(T)	( (T)->tv_sec + (T)->tv_nsec != 0 )
 #define TIME_RESET(T)	do { (T)->tv_sec = (T)->tv_nsec = 0; } while (0)
 
@@ -7,11 +7,13 @@
 #include "memory.h"
 #include <arch/interrupt.h>
 #include <arch/processor.h>
+#include <arch/syscall.h>
 #include <lib/string.h>
 
 static list_t devices;
 
 static void k_device_interrupt_handler ( unsigned int inum, void *device );
+static void k_device_wake_readers ( kdevice_t *kdev );
 
 /*! Initialize initial device as console for system boot messages */
 void kdevice_set_initial_stdout ()
@@ -77,6 +79,7 @@ int k_device_init ( kdevice_t *kdev, int flags, void *params, void *callback )
 		kdev->dev.params = params;
 
 	list_init ( &kdev->descriptors );
+	kthreadq_init ( &kdev->readers );
 
 	if ( kdev->dev.init )
 		retval = kdev->dev.init ( flags, params, &kdev->dev );
@@ -203,7 +206,74 @@ static void k_device_interrupt_handler ( unsigned int inum, void *device )
 	if ( kdev->dev.irq_handler )
 		status = kdev->dev.irq_handler ( inum, &kdev->dev );
 
-	if ( status ) {} /* handle return status if required */
+	/* new data received: are there threads waiting for it? */
+	if ( status > 0 && kthreadq_get ( &kdev->readers ) )
+		k_device_wake_readers ( kdev );
+}
+
+/*!
+ * Repeat read for thread blocked on device
+ * (syscall parameters are taken from thread context; they were checked when
+ * thread was blocked)
+ * \return number of bytes read, 0 if there is still no data, -1 on error
+ */
+static int k_device_read_blocked ( kdevice_t *kdev, kthread_t *kthread )
+{
+	descriptor_t *desc;
+	void *buffer, *p;
+	size_t size;
+
+	kobject_t *kobj;
+	kprocess_t *proc;
+
+	p = arch_syscall_get_params ( kthread_get_context ( kthread ) );
+
+	desc =  *( (descriptor_t **) p );	p += sizeof (descriptor_t *);
+	buffer =   *( (char **) p );		p += sizeof (char *);
+	size = *( (size_t *) p );
+
+	proc = kthread_get_process ( kthread );
+	desc = U2K_GET_ADR ( desc, proc );
+	buffer = U2K_GET_ADR ( buffer, proc );
+
+	/* descriptor might be closed (by other thread) in the meantime */
+	kobj = kobject_get ( proc, desc );
+	if ( !kobj || kobj->kobject != kdev )
+		return -1;
+
+	return k_device_recv ( buffer, size, kobj->flags, kdev );
+}
+
+/*! Give new data to threads blocked on device, while there is some */
+static void k_device_wake_readers ( kdevice_t *kdev )
+{
+	kthread_t *kthread;
+	int retval, woken = FALSE;
+
+	while ( ( kthread = kthreadq_get ( &kdev->readers ) ) )
+	{
+		retval = k_device_read_blocked ( kdev, kthread );
+		if ( !retval )
+			break; /* no more data */
+
+		kthreadq_remove ( &kdev->readers, kthread );
+
+		if ( retval > 0 )
+		{
+			kthread_set_errno ( kthread, EXIT_SUCCESS );
+			kthread_set_syscall_retval ( kthread, retval );
+		}
+		else {
+			kthread_set_errno ( kthread, EIO );
+			kthread_set_syscall_retval ( kthread, EXIT_FAILURE );
+		}
+
+		kthread_move_to_ready ( kthread, LAST );
+		woken = TRUE;
+	}
+
+	if ( woken )
+		kthreads_schedule ();
 }
 
 /* /dev/null emulation */
@@ -268,8 +338,7 @@ int sys__open ( void *p )
 	kobj->kobject = kdev;
 	kobj->flags = flags;
 
-	desc->ptr = kobj;
-	desc->id = kdev->id;
+	kobject_set_descriptor ( kobj, kdev->id, desc );
 
 	/* add descriptor to device list */
 	list_append ( &kdev->descriptors, kobj, &kobj->spec );
@@ -293,18 +362,16 @@ int sys__close ( void *p )
 	desc = U2K_GET_ADR ( desc, proc );
 	ASSERT_ERRNO_AND_EXIT ( desc, EINVAL );
 
-	kobj = desc->ptr;
+	kobj = kobject_get ( proc, desc );
 	ASSERT_ERRNO_AND_EXIT ( kobj, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				EINVAL );
 	kdev = kobj->kobject;
 	ASSERT_ERRNO_AND_EXIT ( kdev && kdev->id == desc->id, EINVAL );
 
-	kfree_kobject ( proc, kobj );
-
 	/* remove descriptor from device list */
 	list_remove ( &kdev->descriptors, 0, &kobj->spec );
 
+	kfree_kobject ( proc, kobj );
+
 	k_device_close ( kdev );
 
 	EXIT2 ( EXIT_SUCCESS, EXIT_SUCCESS );
@@ -346,19 +413,32 @@ static int read_write ( void *p, int op )
 	ASSERT_ERRNO_AND_EXIT ( buffer, EINVAL );
 	ASSERT_ERRNO_AND_EXIT ( size > 0, EINVAL );
 
-	kobj = desc->ptr;
+	kobj = kobject_get ( proc, desc );
 	ASSERT_ERRNO_AND_EXIT ( kobj, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				EINVAL );
 	kdev = kobj->kobject;
 	ASSERT_ERRNO_AND_EXIT ( kdev && kdev->id == desc->id, EINVAL );
 
 	/* TODO check permission for requested operation from opening flags */
 
 	if ( op )
+	{
 		retval = k_device_recv ( buffer, size, kobj->flags, kdev );
-	else
+
+		if ( !retval && !( kobj->flags & O_NONBLOCK ) &&
+			( kdev->dev.flags & DEV_TYPE_BLOCKING ) )
+		{
+			/* no data yet: wait for device interrupt;
+			 * return value is set when thread is released */
+			kthread_set_errno ( NULL, EXIT_SUCCESS );
+			kthread_enqueue ( NULL, &kdev->readers );
+			kthreads_schedule ();
+
+			return 0;
+		}
+	}
+	else {
 		retval = k_device_send ( buffer, size, kobj->flags, kdev );
+	}
 
 	if ( retval >= 0 )
 		EXIT2 ( EXIT_SUCCESS, retval );
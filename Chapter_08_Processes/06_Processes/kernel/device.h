@@ -34,6 +34,9 @@ typedef struct _kdevice_t_
 
 	list_t	   descriptors;
 		   /* list of all descriptor referencing this list */
+
+	kthread_q  readers;
+		   /* threads blocked in read, waiting for data */
 }
 kdevice_t;
 
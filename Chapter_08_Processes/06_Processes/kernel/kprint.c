@@ -20,4 +20,10 @@ int kprintf ( char *format, ... )
 	size = vssprintf ( &cmd.cd.print.text[0], CONSOLE_MAXLEN, &format );
 
 	return k_device_send ( &cmd, size, 0, k_stdout );
+}
+
+/*! Formated output to string (at most 'size' bytes, including '\0') */
+int ksprintf ( char *str, size_t size, char *format, ... )
+{
+	return vssprintf ( str, size, &format );
 }
\ No newline at end of file
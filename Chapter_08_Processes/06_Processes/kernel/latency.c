@@ -0,0 +1,212 @@
+/*!
+ * Scheduling latency tracer (compiled with LATENCY_TRACE)
+ *
+ * Measures time from thread wakeup (when it is put into ready queue, not
+ * when preempted thread is returned there) to its activation. Latencies are
+ * collected in histograms per priority and per scheduling policy; for the
+ * longest one, threads involved and interrupts that occurred in between are
+ * saved. Interrupts are only counted (in a small log of interrupt numbers),
+ * so tracer adds just two clock readings per wakeup.
+ */
+#define _K_LATENCY_C_
+
+#include "latency.h"
+
+#include "thread.h"
+#include "kprint.h"
+#include <kernel/errno.h>
+#include <types/bits.h>
+#include <lib/string.h>
+
+#ifdef LATENCY_TRACE
+
+static klatency_hist_t prio_hist[PRIO_LEVELS];
+static klatency_hist_t policy_hist[SCHED_NUM];
+static klatency_worst_t worst;
+
+/*! Interrupt log: numbers of last LAT_IRQ_LOG interrupts */
+static uint irq_log[LAT_IRQ_LOG];
+static uint irq_seq;
+
+static void klatency_add ( klatency_hist_t *hist, uint usec );
+
+/*! Interrupt occurred (called from arch layer) */
+void klatency_interrupt ( unsigned int inum )
+{
+	irq_log[irq_seq & ( LAT_IRQ_LOG - 1 )] = inum;
+	irq_seq++;
+}
+
+/*!
+ * Thread is woken: start measuring its latency (called before secondary
+ * scheduler takes it, and again when that scheduler releases it; only first
+ * call is used)
+ */
+void klatency_wakeup ( kthread_t *kthread )
+{
+	klatency_thread_t *lat = kthread_get_latency_param ( kthread );
+	kthread_t *active = kthread_get_active ();
+
+	if ( lat->waiting || lat->preempted )
+		return;
+
+	kclock_gettime ( CLOCK_MONOTONIC, &lat->ready );
+	lat->waiting = TRUE;
+	lat->irq_seq = irq_seq;
+	lat->running = active ? kthread_get_id ( active ) : 0;
+}
+
+/*! Active thread is preempted (it is not woken when it becomes ready again) */
+void klatency_preempt ( kthread_t *kthread )
+{
+	klatency_thread_t *lat = kthread_get_latency_param ( kthread );
+
+	lat->preempted = TRUE;
+}
+
+/*!
+ * Thread is activated: record its latency (if it was woken)
+ * \param kthread Activated thread
+ * \param prev Previously active thread (NULL if none or it exited)
+ * \param now Current time
+ */
+void klatency_run ( kthread_t *kthread, kthread_t *prev, timespec_t *now )
+{
+	klatency_thread_t *lat = kthread_get_latency_param ( kthread );
+	timespec_t t;
+	uint usec, i, n;
+	int prio, policy;
+
+	lat->preempted = FALSE;
+
+	if ( !lat->waiting )
+		return; /* preempted thread is activated again */
+
+	lat->waiting = FALSE;
+
+	t = *now;
+	if ( time_cmp ( &t, &lat->ready ) <= 0 )
+		TIME_RESET ( &t ); /* clock changed */
+	else
+		time_sub ( &t, &lat->ready );
+
+	if ( t.tv_sec >= 4000 ) /* fit in 32 bits (in microseconds) */
+		usec = (uint) -1;
+	else
+		usec = t.tv_sec * 1000000 + t.tv_nsec / 1000;
+
+	prio = kthread_get_prio ( kthread );
+	policy = kthread_get_sched_policy ( kthread );
+
+	klatency_add ( &prio_hist[prio], usec );
+	klatency_add ( &policy_hist[policy], usec );
+
+	if ( worst.thread && usec <= worst.latency )
+		return;
+
+	/* new worst case */
+	worst.latency = usec;
+	worst.thread = kthread_get_id ( kthread );
+	worst.prio = prio;
+	worst.policy = policy;
+	worst.running = lat->running;
+	worst.prev = prev ? kthread_get_id ( prev ) : 0;
+	worst.when = *now;
+
+	worst.irqs = irq_seq - lat->irq_seq;
+	n = worst.irqs < LAT_IRQ_LOG ? worst.irqs : LAT_IRQ_LOG;
+	for ( i = 0; i < n; i++ )
+		worst.irq[i] = irq_log[(irq_seq - n + i) & ( LAT_IRQ_LOG - 1 )];
+}
+
+/*! Add latency to histogram */
+static void klatency_add ( klatency_hist_t *hist, uint usec )
+{
+	uint i = 0;
+
+	if ( usec )
+		i = msb_index ( usec ) + 1;
+	if ( i >= LAT_BUCKETS )
+		i = LAT_BUCKETS - 1;
+
+	hist->bucket[i]++;
+	hist->count++;
+	if ( usec > hist->max )
+		hist->max = usec;
+}
+
+/*! Print histogram (only not empty buckets) */
+static void klatency_print ( char *name, int num, klatency_hist_t *hist )
+{
+	int i;
+
+	kprintf ( "%s %d: count=%u, max=%u us\n\t", name, num, hist->count,
+		  hist->max );
+
+	for ( i = 0; i < LAT_BUCKETS - 1; i++ )
+		if ( hist->bucket[i] )
+			kprintf ( " <%u:%u", 1 << i, hist->bucket[i] );
+	if ( hist->bucket[i] )
+		kprintf ( " >=%u:%u", 1 << ( i - 1 ), hist->bucket[i] );
+
+	kprintf ( "\n" );
+}
+
+/*!
+ * Print latency histograms and worst case on console ("sysinfo latency")
+ * \param reset Clear collected data after printing
+ */
+int klatency_info ( int reset )
+{
+	uint i;
+
+	kprintf ( "Scheduling latency (wakeup to run) [us]\n" );
+
+	for ( i = 0; i < SCHED_NUM; i++ )
+		if ( policy_hist[i].count )
+			klatency_print ( "policy", i, &policy_hist[i] );
+
+	for ( i = 0; i < PRIO_LEVELS; i++ )
+		if ( prio_hist[i].count )
+			klatency_print ( "prio", i, &prio_hist[i] );
+
+	if ( worst.thread )
+	{
+		kprintf ( "Worst: %u us, thread %d (prio %d, policy %d) at "
+			  "%d.%d s\n", worst.latency, worst.thread, worst.prio,
+			  worst.policy, worst.when.tv_sec,
+			  worst.when.tv_nsec / 100000000 );
+		kprintf ( "\twoken while thread %d was active, activated after "
+			  "thread %d\n", worst.running, worst.prev );
+		kprintf ( "\t%u interrupts in between", worst.irqs );
+		if ( worst.irqs )
+		{
+			kprintf ( ", last:" );
+			for ( i = 0; i < worst.irqs && i < LAT_IRQ_LOG; i++ )
+				kprintf ( " %u", worst.irq[i] );
+		}
+		kprintf ( "\n" );
+	}
+
+	if ( reset )
+	{
+		memset ( prio_hist, 0, sizeof (prio_hist) );
+		memset ( policy_hist, 0, sizeof (policy_hist) );
+		memset ( &worst, 0, sizeof (worst) );
+	}
+
+	return EXIT_SUCCESS;
+}
+
+#else /* !LATENCY_TRACE */
+
+/*! Tracer is not included */
+int klatency_info ( int reset )
+{
+	kprintf ( "Scheduling latency tracer not compiled in (enable "
+		  "LATENCY_TRACE in config.ini)\n" );
+
+	return ENOTSUP;
+}
+
+#endif /* LATENCY_TRACE */
@@ -0,0 +1,82 @@
+/*! Scheduling latency tracer (wakeup to run) */
+#pragma once
+
+#include <kernel/latency.h>
+#include "thread.h"
+
+int klatency_info ( int reset );
+
+#ifdef LATENCY_TRACE
+
+/*! Per thread tracer data */
+typedef struct _klatency_thread_t_
+{
+	timespec_t  ready;
+		    /* when thread was woken (put into ready queue) */
+
+	int	    waiting;
+		    /* woken, but not yet activated ('ready' is valid) */
+
+	int	    preempted;
+		    /* taken from processor while ready: when its scheduler
+		     * releases it again, that is not a wakeup */
+
+	uint	    irq_seq;
+		    /* interrupt counter value at wakeup */
+
+	id_t	    running;
+		    /* thread that was active at wakeup */
+}
+klatency_thread_t;
+
+void klatency_wakeup ( kthread_t *kthread );
+void klatency_preempt ( kthread_t *kthread );
+void klatency_run ( kthread_t *kthread, kthread_t *prev, timespec_t *now );
+
+#endif /* LATENCY_TRACE */
+
+#ifdef _K_LATENCY_C_ /* rest of the file is only for kernel/latency.c */
+
+#define LAT_BUCKETS	24	/* bucket 0: < 1 us, bucket i: [2^(i-1), 2^i)
+				 * us, last one: all longer latencies */
+#define LAT_IRQ_LOG	16	/* last interrupts kept (power of 2) */
+
+/*! Latency histogram */
+typedef struct _klatency_hist_t_
+{
+	uint  count;
+	uint  max;
+	      /* number of measured latencies and longest one [us] */
+
+	uint  bucket[LAT_BUCKETS];
+}
+klatency_hist_t;
+
+/*! Trace of longest measured latency */
+typedef struct _klatency_worst_t_
+{
+	uint	    latency;
+		    /* [us] */
+
+	id_t	    thread;
+	int	    prio;
+	int	    policy;
+		    /* woken thread */
+
+	id_t	    running;
+		    /* thread that was active when thread was woken */
+
+	id_t	    prev;
+		    /* thread that was active before woken one */
+
+	timespec_t  when;
+		    /* when woken thread was activated */
+
+	uint	    irqs;
+	uint	    irq[LAT_IRQ_LOG];
+		    /* number of interrupts between wakeup and activation
+		     * and last of them (up to LAT_IRQ_LOG, last is newest) */
+}
+klatency_worst_t;
+
+#endif /* _K_LATENCY_C_ */
@@ -5,6 +5,8 @@
 
 #include "kprint.h"
 #include "thread.h"
+#include "sched.h"
+#include "time.h"
 #include <kernel/errno.h>
 #include <arch/processor.h>
 #include <arch/interrupt.h>
@@ -18,6 +20,20 @@ MEM_ALLOC_T *k_mpool = NULL;
 /*! Memory segments */
 static mseg_t *mseg = NULL;
 
+/*! All object caches (for statistics) */
+static list_t kmem_caches;
+
+/*! Caches for kernel objects, one for each object size (created on demand) */
+#define KOBJECT_CACHES		8
+static kmem_cache_t *kobject_cache[KOBJECT_CACHES];
+
+/* object size in cache: multiple of pointer size (for free list pointer) */
+#define KMEM_ROUND(size)	\
+	( ( (size) + sizeof (void *) - 1 ) & ~( sizeof (void *) - 1 ) )
+
+/* slot in slab: pointer to slab followed by object */
+#define KMEM_SLOT(cache)	( sizeof (void *) + (cache)->size )
+
 /*! List of programs loaded as modules */
 list_t progs;
 #define PNAME "prog_name="
@@ -43,6 +59,8 @@ void k_memory_init ()
 
 	ASSERT ( k_mpool );
 
+	list_init ( &kmem_caches );
+
 	list_init ( &progs );
 
 	/* look into each segment marked as module, add programs to 'progs' */
@@ -112,16 +130,50 @@ inline void *k_k2u_adr ( void *kadr, kprocess_t *proc )
 	return kadr - (aint) proc->m.start;
 }
 
+/*! Get cache for kernel objects of given size (NULL if there is none) */
+static kmem_cache_t *kobject_cache_get ( size_t size )
+{
+	int i;
+
+	for ( i = 0; i < KOBJECT_CACHES; i++ )
+	{
+		if ( !kobject_cache[i] )
+			kobject_cache[i] =
+				kmem_cache_create ( "kobject_t", size );
+
+		if ( kobject_cache[i]->size == KMEM_ROUND ( size ) )
+			return kobject_cache[i];
+	}
+
+	return NULL; /* too many different sizes, use kmalloc */
+}
+
+/*! Release memory of kernel object (to cache it came from) */
+static void kobject_free ( kobject_t *kobj )
+{
+	if ( kobj->cache )
+		kmem_cache_free ( kobj->cache, kobj );
+	else
+		kfree ( kobj );
+}
+
 /*! Allocate space for kernel object and for process descriptor of that object*/
 void *kmalloc_kobject ( kprocess_t *proc, size_t obj_size )
 {
 	kobject_t *kobj;
+	kmem_cache_t *cache;
 
 	ASSERT ( proc );
 
-	kobj = kmalloc ( sizeof (kobject_t) + obj_size );
+	cache = kobject_cache_get ( sizeof (kobject_t) + obj_size );
+	if ( cache )
+		kobj = kmem_cache_alloc ( cache );
+	else
+		kobj = kmalloc ( sizeof (kobject_t) + obj_size );
 	ASSERT ( kobj );
 
+	kobj->cache = cache;
+
 	kobj->flags = 0;
 	kobj->ptr = NULL;
 
@@ -130,6 +182,9 @@ void *kmalloc_kobject ( kprocess_t *proc, size_t obj_size )
 	else
 		kobj->kobject = NULL;
 
+	kobj->handle = khandle_alloc ( &proc->handles, kobj );
+	kobj->gen = proc->handles.h[kobj->handle].gen;
+
 	list_append ( &proc->kobjects, kobj, &kobj->list );
 
 	return kobj;
@@ -140,13 +195,15 @@ void *kfree_kobject ( kprocess_t *proc, kobject_t *kobj )
 {
 	ASSERT ( proc && kobj );
 
+	khandle_free ( &proc->handles, kobj->handle );
+
 #ifndef DEBUG
 	list_remove ( &proc->kobjects, 0, &kobj->list );
 #else /* DEBUG */
 	ASSERT ( list_find_and_remove ( &proc->kobjects, &kobj->list ) );
 #endif
 
-	kfree ( kobj );
+	kobject_free ( kobj );
 
 	return EXIT_SUCCESS;
 }
@@ -159,11 +216,269 @@ int kfree_process_kobjects ( kprocess_t *proc )
 	kobject_t *kobj;
 
 	while ( ( kobj = list_remove ( &proc->kobjects, 0, NULL ) ) != NULL )
-		kfree ( kobj );
+		kobject_free ( kobj );
+
+	khandles_destroy ( &proc->handles );
 
 	return EXIT_SUCCESS;
 }
 
+/*! Object caches ----------------------------------------------------------- */
+
+/*!
+ * Create cache for objects of given size
+ * \param name Object type name (for statistics)
+ * \param size Object size
+ * \return cache descriptor
+ */
+kmem_cache_t *kmem_cache_create ( char *name, size_t size )
+{
+	kmem_cache_t *cache;
+
+	ASSERT ( name && size > 0 );
+
+	cache = kmalloc ( sizeof (kmem_cache_t) );
+	ASSERT ( cache );
+
+	cache->name = name;
+	cache->size = KMEM_ROUND ( size );
+	cache->per_slab = ( KMEM_SLAB_SIZE - sizeof (kmem_slab_t) ) /
+			  KMEM_SLOT ( cache );
+	if ( cache->per_slab < KMEM_SLAB_MIN_OBJS )
+		cache->per_slab = KMEM_SLAB_MIN_OBJS;
+
+	list_init ( &cache->slabs );
+	cache->spare = NULL;
+	cache->hits = cache->misses = 0;
+	cache->used = cache->total = 0;
+
+	list_append ( &kmem_caches, cache, &cache->list );
+
+	return cache;
+}
+
+/*! Release cache and all its slabs (all objects must be freed before) */
+void kmem_cache_destroy ( kmem_cache_t *cache )
+{
+	ASSERT ( cache && !cache->used );
+
+	/* with all objects free, only spare slab can remain */
+	ASSERT ( !list_get ( &cache->slabs, FIRST ) );
+	if ( cache->spare )
+		kfree ( cache->spare );
+
+	list_remove ( &kmem_caches, 0, &cache->list );
+	kfree ( cache );
+}
+
+/*! Allocate new slab for cache: put all its objects into slab's free list */
+static kmem_slab_t *kmem_slab_create ( kmem_cache_t *cache )
+{
+	kmem_slab_t *slab;
+	uint8 *slot;
+	uint i;
+
+	slab = kmalloc ( sizeof (kmem_slab_t) +
+			 cache->per_slab * KMEM_SLOT ( cache ) );
+	if ( !slab )
+		return NULL;
+
+	slab->free = NULL;
+	slab->used = 0;
+
+	slot = (uint8 *) ( slab + 1 );
+	for ( i = 0; i < cache->per_slab; i++, slot += KMEM_SLOT ( cache ) )
+	{
+		*( (kmem_slab_t **) slot ) = slab;
+		*( (void **) ( slot + sizeof (void *) ) ) = slab->free;
+		slab->free = slot + sizeof (void *);
+	}
+
+	cache->total += cache->per_slab;
+
+	return slab;
+}
+
+/*!
+ * Allocate object from cache
+ * \param cache Cache descriptor
+ * \return object address, NULL if new slab was required and kmalloc failed
+ */
+void *kmem_cache_alloc ( kmem_cache_t *cache )
+{
+	kmem_slab_t *slab;
+	void *obj;
+
+	ASSERT ( cache );
+
+	slab = list_get ( &cache->slabs, FIRST );
+	if ( !slab )
+	{
+		if ( cache->spare )
+		{
+			slab = cache->spare;
+			cache->spare = NULL;
+			cache->hits++;
+		}
+		else {
+			cache->misses++;
+			slab = kmem_slab_create ( cache );
+			if ( !slab )
+				return NULL;
+		}
+		list_append ( &cache->slabs, slab, &slab->list );
+	}
+	else {
+		cache->hits++;
+	}
+
+	obj = slab->free;
+	slab->free = *( (void **) obj );
+	slab->used++;
+	cache->used++;
+
+	/* full slab is not in list (until some of its objects is freed) */
+	if ( !slab->free )
+		list_remove ( &cache->slabs, 0, &slab->list );
+
+	return obj;
+}
+
+/*! Return object to its cache (release slab when it becomes empty) */
+void kmem_cache_free ( kmem_cache_t *cache, void *obj )
+{
+	kmem_slab_t *slab;
+
+	ASSERT ( cache && obj && cache->used > 0 );
+
+	slab = *( (kmem_slab_t **) obj - 1 );
+	ASSERT ( slab->used > 0 );
+
+	if ( !slab->free )
+		list_append ( &cache->slabs, slab, &slab->list );
+
+	*( (void **) obj ) = slab->free;
+	slab->free = obj;
+	slab->used--;
+	cache->used--;
+
+	if ( slab->used )
+		return;
+
+	/* keep one empty slab as spare, release others */
+	list_remove ( &cache->slabs, 0, &slab->list );
+	if ( !cache->spare )
+	{
+		cache->spare = slab;
+	}
+	else {
+		kfree ( slab );
+		cache->total -= cache->per_slab;
+	}
+}
+
+/*! Print usage statistics for all caches */
+void kmem_cache_info ()
+{
+	kmem_cache_t *cache;
+
+	kprintf ( "Object caches\n"
+		  "=============\n"
+		  "size\tused/total\thits\tmisses\tname\n" );
+
+	cache = list_get ( &kmem_caches, FIRST );
+	while ( cache )
+	{
+		kprintf ( "%d\t%d/%d\t\t%d\t%d\t%s\n", cache->size,
+			  cache->used, cache->total, cache->hits,
+			  cache->misses, cache->name );
+
+		cache = list_get_next ( &cache->list );
+	}
+}
+
+#undef KMEM_SLOT
+#undef KMEM_ROUND
+
+/*! Handle table ------------------------------------------------------------ */
+
+/*! Initialize empty handle table (entries are allocated on first use) */
+void khandles_init ( khandles_t *t )
+{
+	ASSERT ( t );
+
+	t->h = NULL;
+	t->size = 0;
+	t->free = -1;
+}
+
+/*! Release memory used by handle table */
+void khandles_destroy ( khandles_t *t )
+{
+	ASSERT ( t );
+
+	if ( t->h )
+		kfree ( t->h );
+
+	khandles_init ( t );
+}
+
+/*!
+ * Add object to handle table
+ * \param t Handle table
+ * \param obj Object
+ * \return index of entry (generation is in t->h[index].gen)
+ */
+int khandle_alloc ( khandles_t *t, void *obj )
+{
+	khandle_t *h;
+	int i, size;
+
+	ASSERT ( t && obj );
+
+	if ( t->free == -1 )
+	{
+		/* table is full - double its size */
+		size = t->size ? t->size * 2 : KHANDLES_INIT_SIZE;
+		h = kmalloc ( size * sizeof (khandle_t) );
+		ASSERT ( h );
+
+		if ( t->h )
+		{
+			memcpy ( h, t->h, t->size * sizeof (khandle_t) );
+			kfree ( t->h );
+		}
+
+		for ( i = t->size; i < size; i++ )
+		{
+			h[i].obj = NULL;
+			h[i].gen = 0;
+			h[i].next = i + 1 < size ? i + 1 : -1;
+		}
+
+		t->free = t->size;
+		t->h = h;
+		t->size = size;
+	}
+
+	i = t->free;
+	t->free = t->h[i].next;
+	t->h[i].obj = obj;
+
+	return i;
+}
+
+/*! Release entry from handle table (invalidates all handles to it) */
+void khandle_free ( khandles_t *t, int index )
+{
+	ASSERT ( t && index >= 0 && index < t->size && t->h[index].obj );
+
+	t->h[index].obj = NULL;
+	t->h[index].gen++;
+	t->h[index].next = t->free;
+	t->free = index;
+}
+
 
 /*! unique system wide id numbers */
 #define	WBITS		( sizeof(word_t) * 8 )
@@ -276,6 +591,9 @@ void k_memory_info ()
 		kprintf ( "%d\t%x\t%x\t%s\n", mseg[i].type, mseg[i].size,
 					      mseg[i].start, mseg[i].name );
 	}
+
+	kprintf ( "\n" );
+	kmem_cache_info ();
 }
 
 /*! Handle memory fault interrupt (and others undefined) */
@@ -301,8 +619,9 @@ int sys__sysinfo ( void *p )
 	char *buffer;
 	size_t buf_size;
 	char **param; /* last param is NULL */
-	char *param1; /* *param0; */
-	char usage[] = "Usage: sysinfo [programs|threads|memory]";
+	char *param1, *param2; /* *param0; */
+	char usage[] = "Usage: sysinfo [programs|threads|memory|sched|"
+		       "timers|latency [reset]]";
 	char look_console[] = "(sysinfo printed on console)";
 
 	buffer = *( (char **) p ); p += sizeof (char *);
@@ -356,6 +675,27 @@ int sys__sysinfo ( void *p )
 			EXIT ( EXIT_SUCCESS );
 			/* TODO: "thread id" */
 		}
+		else if ( strcmp ( "sched", param1 ) == 0 )
+		{
+			EXIT ( ksched_info ( buffer, buf_size ) );
+		}
+		else if ( strcmp ( "timers", param1 ) == 0 )
+		{
+			EXIT ( ktimer_info ( buffer, buf_size ) );
+		}
+		else if ( strcmp ( "latency", param1 ) == 0 )
+		{
+			/* "sysinfo latency reset" clears collected data */
+			param2 = NULL;
+			if ( param[2] )
+				param2 = U2K_GET_ADR ( param[2],
+						kthread_get_process (NULL) );
+			klatency_info ( param2 && !strcmp ( "reset", param2 ) );
+			if ( strlen ( look_console ) > buf_size )
+				EXIT ( ENOMEM );
+			strcpy ( buffer, look_console );
+			EXIT ( EXIT_SUCCESS );
+		}
 		else {
 			if ( strlen ( usage ) > buf_size )
 				EXIT ( ENOMEM );
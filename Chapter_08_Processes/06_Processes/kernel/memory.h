@@ -6,6 +6,7 @@
 /*! Kernel dynamic memory --------------------------------------------------- */
 #include <lib/ff_simple.h>
 #include <lib/gma.h>
+#include <lib/sf_stack.h>
 
 #if MEM_ALLOCATOR_FOR_KERNEL == FIRST_FIT
 
@@ -32,6 +33,7 @@ extern MEM_ALLOC_T *k_mpool; /* defined in *ff_simple.c, *gma.h, ... */
 
 /*! Kernel memory layout ---------------------------------------------------- */
 #include <types/basic.h>
+#include <types/time.h>
 #include <lib/list.h>
 #include <api/prog_info.h>
 #include <arch/memory.h>
@@ -56,13 +58,134 @@ struct _kprog_t_
 	list_h	      list;
 };
 
+/*! Object caches ----------------------------------------------------------- */
+/*
+ * Objects of same type (size) are allocated from cache. Every slab (block for
+ * several objects, allocated with kmalloc) keeps list of its free objects and
+ * every object is preceded by pointer to its slab, so allocation and release
+ * are O(1) operations. Cache keeps list of slabs with free objects. When all
+ * objects in slab are freed, slab is released, except one spare empty slab
+ * which is kept per cache (so that alloc/free of single object on slab
+ * boundary doesn't allocate and release slab every time).
+ */
+#define KMEM_SLAB_SIZE		4096	/* preferred slab size */
+#define KMEM_SLAB_MIN_OBJS	4	/* minimal objects per slab */
+
+/*! Slab header (objects follow it) */
+typedef struct _kmem_slab_t_
+{
+	void	 *free;
+		  /* free objects: first word of free object points to next */
+
+	uint	  used;
+		  /* objects currently allocated from this slab */
+
+	list_h	  list;
+		  /* in list of slabs with free objects */
+}
+kmem_slab_t;
+
+/*! Object cache */
+struct _kmem_cache_t_
+{
+	char	 *name;
+		  /* object type name (for statistics) */
+
+	size_t	  size;
+		  /* object size (rounded up to pointer size) */
+
+	uint	  per_slab;
+		  /* objects in one slab */
+
+	list_t	  slabs;
+		  /* slabs with free objects (in use, partially free) */
+
+	kmem_slab_t *spare;
+		  /* empty slab kept for next allocation (or NULL) */
+
+	uint	  hits;
+		  /* allocations served from existing slabs */
+
+	uint	  misses;
+		  /* allocations that required new slab */
+
+	uint	  used;
+		  /* objects currently allocated */
+
+	uint	  total;
+		  /* objects in all slabs */
+
+	list_h	  list;
+		  /* all caches are in list (for statistics) */
+};
+
+void kmem_cache_info ();
+
+/*! Handle table ------------------------------------------------------------ */
+/*
+ * Objects referenced from user space are given small integer (index in table)
+ * and generation number (incremented when entry is released), so validation
+ * of user descriptor is bounds check and compare, instead of list search.
+ */
+
+/*! Handle table entry */
+typedef struct _khandle_t_
+{
+	void  *obj;
+	       /* referenced object, NULL if entry is free */
+
+	uint   gen;
+	       /* generation: incremented when entry is released */
+
+	int    next;
+	       /* next free entry (when this one is free) */
+}
+khandle_t;
+
+/*! Handle table */
+typedef struct _khandles_t_
+{
+	khandle_t  *h;
+		    /* entries (table grows when full) */
+
+	int	    size;
+		    /* number of entries */
+
+	int	    free;
+		    /* first free entry, -1 if none */
+}
+khandles_t;
+
+#define KHANDLES_INIT_SIZE	16
+
+void khandles_init ( khandles_t *t );
+void khandles_destroy ( khandles_t *t );
+int  khandle_alloc ( khandles_t *t, void *obj );
+void khandle_free ( khandles_t *t, int index );
+
+/*! Get object from table if 'index' and 'gen' are valid, NULL otherwise */
+static inline void *khandle_get ( khandles_t *t, int index, uint gen )
+{
+	if ( (uint) index < (uint) t->size && t->h[index].gen == gen )
+		return t->h[index].obj;
+	else
+		return NULL;
+}
+
+/*! Check if object is (still) in table at given index */
+static inline int khandle_check ( khandles_t *t, int index, void *obj )
+{
+	return (uint) index < (uint) t->size && t->h[index].obj == obj;
+}
+
 /*! Process ----------------------------------------------------------------- */
 
 /*! Process */
 struct _kprocess_t_
 {
 	kprog_t	     *prog;
-	ffs_mpool_t  *stack_pool;
+	sfs_mpool_t  *stack_pool;
+		      /* thread stacks, handler stacks and arguments */
 
 	prog_info_t  *pi;
 		      /* process header (copy of program header) */
@@ -73,6 +196,16 @@ struct _kprocess_t_
 	list_t	      kobjects;
 		      /* kobject_t elements */
 
+	khandles_t    handles;
+		      /* handle table for kobject_t elements */
+
+	void	     *sigev_pool;
+		      /* ksigev_pool_t: SIGEV_THREAD notification threads */
+
+	timespec_t    cputime;
+		      /* processor time used by its threads (while they were
+		       * active, up to their last deactivation) */
+
 	list_h	      list;
 };
 
@@ -86,6 +219,14 @@ struct _kobject_t_
 	void	*ptr;
 		 /* pointer for extra per process info */
 
+	int	 handle;
+		 /* index in process handle table */
+	uint	 gen;
+		 /* generation of handle table entry */
+
+	kmem_cache_t *cache;
+		 /* cache this object is allocated from */
+
 	list_h	 spec;
 		 /* list for object purposes */
 
@@ -105,3 +246,18 @@ void k_memory_fault (); /* memory fault handler */
 void *kmalloc_kobject ( kprocess_t *proc, size_t obj_size );
 void *kfree_kobject ( kprocess_t *proc, kobject_t *kobj );
 int   kfree_process_kobjects ( kprocess_t *proc );
+
+/*! Get kernel object referenced with user descriptor (NULL if not valid) */
+static inline kobject_t *kobject_get ( kprocess_t *proc, descriptor_t *desc )
+{
+	return khandle_get ( &proc->handles, desc->index, desc->gen );
+}
+
+/*! Set user descriptor to reference kernel object */
+static inline void kobject_set_descriptor ( kobject_t *kobj, id_t id,
+					    descriptor_t *desc )
+{
+	desc->id = id;
+	desc->index = kobj->handle;
+	desc->gen = kobj->gen;
+}
@@ -38,6 +38,9 @@ int sys__pthread_create ( void *p )
 	sched_supp_t *sched_supp = NULL;
 	void *stackaddr = NULL;
 	size_t stacksize = 0;
+	int timer_slack = -1;
+	timespec_t *slack;
+	int retval;
 
 	thread = *( (pthread_t **) p );		p += sizeof (pthread_t *);
 	attr = *( (pthread_attr_t **) p );	p += sizeof (pthread_attr_t *);
@@ -55,11 +58,15 @@ int sys__pthread_create ( void *p )
 			sched_supp = &attr->sched_params.supp;
 			stackaddr = attr->stackaddr;
 			stacksize = attr->stacksize;
+			timer_slack = attr->timer_slack;
 
 			ASSERT_ERRNO_AND_EXIT (
 				sched_policy >= 0 && sched_policy < SCHED_NUM,
 				ENOTSUP
 			);
+			ASSERT_ERRNO_AND_EXIT (
+				timer_slack <= TIMER_SLACK_MAX, EINVAL
+			);
 			ASSERT_ERRNO_AND_EXIT (
 				sched_priority >= THREAD_MIN_PRIO &&
 				sched_priority <= THREAD_MAX_PRIO,
@@ -67,6 +74,12 @@ int sys__pthread_create ( void *p )
 			);
 
 			/* if ( flags & SOMETHING ) change attributes ... */
+
+			/* scheduler might not accept new thread */
+			retval = ksched2_admit ( NULL, sched_policy,
+						 sched_supp );
+			if ( retval )
+				EXIT ( retval );
 		}
 	}
 
@@ -78,11 +91,17 @@ int sys__pthread_create ( void *p )
 
 	ASSERT_ERRNO_AND_EXIT ( kthread, ENOMEM );
 
+	if ( timer_slack >= 0 )
+	{
+		slack = kthread_get_timer_slack ( kthread );
+		slack->tv_sec = timer_slack / 1000000;
+		slack->tv_nsec = ( timer_slack % 1000000 ) * 1000;
+	}
+
 	if ( thread )
 	{
 		thread = U2K_GET_ADR ( thread, kthread_get_process(NULL) );
-		thread->ptr = kthread;
-		thread->id = kthread_get_id (kthread);
+		kthread_set_descriptor ( kthread, thread );
 	}
 
 	SET_ERRNO ( EXIT_SUCCESS );
@@ -126,14 +145,14 @@ int sys__pthread_join ( void *p )
 
 	ASSERT_ERRNO_AND_EXIT ( thread, ESRCH );
 	thread = U2K_GET_ADR ( thread, kthread_get_process(NULL) );
-	ASSERT_ERRNO_AND_EXIT ( thread->ptr, ESRCH );
+	ASSERT_ERRNO_AND_EXIT ( thread, ESRCH );
 
 	if ( retval )
 		retval = U2K_GET_ADR ( retval, kthread_get_process(NULL) );
 
-	kthread = thread->ptr;
+	kthread = kthread_get_descriptor ( thread );
 
-	if ( kthread_get_id (kthread) != thread->id )
+	if ( !kthread )
 	{
 		/* at 'kthread' is now something else */
 		ret_value = EXIT_FAILURE;
@@ -172,8 +191,7 @@ int sys__pthread_self ( void *p )
 
 	ASSERT_ERRNO_AND_EXIT ( thread, ESRCH );
 
-	thread->ptr = kthread_get_active ();
-	thread->id = kthread_get_id (NULL);
+	kthread_set_descriptor ( NULL, thread );
 
 	EXIT ( EXIT_SUCCESS );
 }
@@ -192,6 +210,7 @@ int sys__pthread_setschedparam ( void *p )
 	sched_param_t *param;
 
 	kthread_t *kthread;
+	int retval;
 
 	thread = *( (pthread_t **) p );		p += sizeof (pthread_t *);
 	policy = *( (int *) p );		p += sizeof (int);
@@ -199,9 +218,8 @@ int sys__pthread_setschedparam ( void *p )
 
 	thread = U2K_GET_ADR ( thread, kthread_get_process(NULL) );
 
-	kthread = thread->ptr;
-	ASSERT_ERRNO_AND_EXIT ( kthread, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( kthread_get_id (kthread) == thread->id, ESRCH );
+	kthread = kthread_get_descriptor ( thread );
+	ASSERT_ERRNO_AND_EXIT ( kthread, ESRCH );
 	ASSERT_ERRNO_AND_EXIT ( kthread_is_alive (kthread), ESRCH );
 
 	ASSERT_ERRNO_AND_EXIT ( policy >= 0 && policy < SCHED_NUM, EINVAL );
@@ -214,7 +232,12 @@ int sys__pthread_setschedparam ( void *p )
 			param->sched_priority <= THREAD_MAX_PRIO, EINVAL );
 	}
 
-	return kthread_setschedparam ( kthread, policy, param );
+	retval = kthread_setschedparam ( kthread, policy, param );
+
+	/* as other system calls (returns immediately if nothing changed) */
+	kthreads_schedule ();
+
+	return retval;
 }
 
 /*!
@@ -290,8 +313,7 @@ int sys__posix_spawn ( void *p )
 	if ( pid ) /* save thread descriptor */
 	{
 		pid = U2K_GET_ADR ( pid, proc );
-		pid->ptr = kthread;
-		pid->id = kthread_get_id ( kthread );
+		kthread_set_descriptor ( kthread, pid );
 	}
 
 	return EXIT_SUCCESS;
@@ -321,6 +343,109 @@ int sys__get_errno_ptr ( void *p )
 	return errno != NULL;
 }
 
+/*! Futex ------------------------------------------------------------------- */
+
+/*
+ * Threads waiting on futex are in one of FUTEX_HASH queues, selected by futex
+ * (kernel) address; that address is saved in thread as private parameter.
+ * Futex word itself is in process memory and is changed only by user code.
+ */
+#define FUTEX_HASH		32
+#define FUTEX_QUEUE(kadr)	( &futex_q[ ( (uint) (kadr) >> 2 ) % FUTEX_HASH ] )
+
+static kthread_q futex_q[FUTEX_HASH];
+
+/*! Initialize futex queues (priority ordered: highest priority wakes first) */
+void kpthread_init ()
+{
+	int i;
+
+	for ( i = 0; i < FUTEX_HASH; i++ )
+		kthreadq_init_prio ( &futex_q[i] );
+}
+
+/*!
+ * Block calling thread if futex word still contains expected value
+ * \param futex Address of futex word (user level address)
+ * \param val Expected value
+ * \return 0 when woken up, -1 with errno = EAGAIN if *futex != val
+ */
+int sys__futex_wait ( void *p )
+{
+	int *futex;
+	int val;
+
+	kprocess_t *proc;
+
+	futex = *( (int **) p );	p += sizeof (int *);
+	val = *( (int *) p );
+
+	ASSERT_ERRNO_AND_EXIT ( futex, EINVAL );
+
+	proc = kthread_get_process (NULL);
+	futex = U2K_GET_ADR ( futex, proc );
+	ASSERT_ERRNO_AND_EXIT ( futex, EINVAL );
+
+	/* interrupts are disabled: word can't change between check and block */
+	if ( *futex != val )
+		EXIT ( EAGAIN );
+
+	kthread_set_errno ( NULL, EXIT_SUCCESS );
+	kthread_set_private_param ( NULL, futex );
+	kthread_enqueue ( NULL, FUTEX_QUEUE ( futex ) );
+	kthreads_schedule ();
+
+	return EXIT_SUCCESS;
+}
+
+/*!
+ * Wake threads waiting on futex
+ * \param futex Address of futex word (user level address)
+ * \param n Maximal number of threads to wake
+ * \return number of woken threads
+ */
+int sys__futex_wake ( void *p )
+{
+	int *futex;
+	int n;
+
+	kprocess_t *proc;
+	kthread_t *kthread, *next;
+	kthread_q *q;
+	int woken = 0;
+
+	futex = *( (int **) p );	p += sizeof (int *);
+	n = *( (int *) p );
+
+	ASSERT_ERRNO_AND_EXIT ( futex, EINVAL );
+
+	proc = kthread_get_process (NULL);
+	futex = U2K_GET_ADR ( futex, proc );
+	ASSERT_ERRNO_AND_EXIT ( futex, EINVAL );
+
+	q = FUTEX_QUEUE ( futex );
+	kthread = kthreadq_get ( q );
+
+	while ( kthread && woken < n )
+	{
+		next = kthreadq_get_next ( kthread );
+
+		if ( kthread_get_private_param ( kthread ) == futex )
+		{
+			kthreadq_remove ( q, kthread );
+			kthread_move_to_ready ( kthread, LAST );
+			woken++;
+		}
+
+		kthread = next;
+	}
+
+	if ( woken )
+		kthreads_schedule ();
+
+	EXIT2 ( EXIT_SUCCESS, woken );
+}
+
 /*! Mutex ------------------------------------------------------------------- */
 
 /*!
@@ -331,15 +456,17 @@ int sys__get_errno_ptr ( void *p )
  */
 int sys__pthread_mutex_init ( void *p )
 {
-	pthread_mutex_t *mutex;
-	/* pthread_mutexattr_t *mutexattr; not implemented */
+	descriptor_t *mutex;
+	pthread_mutexattr_t *mutexattr;
 
 	kprocess_t *proc;
 	kpthread_mutex_t *kmutex;
 	kobject_t *kobj;
+	uint flags = 0;
+	int prioceiling = 0;
 
-	mutex = *( (pthread_mutex_t **) p ); /* p += sizeof (pthread_mutex_t *);
-	mutexattr = *( (pthread_mutexattr_t *) p ); */
+	mutex = *( (descriptor_t **) p );	p += sizeof (descriptor_t *);
+	mutexattr = *( (pthread_mutexattr_t **) p );
 
 	ASSERT_ERRNO_AND_EXIT ( mutex, EINVAL );
 
@@ -347,18 +474,33 @@ int sys__pthread_mutex_init ( void *p )
 	mutex = U2K_GET_ADR ( mutex, proc );
 	ASSERT_ERRNO_AND_EXIT ( mutex, EINVAL );
 
+	if ( mutexattr )
+	{
+		mutexattr = U2K_GET_ADR ( mutexattr, proc );
+		ASSERT_ERRNO_AND_EXIT ( mutexattr, EINVAL );
+		flags = mutexattr->flags;
+		prioceiling = mutexattr->prioceiling;
+	}
+
+	/* only one protocol; ceiling must be valid priority */
+	ASSERT_ERRNO_AND_EXIT (
+		( flags & PTHREAD_PRIO_MASK ) != PTHREAD_PRIO_MASK, EINVAL );
+	ASSERT_ERRNO_AND_EXIT (
+		prioceiling >= THREAD_MIN_PRIO &&
+		prioceiling <= THREAD_MAX_PRIO, EINVAL );
+
 	kobj = kmalloc_kobject ( proc, sizeof (kpthread_mutex_t) );
 	ASSERT_ERRNO_AND_EXIT ( kobj, ENOMEM );
 	kmutex = kobj->kobject;
 
 	kmutex->id = k_new_id ();
 	kmutex->owner = NULL;
-	kmutex->flags = 0;
+	kmutex->flags = flags & PTHREAD_PRIO_MASK;
+	kmutex->prioceiling = prioceiling;
 	kmutex->ref_cnt = 1;
-	kthreadq_init ( &kmutex->queue );
+	kthreadq_init_prio ( &kmutex->queue );
 
-	mutex->ptr = kobj;
-	mutex->id = kmutex->id;
+	kobject_set_descriptor ( kobj, kmutex->id, mutex );
 
 	EXIT2 ( EXIT_SUCCESS, EXIT_SUCCESS );
 }
@@ -370,23 +512,21 @@ int sys__pthread_mutex_init ( void *p )
  */
 int sys__pthread_mutex_destroy ( void *p )
 {
-	pthread_mutex_t *mutex;
+	descriptor_t *mutex;
 
 	kprocess_t *proc;
 	kpthread_mutex_t *kmutex;
 	kobject_t *kobj;
 
-	mutex = *( (pthread_mutex_t **) p );
+	mutex = *( (descriptor_t **) p );
 	ASSERT_ERRNO_AND_EXIT ( mutex, EINVAL );
 
 	proc = kthread_get_process (NULL);
 	mutex = U2K_GET_ADR ( mutex, proc );
 	ASSERT_ERRNO_AND_EXIT ( mutex, EINVAL );
 
-	kobj = mutex->ptr;
+	kobj = kobject_get ( proc, mutex );
 	ASSERT_ERRNO_AND_EXIT ( kobj, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				EINVAL );
 
 	kmutex = kobj->kobject;
 	ASSERT_ERRNO_AND_EXIT ( kmutex && kmutex->id == mutex->id, EINVAL );
@@ -405,13 +545,14 @@ int sys__pthread_mutex_destroy ( void *p )
 
 	kfree_kobject ( proc, kobj );
 
-	mutex->ptr = NULL;
+	mutex->index = -1;
 	mutex->id = 0;
 
 	EXIT2 ( EXIT_SUCCESS, EXIT_SUCCESS );
 }
 
 static int mutex_lock ( kpthread_mutex_t *kmutex, kthread_t *kthread );
+static void mutex_release ( kpthread_mutex_t *kmutex, kthread_t *kthread );
 
 /*!
  * Lock mutex object
@@ -420,24 +561,22 @@ static int mutex_lock ( kpthread_mutex_t *kmutex, kthread_t *kthread );
  */
 int sys__pthread_mutex_lock ( void *p )
 {
-	pthread_mutex_t *mutex;
+	descriptor_t *mutex;
 
 	kprocess_t *proc;
 	kpthread_mutex_t *kmutex;
 	kobject_t *kobj;
 	int retval = EXIT_SUCCESS;
 
-	mutex = *( (pthread_mutex_t **) p );
+	mutex = *( (descriptor_t **) p );
 	ASSERT_ERRNO_AND_EXIT ( mutex, EINVAL );
 
 	proc = kthread_get_process (NULL);
 	mutex = U2K_GET_ADR ( mutex, proc );
 	ASSERT_ERRNO_AND_EXIT ( mutex, EINVAL );
 
-	kobj = mutex->ptr;
+	kobj = kobject_get ( proc, mutex );
 	ASSERT_ERRNO_AND_EXIT ( kobj, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				EINVAL );
 	kmutex = kobj->kobject;
 	ASSERT_ERRNO_AND_EXIT ( kmutex && kmutex->id == mutex->id, EINVAL );
 
@@ -449,22 +588,175 @@ int sys__pthread_mutex_lock ( void *p )
 	return retval != -1;
 }
 
+/*
+ * Priority protocols (PTHREAD_PRIO_INHERIT, PTHREAD_PRIO_PROTECT)
+ *
+ * Owner of such mutex runs with priority which is highest of: its own (base)
+ * priority, ceilings of owned PTHREAD_PRIO_PROTECT mutexes and priorities of
+ * threads blocked on owned PTHREAD_PRIO_INHERIT mutexes. Inheritance is
+ * transitive: if owner is itself blocked on PTHREAD_PRIO_INHERIT mutex, boost
+ * is passed to that mutex owner, and so on. Priority is changed only with
+ * kthread_set_prio (master scheduler); secondary schedulers are informed with
+ * ksched2_inherit (EDF uses it for deadline inheritance).
+ * When mutex is released, it is given to highest priority blocked thread, and
+ * previous owner priority is recalculated from remaining owned mutexes.
+ */
+
+/*! priority of thread including boosts from owned mutexes */
+int kpthread_mutex_prio ( kthread_t *kthread )
+{
+	kthread_pi_t *pi = kthread_get_pi_param ( kthread );
+	kpthread_mutex_t *kmutex;
+	kthread_t *waiter;
+	int prio = pi->base_prio;
+
+	kmutex = list_get ( &pi->held, FIRST );
+	while ( kmutex )
+	{
+		if ( kmutex->flags & PTHREAD_PRIO_PROTECT )
+		{
+			if ( kmutex->prioceiling > prio )
+				prio = kmutex->prioceiling;
+		}
+		else {
+			/* first thread in queue has highest priority */
+			waiter = kthreadq_get ( &kmutex->queue );
+			if ( waiter && kthread_get_prio ( waiter ) > prio )
+				prio = kthread_get_prio ( waiter );
+		}
+
+		kmutex = list_get_next ( &kmutex->list );
+	}
+
+	return prio;
+}
+
+/*! set thread priority and inherited parameters from its owned mutexes */
+static void mutex_update_prio ( kthread_t *kthread )
+{
+	kthread_pi_t *pi = kthread_get_pi_param ( kthread );
+	kpthread_mutex_t *kmutex;
+	kthread_t *waiter;
+	int prio;
+
+	prio = kpthread_mutex_prio ( kthread );
+	if ( prio != kthread_get_prio ( kthread ) )
+		kthread_set_prio ( kthread, prio );
+
+	ksched2_inherit ( kthread, NULL );
+
+	kmutex = list_get ( &pi->held, FIRST );
+	while ( kmutex )
+	{
+		if ( kmutex->flags & PTHREAD_PRIO_INHERIT )
+		{
+			waiter = kthreadq_get ( &kmutex->queue );
+			while ( waiter )
+			{
+				ksched2_inherit ( kthread, waiter );
+				waiter = kthreadq_get_next ( waiter );
+			}
+		}
+
+		kmutex = list_get_next ( &kmutex->list );
+	}
+}
+
+/*! pass priority of thread blocked on mutex to its owner (and further) */
+static void mutex_inherit ( kpthread_mutex_t *kmutex, kthread_t *donor )
+{
+	kthread_t *owner;
+
+	while ( kmutex && ( kmutex->flags & PTHREAD_PRIO_INHERIT ) &&
+		( owner = kmutex->owner ) != NULL )
+	{
+		if ( kthread_get_prio ( donor ) > kthread_get_prio ( owner ) )
+			kthread_set_prio ( owner, kthread_get_prio ( donor ) );
+
+		ksched2_inherit ( owner, donor );
+
+		/* is owner also blocked? */
+		donor = owner;
+		kmutex = kthread_get_pi_param ( owner )->blocked_on;
+	}
+}
+
+/*!
+ * Thread blocked on mutex left its queue without getting it (it is cancelled
+ * or exits): owners along the chain lose priority inherited from it
+ */
+void kpthread_mutex_waiter_exit ( kthread_t *kthread )
+{
+	kthread_pi_t *pi = kthread_get_pi_param ( kthread );
+	kpthread_mutex_t *kmutex = pi->blocked_on;
+
+	pi->blocked_on = NULL;
+
+	while ( kmutex && ( kmutex->flags & PTHREAD_PRIO_INHERIT ) &&
+		kmutex->owner )
+	{
+		mutex_update_prio ( kmutex->owner );
+		kmutex = kthread_get_pi_param ( kmutex->owner )->blocked_on;
+	}
+}
+
+/*! would blocking thread on mutex close a cycle of owners? */
+static int mutex_deadlock ( kpthread_mutex_t *kmutex, kthread_t *kthread )
+{
+	while ( kmutex && kmutex->owner )
+	{
+		if ( kmutex->owner == kthread )
+			return TRUE;
+
+		kmutex = kthread_get_pi_param ( kmutex->owner )->blocked_on;
+	}
+
+	return FALSE;
+}
+
+/*! thread became mutex owner */
+static void mutex_acquired ( kpthread_mutex_t *kmutex, kthread_t *kthread )
+{
+	kthread_pi_t *pi;
+
+	kmutex->owner = kthread;
+
+	if ( !( kmutex->flags & PTHREAD_PRIO_MASK ) )
+		return;
+
+	pi = kthread_get_pi_param ( kthread );
+	pi->blocked_on = NULL;
+	list_append ( &pi->held, kmutex, &kmutex->list );
+
+	mutex_update_prio ( kthread );
+}
+
 /*! lock mutex; return 0 if locked, 1 if thread blocked, -1 if error */
 static int mutex_lock ( kpthread_mutex_t *kmutex, kthread_t *kthread )
 {
+	/* thread with priority above ceiling can't lock mutex */
+	if ( ( kmutex->flags & PTHREAD_PRIO_PROTECT ) &&
+	     kthread_get_pi_param ( kthread )->base_prio > kmutex->prioceiling )
+	{
+		kthread_set_errno ( kthread, EINVAL );
+		return -1;
+	}
+
 	if ( !kmutex->owner )
 	{
 		/* mutex was not locked, acquire lock on it */
-		kmutex->owner = kthread;
 		kthread_set_errno ( kthread, EXIT_SUCCESS );
+		mutex_acquired ( kmutex, kthread );
 
 		return 0;
 	}
 	else {
 		/* mutex was locked */
 
-		/* recursive locking? */
-		if ( kmutex->owner == kthread )
+		/* recursive locking (directly or over chain of owners)? */
+		if ( kmutex->owner == kthread ||
+		     ( ( kmutex->flags & PTHREAD_PRIO_INHERIT ) &&
+		       mutex_deadlock ( kmutex, kthread ) ) )
 		{
 			kthread_set_errno ( kthread, EDEADLK );
 			return -1;
@@ -473,10 +765,39 @@ static int mutex_lock ( kpthread_mutex_t *kmutex, kthread_t *kthread )
 		kthread_set_errno ( kthread, EXIT_SUCCESS );
 		kthread_enqueue ( kthread, &kmutex->queue );
 
+		if ( kmutex->flags & PTHREAD_PRIO_INHERIT )
+		{
+			kthread_get_pi_param ( kthread )->blocked_on = kmutex;
+			mutex_inherit ( kmutex, kthread );
+		}
+
 		return 1;
 	}
 }
 
+/*! release mutex owned by thread; give it to first (highest priority) one */
+static void mutex_release ( kpthread_mutex_t *kmutex, kthread_t *kthread )
+{
+	kthread_t *next;
+
+	if ( kmutex->flags & PTHREAD_PRIO_MASK )
+		list_remove ( &kthread_get_pi_param ( kthread )->held, 0,
+			      &kmutex->list );
+
+	kmutex->owner = NULL;
+
+	next = kthreadq_remove ( &kmutex->queue, NULL );
+	if ( next )
+	{
+		mutex_acquired ( kmutex, next );
+		kthread_move_to_ready ( next, LAST );
+	}
+
+	/* restore priority (or lower it to one still inherited) */
+	if ( kmutex->flags & PTHREAD_PRIO_MASK )
+		mutex_update_prio ( kthread );
+}
+
 /*!
  * Unlock mutex object
  * \param mutex Mutex descriptor (user level descriptor)
@@ -484,23 +805,21 @@ static int mutex_lock ( kpthread_mutex_t *kmutex, kthread_t *kthread )
  */
 int sys__pthread_mutex_unlock ( void *p )
 {
-	pthread_mutex_t *mutex;
+	descriptor_t *mutex;
 
 	kprocess_t *proc;
 	kpthread_mutex_t *kmutex;
 	kobject_t *kobj;
 
-	mutex = *( (pthread_mutex_t **) p );
+	mutex = *( (descriptor_t **) p );
 	ASSERT_ERRNO_AND_EXIT ( mutex, EINVAL );
 
 	proc = kthread_get_process (NULL);
 	mutex = U2K_GET_ADR ( mutex, proc );
 	ASSERT_ERRNO_AND_EXIT ( mutex, EINVAL );
 
-	kobj = mutex->ptr;
+	kobj = kobject_get ( proc, mutex );
 	ASSERT_ERRNO_AND_EXIT ( kobj, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				EINVAL );
 	kmutex = kobj->kobject;
 	ASSERT_ERRNO_AND_EXIT ( kmutex && kmutex->id == mutex->id, EINVAL );
 
@@ -512,12 +831,8 @@ int sys__pthread_mutex_unlock ( void *p )
 
 	SET_ERRNO ( EXIT_SUCCESS );
 
-	kmutex->owner = kthreadq_get ( &kmutex->queue );
-	if ( kmutex->owner )
-	{
-		kthreadq_release ( &kmutex->queue );
-		kthreads_schedule ();
-	}
+	mutex_release ( kmutex, kthread_get_active () );
+	kthreads_schedule ();
 
 	return EXIT_SUCCESS;
 }
@@ -532,14 +847,14 @@ int sys__pthread_mutex_unlock ( void *p )
  */
 int sys__pthread_cond_init ( void *p )
 {
-	pthread_cond_t *cond;
+	descriptor_t *cond;
 	/* pthread_condattr_t *condattr; not implemented */
 
 	kprocess_t *proc;
 	kpthread_cond_t *kcond;
 	kobject_t *kobj;
 
-	cond = *( (pthread_cond_t **) p ); /* p += sizeof (pthread_cond_t *);
+	cond = *( (descriptor_t **) p ); /* p += sizeof (descriptor_t *);
 	condattr = *( (pthread_condattr_t *) p ); */
 
 	ASSERT_ERRNO_AND_EXIT ( cond, EINVAL );
@@ -555,10 +870,9 @@ int sys__pthread_cond_init ( void *p )
 	kcond->id = k_new_id ();
 	kcond->flags = 0;
 	kcond->ref_cnt = 1;
-	kthreadq_init ( &kcond->queue );
+	kthreadq_init_prio ( &kcond->queue );
 
-	cond->ptr = kobj;
-	cond->id = kcond->id;
+	kobject_set_descriptor ( kobj, kcond->id, cond );
 
 	EXIT2 ( EXIT_SUCCESS, EXIT_SUCCESS );
 }
@@ -570,23 +884,21 @@ int sys__pthread_cond_init ( void *p )
  */
 int sys__pthread_cond_destroy ( void *p )
 {
-	pthread_cond_t *cond;
+	descriptor_t *cond;
 
 	kprocess_t *proc;
 	kpthread_cond_t *kcond;
 	kobject_t *kobj;
 
-	cond = *( (pthread_cond_t **) p );
+	cond = *( (descriptor_t **) p );
 	ASSERT_ERRNO_AND_EXIT ( cond, EINVAL );
 
 	proc = kthread_get_process (NULL);
 	cond = U2K_GET_ADR ( cond, proc );
 	ASSERT_ERRNO_AND_EXIT ( cond, EINVAL );
 
-	kobj = cond->ptr;
+	kobj = kobject_get ( proc, cond );
 	ASSERT_ERRNO_AND_EXIT ( kobj, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				EINVAL );
 	kcond = kobj->kobject;
 	ASSERT_ERRNO_AND_EXIT ( kcond && kcond->id == cond->id, EINVAL );
 
@@ -598,7 +910,7 @@ int sys__pthread_cond_destroy ( void *p )
 
 	kfree_kobject ( proc, kobj );
 
-	cond->ptr = NULL;
+	cond->index = -1;
 	cond->id = 0;
 
 	EXIT2 ( EXIT_SUCCESS, EXIT_SUCCESS );
@@ -612,8 +924,8 @@ int sys__pthread_cond_destroy ( void *p )
  */
 int sys__pthread_cond_wait ( void *p )
 {
-	pthread_cond_t *cond;
-	pthread_mutex_t *mutex;
+	descriptor_t *cond;
+	descriptor_t *mutex;
 
 	kprocess_t *proc;
 	kpthread_cond_t *kcond;
@@ -621,8 +933,8 @@ int sys__pthread_cond_wait ( void *p )
 	kobject_t *kobj_cond, *kobj_mutex;
 	int retval = EXIT_SUCCESS;
 
-	cond = *( (pthread_cond_t **) p ); p += sizeof (pthread_cond_t *);
-	mutex = *( (pthread_mutex_t **) p );
+	cond = *( (descriptor_t **) p ); p += sizeof (descriptor_t *);
+	mutex = *( (descriptor_t **) p );
 	ASSERT_ERRNO_AND_EXIT ( cond && mutex, EINVAL );
 
 	proc = kthread_get_process (NULL);
@@ -630,17 +942,13 @@ int sys__pthread_cond_wait ( void *p )
 	mutex = U2K_GET_ADR ( mutex, proc );
 	ASSERT_ERRNO_AND_EXIT ( cond && mutex, EINVAL );
 
-	kobj_cond = cond->ptr;
+	kobj_cond = kobject_get ( proc, cond );
 	ASSERT_ERRNO_AND_EXIT ( kobj_cond, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj_cond->list ),
-				EINVAL );
 	kcond = kobj_cond->kobject;
 	ASSERT_ERRNO_AND_EXIT ( kcond && kcond->id == cond->id, EINVAL );
 
-	kobj_mutex = mutex->ptr;
+	kobj_mutex = kobject_get ( proc, mutex );
 	ASSERT_ERRNO_AND_EXIT ( kobj_mutex, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj_mutex->list),
-				EINVAL );
 	kmutex = kobj_mutex->kobject;
 	ASSERT_ERRNO_AND_EXIT ( kmutex && kmutex->id == mutex->id, EINVAL );
 
@@ -655,9 +963,7 @@ int sys__pthread_cond_wait ( void *p )
 	kthread_set_private_param ( NULL, kobj_mutex );
 
 	/* release mutex */
-	kmutex->owner = kthreadq_get ( &kmutex->queue );
-	if ( kmutex->owner )
-		kthreadq_release ( &kmutex->queue );
+	mutex_release ( kmutex, kthread_get_active () );
 
 	kthreads_schedule ();
 
@@ -688,26 +994,23 @@ int sys__pthread_cond_broadcast ( void *p )
 
 static int cond_release ( void *p, int release_all )
 {
-	pthread_cond_t *cond;
+	descriptor_t *cond;
 
 	kprocess_t *proc;
 	kpthread_cond_t *kcond;
 	kpthread_mutex_t *kmutex;
 	kobject_t *kobj_cond, *kobj_mutex;
 	kthread_t *kthread;
-	int retval = 0;
 
-	cond = *( (pthread_cond_t **) p );
+	cond = *( (descriptor_t **) p );
 	ASSERT_ERRNO_AND_EXIT ( cond, EINVAL );
 
 	proc = kthread_get_process (NULL);
 	cond = U2K_GET_ADR ( cond, proc );
 	ASSERT_ERRNO_AND_EXIT ( cond, EINVAL );
 
-	kobj_cond = cond->ptr;
+	kobj_cond = kobject_get ( proc, cond );
 	ASSERT_ERRNO_AND_EXIT ( kobj_cond, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj_cond->list ),
-				EINVAL );
 	kcond = kobj_cond->kobject;
 	ASSERT_ERRNO_AND_EXIT ( kcond && kcond->id == cond->id, EINVAL );
 
@@ -718,25 +1021,25 @@ static int cond_release ( void *p, int release_all )
 		kobj_mutex = kthread_get_private_param ( kthread );
 		kmutex = kobj_mutex->kobject;
 
-		retval = mutex_lock ( kmutex, kthread );
-		if ( retval == 0 )
+		/* block on mutex; if it can't be locked (ceiling, deadlock)
+		 * release thread with errno set by mutex_lock */
+		if ( mutex_lock ( kmutex, kthread ) != 1 )
 			kthread_move_to_ready ( kthread, LAST );
 
 		/* process other threads in queue */
 		while ( release_all &&
 			(kthread = kthreadq_remove ( &kcond->queue, NULL )) )
 		{
-			kthread_set_errno ( kthread, EXIT_SUCCESS );
-
 			kobj_mutex = kthread_get_private_param ( kthread );
 			kmutex = kobj_mutex->kobject;
 
-			kthread_enqueue ( kthread, &kmutex->queue );
+			/* block on mutex (with inheritance, if used) */
+			if ( mutex_lock ( kmutex, kthread ) != 1 )
+				kthread_move_to_ready ( kthread, LAST );
 		}
 	}
 
-	if ( retval > -1 )
-		kthreads_schedule ();
+	kthreads_schedule ();
 
 	return EXIT_SUCCESS;
 }
@@ -753,7 +1056,7 @@ static int cond_release ( void *p, int release_all )
  */
 int sys__sem_init ( void *p )
 {
-	sem_t *sem;
+	descriptor_t *sem;
 	int pshared;
 	int value;
 
@@ -761,7 +1064,7 @@ int sys__sem_init ( void *p )
 	ksem_t *ksem;
 	kobject_t *kobj;
 
-	sem =		*( (sem_t **) p );	p += sizeof (sem_t *);
+	sem =		*( (descriptor_t **) p );	p += sizeof (descriptor_t *);
 	pshared =	*( (int *) p );		p += sizeof (int);
 	value =		*( (uint *) p );
 
@@ -780,13 +1083,12 @@ int sys__sem_init ( void *p )
 	ksem->last_lock = NULL;
 	ksem->flags = 0;
 	ksem->ref_cnt = 1;
-	kthreadq_init ( &ksem->queue );
+	kthreadq_init_prio ( &ksem->queue );
 
 	if ( pshared )
 		ksem->flags |= PTHREAD_PROCESS_SHARED;
 
-	sem->ptr = kobj;
-	sem->id = ksem->id;
+	kobject_set_descriptor ( kobj, ksem->id, sem );
 
 	EXIT2 ( EXIT_SUCCESS, EXIT_SUCCESS );
 }
@@ -798,13 +1100,13 @@ int sys__sem_init ( void *p )
  */
 int sys__sem_destroy ( void *p )
 {
-	sem_t *sem;
+	descriptor_t *sem;
 
 	kprocess_t *proc;
 	ksem_t *ksem;
 	kobject_t *kobj;
 
-	sem = *( (sem_t **) p );
+	sem = *( (descriptor_t **) p );
 
 	ASSERT_ERRNO_AND_EXIT ( sem, EINVAL );
 
@@ -812,10 +1114,8 @@ int sys__sem_destroy ( void *p )
 	sem = U2K_GET_ADR ( sem, proc );
 	ASSERT_ERRNO_AND_EXIT ( sem, EINVAL );
 
-	kobj = sem->ptr;
+	kobj = kobject_get ( proc, sem );
 	ASSERT_ERRNO_AND_EXIT ( kobj, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				EINVAL );
 	ksem = kobj->kobject;
 	ASSERT_ERRNO_AND_EXIT ( ksem && ksem->id == sem->id, EINVAL );
 
@@ -829,7 +1129,7 @@ int sys__sem_destroy ( void *p )
 
 	kfree_kobject ( proc, kobj );
 
-	sem->ptr = NULL;
+	sem->index = -1;
 	sem->id = 0;
 
 	EXIT2 ( EXIT_SUCCESS, EXIT_SUCCESS );
@@ -842,14 +1142,14 @@ int sys__sem_destroy ( void *p )
  */
 int sys__sem_wait ( void *p )
 {
-	sem_t *sem;
+	descriptor_t *sem;
 
 	kprocess_t *proc;
 	ksem_t *ksem;
 	kobject_t *kobj;
 	kthread_t *kthread;
 
-	sem = *( (sem_t **) p );
+	sem = *( (descriptor_t **) p );
 	ASSERT_ERRNO_AND_EXIT ( sem, EINVAL );
 
 	proc = kthread_get_process (NULL);
@@ -857,10 +1157,8 @@ int sys__sem_wait ( void *p )
 	sem = U2K_GET_ADR ( sem, proc );
 	ASSERT_ERRNO_AND_EXIT ( sem, EINVAL );
 
-	kobj = sem->ptr;
+	kobj = kobject_get ( proc, sem );
 	ASSERT_ERRNO_AND_EXIT ( kobj, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				EINVAL );
 	ksem = kobj->kobject;
 	ASSERT_ERRNO_AND_EXIT ( ksem && ksem->id == sem->id, EINVAL );
 
@@ -886,14 +1184,14 @@ int sys__sem_wait ( void *p )
  */
 int sys__sem_post ( void *p )
 {
-	sem_t *sem;
+	descriptor_t *sem;
 
 	kprocess_t *proc;
 	ksem_t *ksem;
 	kobject_t *kobj;
 	kthread_t *kthread, *released;
 
-	sem = *( (sem_t **) p );
+	sem = *( (descriptor_t **) p );
 
 	ASSERT_ERRNO_AND_EXIT ( sem, EINVAL );
 
@@ -902,10 +1200,8 @@ int sys__sem_post ( void *p )
 	sem = U2K_GET_ADR ( sem, proc );
 	ASSERT_ERRNO_AND_EXIT ( sem, EINVAL );
 
-	kobj = sem->ptr;
+	kobj = kobject_get ( proc, sem );
 	ASSERT_ERRNO_AND_EXIT ( kobj, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				EINVAL );
 	ksem = kobj->kobject;
 	ASSERT_ERRNO_AND_EXIT ( ksem && ksem->id == sem->id, EINVAL );
 
@@ -977,7 +1273,7 @@ int sys__mq_open ( void *p )
 	if (	( kq_queue && ( (oflag & O_CREAT) || (oflag & O_EXCL) ) )
 		|| ( !kq_queue && !(oflag & O_CREAT ) ) )
 	{
-		mqdes->ptr = (void *) -1;
+		mqdes->index = -1;
 		mqdes->id = -1;
 		EXIT2 ( EEXIST, EXIT_FAILURE );
 	}
@@ -992,6 +1288,11 @@ int sys__mq_open ( void *p )
 			ASSERT_ERRNO_AND_EXIT ( attr, EINVAL );
 
 			kq_queue->attr = *attr;
+			kq_queue->msg_cache = kmem_cache_create ( "kmq_msg_t",
+				sizeof (kmq_msg_t) + attr->mq_msgsize );
+		}
+		else {
+			kq_queue->msg_cache = NULL;
 		}
 
 		kq_queue->id = k_new_id ();
@@ -1003,8 +1304,8 @@ int sys__mq_open ( void *p )
 		kq_queue->ref_cnt = 0;
 
 		list_init ( &kq_queue->msg_list );
-		kthreadq_init ( &kq_queue->recv_q );
-		kthreadq_init ( &kq_queue->send_q );
+		kthreadq_init_prio ( &kq_queue->recv_q );
+		kthreadq_init_prio ( &kq_queue->send_q );
 
 		list_append ( &kmq_queue, kq_queue, &kq_queue->list );
 	}
@@ -1015,12 +1316,20 @@ int sys__mq_open ( void *p )
 	kobj->kobject = kq_queue;
 	kobj->flags = oflag;
 
-	mqdes->ptr = kobj;
-	mqdes->id = kq_queue->id;
+	kobject_set_descriptor ( kobj, kq_queue->id, mqdes );
 
 	EXIT2 ( EXIT_SUCCESS, EXIT_SUCCESS );
 }
 
+/*! Release message memory (to queue's cache, if it has one) */
+static void kmq_msg_free ( kmq_queue_t *kq_queue, kmq_msg_t *kmq_msg )
+{
+	if ( kq_queue->msg_cache )
+		kmem_cache_free ( kq_queue->msg_cache, kmq_msg );
+	else
+		kfree ( kmq_msg );
+}
+
 /*!
  * Close a message queue
  * \param mqdes Queue descriptor address (user level descriptor)
@@ -1044,14 +1353,10 @@ int sys__mq_close ( void *p )
 	mqdes = U2K_GET_ADR ( mqdes, proc );
 	ASSERT_ERRNO_AND_EXIT ( mqdes, EBADF );
 
-	kobj = mqdes->ptr;
+	kobj = kobject_get ( proc, mqdes );
 	ASSERT_ERRNO_AND_EXIT ( kobj, EBADF );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				EBADF );
 
 	kq_queue = kobj->kobject;
-	kq_queue = list_find_and_remove ( &kmq_queue, &kq_queue->list );
-
 	if ( !kq_queue || kq_queue->id != mqdes->id )
 		EXIT2 ( EBADF, EXIT_FAILURE );
 
@@ -1061,7 +1366,7 @@ int sys__mq_close ( void *p )
 	{
 		/* remove messages */
 		while( (kmq_msg = list_remove(&kq_queue->msg_list,FIRST,NULL)) )
-			kfree (kmq_msg);
+			kmq_msg_free ( kq_queue, kmq_msg );
 
 		/* remove blocked threads */
 		while ( (kthread = kthreadq_remove (&kq_queue->send_q, NULL)) )
@@ -1079,6 +1384,8 @@ int sys__mq_close ( void *p )
 
 		list_remove ( &kmq_queue, 0, &kq_queue->list );
 		k_free_id ( kq_queue->id );
+		if ( kq_queue->msg_cache )
+			kmem_cache_destroy ( kq_queue->msg_cache );
 		kfree ( kq_queue->name );
 		kfree ( kq_queue );
 	}
@@ -1153,15 +1460,11 @@ static int kmq_send ( void *p, kthread_t *sender )
 	msg_ptr = U2K_GET_ADR ( msg_ptr, proc );
 	ASSERT_ERRNO_AND_EXIT ( mqdes && msg_ptr, EINVAL );
 
-	kobj = mqdes->ptr;
+	kobj = kobject_get ( proc, mqdes );
 	ASSERT_ERRNO_AND_EXIT ( kobj, EBADF );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				EBADF );
 
 	kq_queue = kobj->kobject;
-	ASSERT_ERRNO_AND_EXIT ( kq_queue->id == mqdes->id, EBADF );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &kmq_queue, &kq_queue->list ),
-				EBADF );
+	ASSERT_ERRNO_AND_EXIT ( kq_queue && kq_queue->id == mqdes->id, EBADF );
 
 	if ( kq_queue->attr.mq_curmsgs >= kq_queue->attr.mq_maxmsg )
 	{
@@ -1178,7 +1481,10 @@ static int kmq_send ( void *p, kthread_t *sender )
 	if ( msg_len > kq_queue->attr.mq_msgsize )
 		return EMSGSIZE;
 
-	kmq_msg = kmalloc ( sizeof (kmq_msg_t) + msg_len );
+	if ( kq_queue->msg_cache )
+		kmq_msg = kmem_cache_alloc ( kq_queue->msg_cache );
+	else
+		kmq_msg = kmalloc ( sizeof (kmq_msg_t) + msg_len );
 	ASSERT_ERRNO_AND_EXIT ( kmq_msg, ENOMEM );
 
 	/* create message */
@@ -1278,14 +1584,11 @@ static int kmq_receive ( void *p, kthread_t *receiver )
 	msg_ptr = U2K_GET_ADR ( msg_ptr, proc );
 	ASSERT_ERRNO_AND_EXIT ( mqdes && msg_ptr, -EINVAL );
 
-	kobj = mqdes->ptr;
+	kobj = kobject_get ( proc, mqdes );
 	ASSERT_ERRNO_AND_EXIT ( kobj, -EBADF );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				-EBADF );
 
 	kq_queue = kobj->kobject;
-	ASSERT_ERRNO_AND_EXIT ( kq_queue->id == mqdes->id, -EBADF );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &kmq_queue, &kq_queue->list ),
+	ASSERT_ERRNO_AND_EXIT ( kq_queue && kq_queue->id == mqdes->id,
 				-EBADF );
 
 	if ( kq_queue->attr.mq_curmsgs == 0 )
@@ -1314,7 +1617,7 @@ static int kmq_receive ( void *p, kthread_t *receiver )
 			*msg_prio = kmq_msg->msg_prio;
 	}
 
-	kfree (kmq_msg);
+	kmq_msg_free ( kq_queue, kmq_msg );
 
 	kq_queue->attr.mq_curmsgs--;
 
@@ -4,6 +4,13 @@
 #include <kernel/thread.h>
 #include <lib/list.h>
 
+void kpthread_init ();
+
+/*! thread priority with boosts from owned mutexes (PI and PP protocols) */
+int kpthread_mutex_prio ( kthread_t *kthread );
+
+/*! thread blocked on mutex is removed from its queue (cancel or exit) */
+void kpthread_mutex_waiter_exit ( kthread_t *kthread );
 
 #ifdef	_K_PTHREAD_C_
 
@@ -25,6 +32,12 @@ typedef struct _kpthread_mutex_t_
 
 	kthread_q   queue;
 		    /* queue for blocked threads */
+
+	int	    prioceiling;
+		    /* priority ceiling (for PTHREAD_PRIO_PROTECT) */
+
+	list_h	    list;
+		    /* in owner's list of held mutexes (kthread_pi_t) */
 }
 kpthread_mutex_t;
 
@@ -103,6 +116,9 @@ typedef struct _kmq_queue_t_
 	list_t	   msg_list;
 		   /* list for messages */
 
+	kmem_cache_t *msg_cache;
+		   /* messages of mq_msgsize bytes (NULL: use kmalloc) */
+
 	int	   ref_cnt;
 		   /* number of processes that have opened this queue */
 
@@ -10,6 +10,7 @@
 #include <arch/context.h>
 #include <types/bits.h>
 #include <lib/list.h>
+#include <lib/string.h>
 
 static void ksched2_init ();
 
@@ -24,19 +25,22 @@ static sched_ready_t ready;
 void ksched_init ()
 {
 	int i;
+	void *mask;
 
 	ready.prio_levels = PRIO_LEVELS;
 	ready.rq = kmalloc ( ready.prio_levels * sizeof(kthread_q) );
 
-	ready.mask_len = (ready.prio_levels + sizeof(uint) - 1) / sizeof(uint);
-	ready.mask = kmalloc ( ready.mask_len * sizeof(uint) );
+	mask = kmalloc ( prio_bitmap_size ( ready.prio_levels ) );
+	prio_bitmap_init ( &ready.mask, ready.prio_levels, mask );
 
 	/* queue for ready threads is empty */
 	for ( i = 0; i < ready.prio_levels; i++ )
 		kthreadq_init ( &ready.rq[i] );
 
-	for ( i = 0; i < ready.mask_len; i++ )
-		ready.mask[i] = 0;
+	ready.need_resched = TRUE;
+	ready.need_signal_check = TRUE;
+	ready.selected = NULL;
+	ready.calls = ready.full = ready.switches = 0;
 
 	ksched2_init ();
 }
@@ -47,10 +51,22 @@ void ksched_init ()
  */
 void kthread_move_to_ready ( kthread_t *kthread, int where )
 {
-	int i, j, prio;
+	int prio;
 
 	ASSERT ( kthread );
 
+#ifdef LATENCY_TRACE
+	/* woken thread (not preempted one): measure its latency from now,
+	 * also when its scheduler holds it back */
+	if ( !kthread_is_ready ( kthread ) && kthread_is_alive ( kthread ) )
+		klatency_wakeup ( kthread );
+#endif
+
+	/* woken thread might be held back by its scheduler */
+	if ( !kthread_is_ready ( kthread ) && kthread_is_alive ( kthread ) &&
+	     ksched2_thread_wakeup ( kthread ) )
+		return;
+
 	prio = kthread_get_prio ( kthread );
 
 	kthread_mark_ready ( kthread );
@@ -62,15 +78,16 @@ void kthread_move_to_ready ( kthread_t *kthread, int where )
 		kthreadq_prepend ( &ready.rq[prio], kthread );
 
 	/* mark that list as not empty */
-	i = prio / sizeof (uint);
-	j = prio % sizeof (uint);
-	ready.mask[i] |= (uint) ( 1 << j );
+	prio_bitmap_set ( &ready.mask, prio );
+
+	/* it might preempt active thread */
+	ready.need_resched = TRUE;
 }
 
 /*! Remove given thread (its descriptor) from ready threads */
 kthread_t *kthread_remove_from_ready ( kthread_t *kthread )
 {
-	int i, j, prio;
+	int prio;
 
 	if ( !kthread )
 		return NULL;
@@ -82,43 +99,69 @@ kthread_t *kthread_remove_from_ready ( kthread_t *kthread )
 
 	/* no more ready threads in list? */
 	if ( kthreadq_get ( &ready.rq[prio] ) == NULL )
-	{
-		i = prio / sizeof (uint);
-		j = prio % sizeof (uint);
-
-		ready.mask[i] &= ~( (uint) ( 1 << j ) );
-	}
+		prio_bitmap_clear ( &ready.mask, prio );
 
 	return kthread;
 }
 
-/*! Find and return priority of highest priority thread in ready list */
+/*! Find and return highest priority thread in ready list */
 static kthread_t *get_first_ready ()
 {
-	int i, first;
+	int first;
 
-	for ( i = ready.mask_len - 1; i >= 0; i-- )
-	{
-		if ( ready.mask[i] )
-		{
-			first = i * sizeof(uint) + msb_index (ready.mask[i]);
-			return kthreadq_get ( &ready.rq[first] );
-		}
-	}
+	first = prio_bitmap_highest ( &ready.mask );
+	if ( first < 0 )
+		return NULL;
 
-	return NULL;
+	return kthreadq_get ( &ready.rq[first] );
+}
+
+/*! Request full scheduling on next kthreads_schedule call */
+void kthreads_need_resched ()
+{
+	ready.need_resched = TRUE;
+}
+
+/*! Request processing of pending signals on next kthreads_schedule call */
+void kthreads_need_signal_check ()
+{
+	ready.need_signal_check = TRUE;
 }
 
 /*!
  * Select ready thread with highest priority  as active
  * - if different from current, move current into ready queue (id not NULL) and
  *   move selected thread from ready queue to active queue
+ * - if nothing changed since last call (no thread became ready, active thread
+ *   is still active and its context is unchanged, no new signals) return
+ *   immediately: most system calls end here
  */
 void kthreads_schedule ()
 {
 	kthread_t *curr, *next = NULL;
+	timespec_t now;
+	int switched = FALSE;
+
+	ready.calls++;
 
 	curr = kthread_get_active();
+
+	if ( !ready.need_resched && curr && curr == ready.selected &&
+	     kthread_is_active ( curr ) )
+	{
+		if ( ready.need_signal_check )
+		{
+			ready.need_signal_check = FALSE;
+			ksignal_process_pending ( curr );
+		}
+
+		/* signal handler changes context: it must be selected again */
+		if ( !ready.need_resched )
+			return;
+	}
+
+	ready.full++;
+
 	next = get_first_ready ();
 
 	/* must exist an thread to return to, 'curr' or first from 'ready' */
@@ -127,8 +170,16 @@ void kthreads_schedule ()
 	if ( !curr || !kthread_is_active ( curr ) ||
 		kthread_get_prio ( curr ) < kthread_get_prio ( next ) )
 	{
+		kclock_gettime ( CLOCK_MONOTONIC, &now );
+
 		if ( curr )	/* deactivate curr */
 		{
+			kthread_cpu_stop ( curr, &now );
+#ifdef LATENCY_TRACE
+			if ( kthread_is_active ( curr ) )
+				klatency_preempt ( curr );
+#endif
+
 			ksched2_deactivate_thread ( curr );
 
 			/* move last active to ready queue, if still ready */
@@ -147,13 +198,30 @@ void kthreads_schedule ()
 		kthread_set_active ( next );
 
 		ksched2_activate_thread ( next );
+
+		kthread_cpu_start ( next, &now );
+#ifdef LATENCY_TRACE
+		klatency_run ( next, curr, &now );
+#endif
+
+		ready.switches++;
+		switched = TRUE;
 	}
 
+	/* flags might be set again above (e.g. curr moved to ready queue) */
+	ready.need_resched = FALSE;
+	ready.need_signal_check = FALSE;
+	ready.selected = kthread_get_active();
+
 	/* process pending signals (if any) */
 	ksignal_process_pending ( kthread_get_active() );
 
 	/* select 'active_thread' context */
 	arch_select_thread ( kthread_get_context (NULL) );
+
+	/* other processor time clocks are running now */
+	if ( switched )
+		ktimer_cpu_schedule ();
 }
 
 /*! ------------------------------------------------------------------------- */
@@ -162,12 +230,18 @@ void kthreads_schedule ()
 
 extern ksched_t ksched_rr;
 extern ksched_t ksched_edf;
+extern ksched_t ksched_cbs;
+extern ksched_t ksched_fair;
+extern ksched_t ksched_rm;
 
 /*! Statically defined schedulers (could be easily extended to dynamically) */
 static ksched_t *ksched[] = {
 	NULL,		/* SCHED_FIFO */
 	&ksched_rr,	/* SCHED_RR */
-	&ksched_edf	/* SCHED_EDF */
+	&ksched_edf,	/* SCHED_EDF */
+	&ksched_cbs,	/* SCHED_CBS */
+	&ksched_fair,	/* SCHED_FAIR */
+	&ksched_rm	/* SCHED_RM */
 };
 
 /*! Initialize all (known) schedulers (called from 'kthreads_init') */
@@ -188,6 +262,24 @@ ksched_t *ksched2_get ( int sched_policy )
 	return ksched[sched_policy];
 }
 
+/*!
+ * Check if scheduling policy accepts thread with given parameters
+ * \param kthread Thread (NULL if thread is not yet created)
+ * \param sched_param Parameters (NULL - scheduler defaults)
+ * \return 0 if accepted, error number otherwise
+ */
+int ksched2_admit ( kthread_t *kthread, int sched_policy,
+		    sched_supp_t *sched_param )
+{
+	ASSERT ( sched_policy >= 0 && sched_policy < SCHED_NUM );
+
+	if ( ksched[sched_policy] && ksched[sched_policy]->thread_admit )
+		return ksched[sched_policy]->thread_admit (
+		ksched[sched_policy], kthread, sched_param );
+
+	return 0;
+}
+
 /*! Add thread to scheduling policy (if required by policy) */
 int ksched2_thread_add ( kthread_t *kthread, int sched_policy,
 			 int sched_priority, sched_supp_t *sched_param )
@@ -255,6 +347,20 @@ int ksched2_deactivate_thread ( kthread_t *kthread )
 	return activated;
 }
 
+/*!
+ * Blocked thread is woken up (is to be moved to ready queue)
+ * \return TRUE if its scheduler took it (do not put it in ready queue)
+ */
+int ksched2_thread_wakeup ( kthread_t *kthread )
+{
+	int sched = kthread_get_sched_policy ( kthread );
+
+	if ( ksched[sched] && ksched[sched]->thread_wakeup )
+		return ksched[sched]->thread_wakeup ( ksched[sched], kthread );
+
+	return FALSE;
+}
+
 /*! Change (set) scheduling parameters (extra parameters) */
 int ksched2_setsched_param ( kthread_t *kthread, sched_supp_t *sched_param )
 {
@@ -267,6 +373,53 @@ int ksched2_setsched_param ( kthread_t *kthread, sched_supp_t *sched_param )
 	return 0;
 }
 
+/*!
+ * Thread inherits scheduling parameters from thread blocked on mutex it owns
+ * (master scheduler priority is changed by caller, with kthread_set_prio)
+ * \param kthread Mutex owner
+ * \param donor Thread blocked on mutex (NULL - drop inherited parameters)
+ */
+int ksched2_inherit ( kthread_t *kthread, kthread_t *donor )
+{
+	int sched = kthread_get_sched_policy ( kthread );
+
+	if ( ksched[sched] && ksched[sched]->thread_inherit )
+		ksched[sched]->thread_inherit ( ksched[sched], kthread, donor );
+
+	return 0;
+}
+
+/*! Print thread information specific to its scheduler (for kthread_info) */
+void ksched2_thread_info ( kthread_t *kthread )
+{
+	int sched = kthread_get_sched_policy ( kthread );
+
+	if ( ksched[sched] && ksched[sched]->thread_info )
+		ksched[sched]->thread_info ( ksched[sched], kthread );
+}
+
+/*! Describe state of all schedulers into buffer ("sysinfo sched") */
+int ksched_info ( char *buffer, size_t buf_size )
+{
+	size_t len;
+	int i;
+
+	ksprintf ( buffer, buf_size, "Master: schedule calls=%u, full=%u, "
+		   "switches=%u\n", ready.calls, ready.full, ready.switches );
+
+	for ( i = 0; i < SCHED_NUM; i++ )
+	{
+		if ( ksched[i] && ksched[i]->info )
+		{
+			len = strlen ( buffer );
+			ksched[i]->info ( ksched[i], buffer + len,
+					  buf_size - len );
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
 /*! Reschedule within given scheduler */
 void ksched2_schedule ( int sched_policy )
 {
@@ -21,9 +21,14 @@ void ksched_init ();
 void kthread_move_to_ready ( kthread_t *kthread, int where );
 kthread_t *kthread_remove_from_ready ( kthread_t *kthread );
 void kthreads_schedule ();
+void kthreads_need_resched ();
+void kthreads_need_signal_check ();
+int ksched_info ( char *buffer, size_t buf_size );
 
 #ifdef _K_SCHED_C_
 
+#include <lib/prio_bitmap.h>
+
 /*! ready thread data structure */
 typedef struct _sched_ready_t_
 {
@@ -35,9 +40,25 @@ typedef struct _sched_ready_t_
 		    /* array of ready queues; each array element one list for
 		     * one priority; array index is priority */
 
-	uint	   *mask;
-	uint	    mask_len;
-		    /* bit mask for O(1) searching for highest priority thread*/
+	prio_bitmap_t  mask;
+		    /* hierarchical bit mask (summary word + leaf words) for
+		     * O(1) searching for highest priority thread */
+
+	int	    need_resched;
+		    /* ready threads changed (or active thread's context):
+		     * active thread must be reevaluated and (re)selected */
+
+	int	    need_signal_check;
+		    /* signals might have become deliverable to active thread */
+
+	kthread_t  *selected;
+		    /* thread whose context is selected for return */
+
+	uint	    calls;
+	uint	    full;
+	uint	    switches;
+		    /* statistics: kthreads_schedule calls, calls that had to
+		     * do full scheduling, active thread changes */
 }
 sched_ready_t;
 
@@ -53,6 +74,9 @@ sched_ready_t;
 
 #include "sched_rr.h"
 #include "sched_edf.h"
+#include "sched_cbs.h"
+#include "sched_fair.h"
+#include "sched_rm.h"
 
 /*! Thread specific data/interface (for scheduler, nor for user) ------------ */
 
@@ -65,6 +89,15 @@ typedef union _kthread_sched_params_t_
 	ksched_edf_thread_params_t  edf;
 		      /* Earliest Deadline First per thread data */
 
+	ksched_cbs_thread_params_t  cbs;
+		      /* Constant Bandwidth Server per thread data */
+
+	ksched_fair_thread_params_t fair;
+		      /* Fair (virtual runtime) scheduler per thread data */
+
+	ksched_rm_thread_params_t   rm;
+		      /* Rate Monotonic per thread data */
+
 	/* add others thread scheduling parameters for other schedulers that
 	   require parameters */
 }
@@ -90,12 +123,17 @@ typedef struct _ksched_t_ ksched_t;
 
 ksched_t *ksched2_get ( int sched_policy );
 
+int ksched2_admit ( kthread_t *kthread, int sched_policy,
+		    sched_supp_t *sched_param );
 int ksched2_thread_add ( kthread_t *kthread, int sched_policy,
 			 int sched_priority, sched_supp_t *sched_param );
 int ksched2_thread_remove ( kthread_t *kthread );
 int ksched2_activate_thread ( kthread_t *kthread );
 int ksched2_deactivate_thread ( kthread_t *kthread );
+int ksched2_thread_wakeup ( kthread_t *kthread );
 int ksched2_setsched_param ( kthread_t *kthread, sched_supp_t *sched_param );
+int ksched2_inherit ( kthread_t *kthread, kthread_t *donor );
+void ksched2_thread_info ( kthread_t *kthread );
 
 void ksched2_schedule ( int sched_policy );
 
@@ -110,6 +148,15 @@ typedef union _ksched_params_t_
 	ksched_edf_t  edf;
 		      /* Earliest Deadline First data */
 
+	ksched_cbs_t  cbs;
+		      /* Constant Bandwidth Server data */
+
+	ksched_fair_t fair;
+		      /* Fair (virtual runtime) scheduler data */
+
+	ksched_rm_t   rm;
+		      /* Rate Monotonic data */
+
 	/* add others thread scheduling parameters for other schedulers that
 	   require parameters */
 }
@@ -127,6 +174,11 @@ struct _ksched_t_
 	int  (*schedule) ( ksched_t *ksched );
 	     /* schedule - pick next active thread */
 
+	int  (*thread_admit) ( ksched_t *ksched, kthread_t *kthread,
+			       sched_supp_t *sched_param );
+	/* may thread (NULL - new one) get given parameters? (0 - yes, or
+	 * error number, e.g. EAGAIN when scheduler capacity is exhausted) */
+
 	int  (*thread_add) ( ksched_t *ksched, kthread_t *kthread,
 			     int sched_priority, sched_supp_t *sched_param );
 	/* actions when thread is created or when it switch to this scheduler */
@@ -140,6 +192,10 @@ struct _ksched_t_
 	int  (*thread_deactivate) ( ksched_t *ksched, kthread_t *kthread );
 	     /* actions when thread stopped to be active */
 
+	int  (*thread_wakeup) ( ksched_t *ksched, kthread_t *kthread );
+	     /* blocked thread is to be put in ready queue; return TRUE if
+	      * scheduler took it instead (e.g. CBS puts it in EDF heap) */
+
 	int  (*set_thread_sched_parameters) (
 	       ksched_t *ksched, kthread_t *kthread, sched_supp_t *param );
 	     /* set scheduler specific parameters to thread */
@@ -148,8 +204,25 @@ struct _ksched_t_
 	       ksched_t *ksched, kthread_t *kthread, sched_supp_t *param );
 	     /* get scheduler specific parameters from thread */
 
+	int  (*thread_inherit) ( ksched_t *ksched, kthread_t *kthread,
+				 kthread_t *donor );
+	/* thread owns mutex (with priority inheritance) donor is blocked on;
+	 * donor == NULL: drop everything inherited so far */
+
+	void (*thread_info) ( ksched_t *ksched, kthread_t *kthread );
+	     /* print scheduler specific thread information (statistics) */
+
+	int  (*info) ( ksched_t *ksched, char *buffer, size_t buf_size );
+	     /* describe scheduler state into buffer (for "sysinfo sched") */
+
 	ksched_params_t  params;
 			 /* scheduler specific data */
 };
 
+/*! EDF functions used by CBS (threads of both are ordered by deadline) */
+void edf_select ( ksched_t *ksched );
+void edf_ready_add ( ksched_t *ksched, kthread_t *kthread );
+int edf_admit ( ksched_t *ksched, kthread_t *kthread, sched_edf_t *params );
+int edf_reserve ( ksched_t *ksched, kthread_t *kthread, sched_edf_t *params );
+
 #endif /* _K_SCHED_ */
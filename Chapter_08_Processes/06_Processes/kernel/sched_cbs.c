@@ -0,0 +1,372 @@
+/*! Constant Bandwidth Server (CBS) Scheduler
+ *
+ * Thread with CBS policy is served by server with budget Q and period T
+ * (bandwidth Q/T is reserved with EDF admission control). CBS threads are
+ * ordered by EDF, together with EDF threads, by server deadline d:
+ * - execution is subtracted from remaining budget c (on deactivation)
+ * - when c is exhausted it is replenished (c = Q) and deadline postponed
+ *   (d = d + T); thread then competes with others with new deadline
+ * - when blocked thread is woken and c could not be used until d without
+ *   exceeding server bandwidth (c >= (d - now) * Q / T), new server period
+ *   is started: d = now + T, c = Q
+ * Aperiodic work so gets its bandwidth, but EDF threads still meet their
+ * deadlines, however long it runs.
+ */
+#define _K_SCHED_CBS_C_
+#define _K_SCHED_
+
+#include "sched.h"
+#include "time.h"
+#include <kernel/errno.h>
+#include <kernel/kprint.h>
+#include <types/basic.h>
+
+static int cbs_init ( ksched_t *ksched );
+static int cbs_schedule ( ksched_t *ksched );
+static int cbs_thread_admit ( ksched_t *ksched, kthread_t *kthread,
+			      sched_supp_t *sched_param );
+static int cbs_thread_add ( ksched_t *ksched, kthread_t *kthread,
+			    int sched_priority, sched_supp_t *sched_param );
+static int cbs_thread_remove ( ksched_t *ksched, kthread_t *kthread );
+static int cbs_thread_activate ( ksched_t *ksched, kthread_t *kthread );
+static int cbs_thread_deactivate ( ksched_t *ksched, kthread_t *kthread );
+static int cbs_thread_wakeup ( ksched_t *ksched, kthread_t *kthread );
+static int cbs_set_thread_sched_parameters ( ksched_t *ksched,
+					     kthread_t *kthread,
+					     sched_supp_t *sched_param );
+static int cbs_thread_inherit ( ksched_t *ksched, kthread_t *kthread,
+				kthread_t *donor );
+static void cbs_thread_info ( ksched_t *ksched, kthread_t *kthread );
+
+static int cbs_server ( ksched_t *ksched, sched_supp_t *sched_param,
+			sched_edf_t *server );
+static void cbs_wakeup_deadline ( ksched_cbs_thread_params_t *cbs,
+				  timespec_t *now );
+static void cbs_budget_alarm ( sigval_t sigev_value );
+
+/*! EDF scheduler orders CBS threads */
+extern ksched_t ksched_edf;
+
+/*! statically defined Constant Bandwidth Server Scheduler */
+ksched_t ksched_cbs = (ksched_t)
+{
+	.sched_id =			SCHED_CBS,
+
+	.init =				cbs_init,
+	.schedule =			cbs_schedule,
+	.thread_admit =			cbs_thread_admit,
+	.thread_add =			cbs_thread_add,
+	.thread_remove =		cbs_thread_remove,
+	.thread_activate =		cbs_thread_activate,
+	.thread_deactivate =		cbs_thread_deactivate,
+	.thread_wakeup =		cbs_thread_wakeup,
+	.set_thread_sched_parameters =	cbs_set_thread_sched_parameters,
+	.get_thread_sched_parameters =	NULL,
+	.thread_inherit =		cbs_thread_inherit,
+	.thread_info =			cbs_thread_info,
+	.info =				NULL,
+
+	.params.cbs.budget =		{ 0, 10000000 },
+	.params.cbs.period =		{ 0, 100000000 }
+};
+
+/*! Initialize CBS scheduler (create budget timer) */
+static int cbs_init ( ksched_t *ksched )
+{
+	sigevent_t evp;
+
+	evp.sigev_notify = SIGEV_THREAD;
+	evp.sigev_notify_function = cbs_budget_alarm;
+	evp.sigev_notify_attributes = NULL;
+	evp.sigev_value.sival_ptr = ksched;
+
+	ktimer_create ( CLOCK_REALTIME, &evp, &ksched->params.cbs.ktimer,
+			NULL );
+	TIME_RESET ( &ksched->params.cbs.alarm.it_interval );
+	TIME_RESET ( &ksched->params.cbs.alarm.it_value );
+
+	return 0;
+}
+
+/*! CBS threads are scheduled by EDF */
+static int cbs_schedule ( ksched_t *ksched )
+{
+	return ksched_edf.schedule ( &ksched_edf );
+}
+
+/*! Server (Q, T) must fit in unused EDF bandwidth */
+static int cbs_thread_admit ( ksched_t *ksched, kthread_t *kthread,
+			      sched_supp_t *sched_param )
+{
+	sched_edf_t server;
+	int retval;
+
+	retval = cbs_server ( ksched, sched_param, &server );
+	if ( retval )
+		return retval;
+
+	return edf_admit ( &ksched_edf, kthread, &server );
+}
+
+/*! Add thread to CBS: reserve bandwidth and start first server period */
+static int cbs_thread_add ( ksched_t *ksched, kthread_t *kthread,
+			    int sched_priority, sched_supp_t *sched_param )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	ksched_cbs_thread_params_t *cbs = &tsched->params.cbs;
+	sched_edf_t server;
+	timespec_t now;
+
+	/* EDF part of thread data (without EDF parameters and alarms) */
+	ksched_edf.thread_add ( &ksched_edf, kthread, sched_priority, NULL );
+
+	if ( cbs_server ( ksched, sched_param, &server ) )
+		cbs_server ( ksched, NULL, &server );
+
+	cbs->budget = server.wcet;
+	cbs->period = server.period;
+	cbs->postponed = 0;
+	edf_reserve ( &ksched_edf, kthread, &server );
+
+	kclock_gettime ( CLOCK_REALTIME, &now );
+	cbs->idle = FALSE;
+	cbs->start = now;
+	cbs->remaining = cbs->budget;
+	cbs->edf.active_deadline = now;
+	time_add ( &cbs->edf.active_deadline, &cbs->period );
+
+	/* from now on thread competes with EDF threads */
+	edf_ready_add ( &ksched_edf, kthread );
+	edf_select ( &ksched_edf );
+
+	return 0;
+}
+
+/*! Remove thread from CBS (and from EDF, release its bandwidth) */
+static int cbs_thread_remove ( ksched_t *ksched, kthread_t *kthread )
+{
+	if ( kthread == kthread_get_active () )
+	{
+		/* disarm timer */
+		TIME_RESET ( &ksched->params.cbs.alarm.it_value );
+		ktimer_settime ( ksched->params.cbs.ktimer, 0,
+				 &ksched->params.cbs.alarm, NULL );
+	}
+
+	return ksched_edf.thread_remove ( &ksched_edf, kthread );
+}
+
+/*! Thread is to become active: set alarm for when its budget is exhausted */
+static int cbs_thread_activate ( ksched_t *ksched, kthread_t *kthread )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	ksched_cbs_thread_params_t *cbs = &tsched->params.cbs;
+
+	kclock_gettime ( CLOCK_REALTIME, &cbs->start );
+
+	ksched->params.cbs.alarm.it_value = cbs->start;
+	time_add ( &ksched->params.cbs.alarm.it_value, &cbs->remaining );
+
+	ktimer_settime ( ksched->params.cbs.ktimer, TIMER_ABSTIME,
+			 &ksched->params.cbs.alarm, NULL );
+
+	return 0;
+}
+
+/*!
+ * Deactivate thread because:
+ * 1. higher priority thread or EDF thread with earlier deadline preempts it
+ * 2. its budget is exhausted (from cbs_budget_alarm)
+ * 3. this thread blocks on some queue
+ */
+static int cbs_thread_deactivate ( ksched_t *ksched, kthread_t *kthread )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	ksched_cbs_thread_params_t *cbs = &tsched->params.cbs;
+	timespec_t now, used;
+	int postponed = FALSE;
+
+	TIME_RESET ( &ksched->params.cbs.alarm.it_value );
+	ktimer_settime ( ksched->params.cbs.ktimer, 0,
+			 &ksched->params.cbs.alarm, NULL );
+
+	/* subtract execution from budget */
+	kclock_gettime ( CLOCK_REALTIME, &now );
+	used = now;
+	time_sub ( &used, &cbs->start );
+	cbs->start = now;
+
+	if ( time_cmp ( &used, &cbs->remaining ) < 0 )
+	{
+		time_sub ( &cbs->remaining, &used );
+	}
+	else {
+		/* budget exhausted: replenish it and postpone deadline */
+		cbs->remaining = cbs->budget;
+		time_add ( &cbs->edf.active_deadline, &cbs->period );
+		cbs->postponed++;
+		postponed = TRUE;
+	}
+
+	/* edf_select must not deactivate it again */
+	tsched->activated = 0;
+
+	if ( !kthread_is_ready ( kthread ) )
+	{
+		/* blocked: EDF picks another thread
+		 * (deadline is reconsidered when thread is woken) */
+		cbs->idle = TRUE;
+		edf_select ( &ksched_edf );
+	}
+	else if ( postponed )
+	{
+		/* compete with EDF threads with new deadline */
+		edf_select ( &ksched_edf );
+	}
+
+	return 0;
+}
+
+/*! Woken thread is put in EDF ready heap, not directly in ready queue */
+static int cbs_thread_wakeup ( ksched_t *ksched, kthread_t *kthread )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	ksched_cbs_thread_params_t *cbs = &tsched->params.cbs;
+	timespec_t now;
+
+	/* thread selected by EDF goes to ready queue */
+	if ( kthread == ksched_edf.params.edf.active )
+		return FALSE;
+
+	/* already in EDF ready heap */
+	if ( cbs->edf.ready_h.index != -1 )
+		return TRUE;
+
+	if ( cbs->idle )
+	{
+		kclock_gettime ( CLOCK_REALTIME, &now );
+		cbs_wakeup_deadline ( cbs, &now );
+		cbs->idle = FALSE;
+	}
+
+	edf_ready_add ( &ksched_edf, kthread );
+	edf_select ( &ksched_edf );
+
+	return TRUE;
+}
+
+/*! Change server parameters (already checked with cbs_thread_admit) */
+static int cbs_set_thread_sched_parameters ( ksched_t *ksched,
+					     kthread_t *kthread,
+					     sched_supp_t *sched_param )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	ksched_cbs_thread_params_t *cbs = &tsched->params.cbs;
+	sched_edf_t server;
+
+	if ( cbs_server ( ksched, sched_param, &server ) )
+		return EXIT_FAILURE;
+
+	cbs->budget = server.wcet;
+	cbs->period = server.period;
+	edf_reserve ( &ksched_edf, kthread, &server );
+
+	if ( time_cmp ( &cbs->remaining, &cbs->budget ) > 0 )
+		cbs->remaining = cbs->budget;
+
+	return 0;
+}
+
+/*! Deadline inheritance, as for EDF threads */
+static int cbs_thread_inherit ( ksched_t *ksched, kthread_t *kthread,
+				kthread_t *donor )
+{
+	return ksched_edf.thread_inherit ( &ksched_edf, kthread, donor );
+}
+
+/*! time in microseconds */
+#define CBS_USEC(T)	( (uint64) (T)->tv_sec * 1000000 + (T)->tv_nsec / 1000 )
+
+/*! Print CBS server state for thread */
+static void cbs_thread_info ( ksched_t *ksched, kthread_t *kthread )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	ksched_cbs_thread_params_t *cbs = &tsched->params.cbs;
+
+	kprintf ( "\tCBS: budget=%d us, period=%d us, remaining=%d us\n",
+		  (uint) CBS_USEC ( &cbs->budget ),
+		  (uint) CBS_USEC ( &cbs->period ),
+		  (uint) CBS_USEC ( &cbs->remaining ) );
+	kprintf ( "\tCBS: budget exhausted (deadline postponed) %d times\n",
+		  cbs->postponed );
+}
+
+/*! Server parameters (given or default) as EDF reservation: D = T */
+static int cbs_server ( ksched_t *ksched, sched_supp_t *sched_param,
+			sched_edf_t *server )
+{
+	if ( sched_param )
+	{
+		server->wcet = sched_param->cbs.budget;
+		server->period = sched_param->cbs.period;
+	}
+	else {
+		server->wcet = ksched->params.cbs.budget;
+		server->period = ksched->params.cbs.period;
+	}
+	server->deadline = server->period;
+	server->flags = 0;
+
+	if ( !TIME_IS_SET ( &server->wcet ) ||
+	     time_cmp ( &server->wcet, &server->period ) > 0 )
+		return EINVAL;
+
+	return 0;
+}
+
+/*!
+ * Woken thread: keep deadline and remaining budget only if budget can be
+ * used until deadline without exceeding server bandwidth
+ */
+static void cbs_wakeup_deadline ( ksched_cbs_thread_params_t *cbs,
+				  timespec_t *now )
+{
+	timespec_t left;
+
+	if ( time_cmp ( &cbs->edf.active_deadline, now ) > 0 )
+	{
+		left = cbs->edf.active_deadline;
+		time_sub ( &left, now );
+
+		/* c < (d - now) * Q / T */
+		if ( CBS_USEC ( &cbs->remaining ) * CBS_USEC ( &cbs->period ) <
+		     CBS_USEC ( &left ) * CBS_USEC ( &cbs->budget ) )
+			return;
+	}
+
+	cbs->remaining = cbs->budget;
+	cbs->edf.active_deadline = *now;
+	time_add ( &cbs->edf.active_deadline, &cbs->period );
+}
+
+/*! Timer interrupt: budget of active CBS thread is exhausted */
+static void cbs_budget_alarm ( sigval_t sigev_value )
+{
+	ksched_t *ksched = sigev_value.sival_ptr;
+	kthread_t *kthread = kthread_get_active ();
+
+	if ( ksched != ksched2_get ( kthread_get_sched_policy (kthread) ) )
+	{
+		LOG ( DEBUG, "CBS budget alarm for non CBS thread!" );
+		return;
+	}
+
+	/* account execution: deadline is postponed, EDF may preempt it */
+	ksched2_deactivate_thread ( kthread );
+
+	/* still active: continue with replenished budget */
+	if ( kthread_is_active ( kthread ) )
+		ksched2_activate_thread ( kthread );
+
+	kthreads_schedule ();
+}
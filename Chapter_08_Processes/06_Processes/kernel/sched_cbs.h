@@ -0,0 +1,40 @@
+/*! Constant Bandwidth Server scheduler */
+#pragma once
+
+#include "sched_edf.h"
+
+/*! Per thread scheduler data */
+typedef struct _ksched_cbs_thread_params_t_
+{
+	ksched_edf_thread_params_t  edf;
+		    /* server deadline (active_deadline), place in EDF heap;
+		     * must be first: EDF orders CBS threads as its own */
+
+	timespec_t  budget;
+	timespec_t  period;
+		    /* server parameters (Q, T) */
+	timespec_t  remaining;
+		    /* budget left in current server period */
+	timespec_t  start;
+		    /* when thread was activated (consumption is measured) */
+	int         idle;
+		    /* thread blocked: deadline is reconsidered on wakeup */
+	uint        postponed;
+		    /* statistics: how many times budget was exhausted */
+}
+ksched_cbs_thread_params_t;
+
+/*! CBS global parameters */
+typedef struct _ksched_cbs_t_
+{
+	timespec_t    budget;
+	timespec_t    period;
+		      /* server parameters for threads that did not set them */
+
+	ktimer_t     *ktimer;
+		      /* budget exhaustion timer (only one thread is active) */
+
+	itimerspec_t  alarm;
+		      /* alarm parameters */
+}
+ksched_cbs_t;
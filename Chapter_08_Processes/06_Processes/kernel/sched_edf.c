@@ -5,9 +5,13 @@
 #include "sched.h"
 #include "time.h"
 #include <kernel/errno.h>
+#include <kernel/kprint.h>
 #include <types/basic.h>
+#include <types/bits.h>
 
 static int edf_init ( ksched_t *ksched );
+static int edf_thread_admit ( ksched_t *ksched, kthread_t *kthread,
+			      sched_supp_t *sched_param );
 static int edf_thread_add ( ksched_t *ksched, kthread_t *kthread,
 			     int sched_priority, sched_supp_t *sched_param );
 static int edf_thread_remove ( ksched_t *ksched, kthread_t *kthread );
@@ -15,6 +19,19 @@ static int edf_set_thread_sched_parameters ( ksched_t *ksched,
 					     kthread_t *kthread,
 					     sched_supp_t *params );
 static int edf_thread_deactivate ( ksched_t *ksched, kthread_t *kthread );
+static int edf_thread_inherit ( ksched_t *ksched, kthread_t *kthread,
+				kthread_t *donor );
+static timespec_t *edf_deadline ( kthread_t *kthread );
+static void edf_thread_info ( ksched_t *ksched, kthread_t *kthread );
+static int edf_info ( ksched_t *ksched, char *buffer, size_t buf_size );
+
+static int edf_reservation ( sched_edf_t *params, edf_reservation_t *res );
+static int edf_demand_test ( list_t *admitted, uint32 util );
+static void edf_release ( ksched_t *ksched, kthread_t *kthread );
+
+static int edf_cmp ( void *a, void *b );
+static void edf_job_done ( kthread_t *kthread, timespec_t *now );
+static void edf_job_missed ( kthread_t *kthread );
 
 static int edf_schedule ( ksched_t *ksched );
 
@@ -30,12 +47,17 @@ ksched_t ksched_edf = (ksched_t)
 
 	.init = 			edf_init,
 	.schedule = 			edf_schedule,
+	.thread_admit =			edf_thread_admit,
 	.thread_add =			edf_thread_add,
 	.thread_remove =		edf_thread_remove,
 	.thread_activate =		NULL,
 	.thread_deactivate =		edf_thread_deactivate,
+	.thread_wakeup =		NULL,
 	.set_thread_sched_parameters =	edf_set_thread_sched_parameters,
 	.get_thread_sched_parameters =	NULL,
+	.thread_inherit =		edf_thread_inherit,
+	.thread_info =			edf_thread_info,
+	.info =				edf_info,
 
 	.params.edf.active =		NULL
 };
@@ -44,8 +66,12 @@ ksched_t ksched_edf = (ksched_t)
 static int edf_init ( ksched_t *ksched )
 {
 	ksched->params.edf.active = NULL;
-	kthreadq_init ( &ksched->params.edf.ready );
+	heap_init ( &ksched->params.edf.ready, edf_cmp,
+		    kmalloc ( EDF_READY_INIT * sizeof (heap_h *) ),
+		    EDF_READY_INIT );
 	kthreadq_init ( &ksched->params.edf.wait );
+	list_init ( &ksched->params.edf.admitted );
+	ksched->params.edf.utilization = 0;
 
 	return 0;
 }
@@ -56,6 +82,15 @@ static int edf_thread_add ( ksched_t *ksched, kthread_t *kthread,
 
 	tsched->params.edf.period_alarm = NULL;
 	tsched->params.edf.deadline_alarm = NULL;
+	tsched->params.edf.inherited = FALSE;
+	tsched->params.edf.ready_h.index = -1;
+	tsched->params.edf.res.wcet = 0;
+
+	tsched->params.edf.jobs = tsched->params.edf.misses = 0;
+	TIME_RESET ( &tsched->params.edf.max_lateness );
+	TIME_RESET ( &tsched->params.edf.response );
+	TIME_RESET ( &tsched->params.edf.max_response );
+	tsched->params.edf.in_job = tsched->params.edf.missed = FALSE;
 
 	if ( sched_param && sched_param->edf.flags & EDF_SET )
 		edf_set_thread_sched_parameters (ksched, kthread, sched_param);
@@ -70,6 +105,10 @@ static int edf_thread_remove ( ksched_t *ksched, kthread_t *kthread )
 	if ( ksched->params.edf.active == kthread )
 		ksched->params.edf.active = NULL;
 
+	if ( tsched->params.edf.ready_h.index != -1 )
+		heap_remove ( &ksched->params.edf.ready,
+			      &tsched->params.edf.ready_h );
+
 	if ( tsched->params.edf.period_alarm )
 	{
 		ktimer_delete ( tsched->params.edf.period_alarm );
@@ -81,15 +120,21 @@ static int edf_thread_remove ( ksched_t *ksched, kthread_t *kthread )
 		tsched->params.edf.deadline_alarm = NULL;
 	}
 
+	edf_release ( ksched, kthread );
+
 	edf_schedule ( ksched );
 
 	return 0;
 }
 
+/*! Create thread alarm (existing one is reused, caller re-arms it) */
 static int edf_create_alarm ( kthread_t *kthread, void *action, void **timer )
 {
 	sigevent_t evp;
 
+	if ( *timer )
+		return EXIT_SUCCESS;
+
 	evp.sigev_notify = SIGEV_THREAD;
 	evp.sigev_notify_function = action;
 	evp.sigev_notify_attributes = NULL;
@@ -113,6 +158,10 @@ static int edf_set_thread_sched_parameters ( ksched_t *ksched,
 
 	if ( params->edf.flags & EDF_SET )
 	{
+		/* already checked with edf_thread_admit */
+		if ( edf_reserve ( ksched, kthread, &params->edf ) )
+			return EXIT_FAILURE;
+
 		tsched->params.edf.period = params->edf.period;
 		tsched->params.edf.relative_deadline = params->edf.deadline;
 		tsched->params.edf.flags = params->edf.flags ^ EDF_SET;
@@ -143,12 +192,16 @@ static int edf_set_thread_sched_parameters ( ksched_t *ksched,
 		ktimer_settime ( tsched->params.edf.deadline_alarm,
 				 TIMER_ABSTIME, &alarm, NULL );
 
+		tsched->params.edf.in_job = FALSE;
+
 		/* move thread to edf scheduler */
-		kthread_enqueue ( kthread, &ksched->params.edf.ready );
+		edf_ready_add ( ksched, kthread );
 		edf_schedule (ksched);
 	}
 	else if ( params->edf.flags & EDF_WAIT )
 	{
+		edf_job_done ( kthread, &now );
+
 		if ( edf_check_deadline ( kthread ) )
 			return EXIT_FAILURE;
 
@@ -188,7 +241,7 @@ static int edf_set_thread_sched_parameters ( ksched_t *ksched,
 			 * activate task => move it to "EDF ready tasks"
 			 */
 			EDF_LOG ( "%x [EDF READY]", kthread );
-			kthread_enqueue ( kthread, &ksched->params.edf.ready );
+			edf_ready_add ( ksched, kthread );
 			edf_schedule (ksched);
 		}
 	}
@@ -197,6 +250,8 @@ static int edf_set_thread_sched_parameters ( ksched_t *ksched,
 		if ( kthread == ksched->params.edf.active )
 			ksched->params.edf.active = NULL;
 
+		edf_job_done ( kthread, &now );
+
 		if ( edf_check_deadline ( kthread ) )
 		{
 			EDF_LOG ( "%x [EXIT-error]", kthread );
@@ -231,8 +286,21 @@ static int edf_set_thread_sched_parameters ( ksched_t *ksched,
 
 static int edf_schedule ( ksched_t *ksched )
 {
-	kthread_t *first, *next, *edf_active;
-	kthread_sched2_t *sch_first, *sch_next, *ea;
+	edf_select ( ksched );
+
+	kthreads_schedule ();
+
+	return 0;
+}
+
+/*!
+ * Select active EDF thread (earliest deadline) and put it in ready queue;
+ * others are kept in EDF ready heap (caller should call kthreads_schedule)
+ */
+void edf_select ( ksched_t *ksched )
+{
+	kthread_t *first, *edf_active;
+	kthread_sched2_t *tsched;
 
 	edf_active = ksched->params.edf.active;
 	if ( edf_active && !kthread_is_ready ( edf_active ) )
@@ -240,87 +308,93 @@ static int edf_schedule ( ksched_t *ksched )
 		ksched->params.edf.active = edf_active = NULL;
 	}
 
-	first = kthreadq_get ( &ksched->params.edf.ready );
+	first = heap_get ( &ksched->params.edf.ready );
 
-	EDF_LOG ( "%x %x [active, first in queue]", edf_active, first );
+	EDF_LOG ( "%x %x [active, first in heap]", edf_active, first );
+
+	/* active thread stays active if no other has earlier deadline */
+	if ( first && edf_active &&
+	     time_cmp ( edf_deadline ( first ), edf_deadline ( edf_active ) )
+	     >= 0 )
+		first = NULL;
 
 	if ( !first )
-	{
-		kthreads_schedule ();
-		return 0; /* no threads in edf.ready queue, edf.active unch. */
-	}
+		return;
 
 	if ( edf_active )
 	{
-		next = first;
-		first = edf_active;
-	}
-	else {
-		next = kthreadq_get_next ( first );
-	}
-
-	while ( first && next )
-	{
-
-		sch_first = kthread_get_sched2_param ( first );
-		sch_next = kthread_get_sched2_param ( next );
+		EDF_LOG ( "%x=>%x [EDF_SCHED_PREEMPT]", edf_active, first );
 
-		if ( time_cmp ( &sch_first->params.edf.active_deadline,
-			&sch_next->params.edf.active_deadline ) > 0 )
+		/*
+		 * change active EDF thread:
+		 * -remove it from active/ready list
+		 * -put it into edf.ready heap
+		 * (deactivate it now, so its scheduler accounts its execution
+		 * (CBS); it might then already select other thread)
+		 */
+		if ( kthread_is_active ( edf_active ) )
 		{
-			first = next;
+			ksched2_deactivate_thread ( edf_active );
+			if ( ksched->params.edf.active != edf_active )
+				return;
 		}
+		edf_ready_add ( ksched, edf_active );
 
-		next = kthreadq_get_next ( next );
+		first = heap_get ( &ksched->params.edf.ready );
 	}
 
-	if ( first && first != edf_active )
-	{
-		next = kthreadq_remove ( &ksched->params.edf.ready, first );
-		EDF_LOG ( "%x removed, %x is now first", next,
-			  kthreadq_get ( &ksched->params.edf.ready ) );
+	tsched = kthread_get_sched2_param ( first );
+	heap_remove ( &ksched->params.edf.ready, &tsched->params.edf.ready_h );
+	EDF_LOG ( "%x removed, %x is now first", first,
+		  heap_get ( &ksched->params.edf.ready ) );
 
-		if ( edf_active )
-		{
-			EDF_LOG ( "%x=>%x [EDF_SCHED_PREEMPT]",
-				  edf_active, first );
+	ksched->params.edf.active = first;
+	EDF_LOG ( "%x [new active]", first );
 
-			/*
-			 * change active EDF thread:
-			 * -remove it from active/ready list
-			 * -put it into edf.ready list
-			 */
-			if ( kthread_is_ready (edf_active) )
-			{
-				if ( !kthread_is_active (edf_active) )
-				{
-					kthread_remove_from_ready (edf_active);
-
-					/*
-					 * set "deactivated" flag, don't need
-					 * another call to "edf_schedule"
-					 */
-				}
-				else {
-				ea = kthread_get_sched2_param (edf_active);
-				ea->activated = 0;
-				}
-
-				kthread_enqueue ( edf_active,
-						  &ksched->params.edf.ready );
-			}
-			/* else = thread is blocked - leave it there */
-		}
+	kthread_move_to_ready ( first, LAST );
+}
 
-		ksched->params.edf.active = first;
-		EDF_LOG ( "%x [new active]", first );
+/*!
+ * Put thread in EDF ready heap (enlarge heap if full)
+ * Thread is waiting (not in master scheduler ready list) until EDF selects it.
+ */
+void edf_ready_add ( ksched_t *ksched, kthread_t *kthread )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	heap_t *ready = &ksched->params.edf.ready;
+	heap_h **old, **new;
 
-		kthread_move_to_ready ( first, LAST );
+	if ( tsched->params.edf.ready_h.index != -1 )
+	{
+		heap_update ( ready, &tsched->params.edf.ready_h );
+		return;
 	}
 
-	kthreads_schedule ();
+#ifdef LATENCY_TRACE
+	/* released job (not preempted thread): latency is measured from now */
+	if ( !kthread_is_ready ( kthread ) )
+		klatency_wakeup ( kthread );
+#endif
+	if ( kthread_is_ready ( kthread ) && !kthread_is_active ( kthread ) )
+		kthread_remove_from_ready ( kthread );
+	kthread_mark_waiting ( kthread );
 
-	return 0;
+	if ( heap_is_full ( ready ) )
+	{
+		old = ready->elem;
+		new = kmalloc ( 2 * ready->max * sizeof (heap_h *) );
+		ASSERT ( new );
+		heap_resize ( ready, new, 2 * ready->max );
+		kfree ( old );
+	}
+
+	heap_insert ( ready, kthread, &tsched->params.edf.ready_h );
+}
+
+/*! Compare threads by deadlines (for ready heap) */
+static int edf_cmp ( void *a, void *b )
+{
+	return time_cmp ( edf_deadline ( a ), edf_deadline ( b ) );
 }
 
 /*! Timer interrupt for edf */
@@ -342,7 +416,7 @@ static void edf_period_alarm ( sigval_t sigev_value )
 		if ( !edf_check_deadline ( kthread ) )
 		{
 			EDF_LOG ( "%x [Waked, moved to edf.ready]", kthread );
-			kthread_enqueue ( kthread, &ksched->params.edf.ready );
+			edf_ready_add ( ksched, kthread );
 
 			edf_schedule (ksched);
 		}
@@ -378,6 +452,7 @@ static void edf_deadline_alarm ( sigval_t sigev_value )
 	if( test == kthread )
 	{
 		EDF_LOG ( "%x [Waked, but too late]", kthread );
+		edf_job_missed ( kthread );
 
 		kthread_set_syscall_retval ( kthread, EXIT_FAILURE );
 		kthread_move_to_ready ( kthread, LAST );
@@ -404,6 +479,8 @@ static void edf_deadline_alarm ( sigval_t sigev_value )
 
 	if ( edf_check_deadline ( kthread ) )
 	{
+		edf_job_missed ( kthread );
+
 		/* what to do if its missed? kill thread? */
 		if ( tsched->params.edf.flags & EDF_TERMINATE )
 		{
@@ -447,7 +524,9 @@ static void edf_deadline_alarm ( sigval_t sigev_value )
 			ktimer_settime ( tsched->params.edf.period_alarm,
 					 TIMER_ABSTIME, &alarm, NULL );
 
-			kthread_enqueue (kthread, &ksched->params.edf.ready);
+			/* skipped job is finished, next one is released */
+			tsched->params.edf.missed = FALSE;
+			edf_ready_add ( ksched, kthread );
 			edf_schedule (ksched);
 		}
 	} /* moved 1 tab left for readability */
@@ -461,18 +540,386 @@ static void edf_deadline_alarm ( sigval_t sigev_value )
  */
 static int edf_thread_deactivate ( ksched_t *ksched, kthread_t *kthread )
 {
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+
 	if (	kthread_is_alive (kthread) && !kthread_is_ready (kthread) &&
-		kthread_get_queue (kthread) != &ksched->params.edf.ready &&
+		tsched->params.edf.ready_h.index == -1 &&
 		kthread_get_queue (kthread) != &ksched->params.edf.wait )
 	{
-		/* if kthread is blocked, but not in edf.ready */
+		/* if kthread is blocked, but not in edf.ready
+		 * (kthreads_schedule, that called us, will pick new one) */
 		ksched->params.edf.active = NULL;
-		edf_schedule ( ksched );
+		edf_select ( ksched );
+	}
+
+	return 0;
+}
+
+/*!
+ * Deadline inheritance: owner of mutex with priority inheritance protocol is
+ * scheduled with earliest deadline of EDF threads blocked on its mutexes.
+ * Non EDF donor (with priority not lower than owner, already boosted with
+ * kthread_set_prio) has no deadline: owner is then scheduled before all
+ * other EDF threads, to release mutex as soon as possible.
+ */
+static int edf_thread_inherit ( ksched_t *ksched, kthread_t *kthread,
+				kthread_t *donor )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	timespec_t deadline;
+
+	if ( !donor )
+	{
+		if ( !tsched->params.edf.inherited )
+			return 0;
+		tsched->params.edf.inherited = FALSE;
+	}
+	else {
+		if ( kthread_get_sched_policy ( donor ) == SCHED_EDF ||
+		     kthread_get_sched_policy ( donor ) == SCHED_CBS )
+			deadline = *edf_deadline ( donor );
+		else if ( kthread_get_prio ( donor ) >=
+			  kthread_get_prio ( kthread ) )
+			TIME_RESET ( &deadline );
+		else
+			return 0;
+
+		if ( tsched->params.edf.inherited && time_cmp ( &deadline,
+			&tsched->params.edf.inherited_deadline ) >= 0 )
+			return 0;
+
+		tsched->params.edf.inherited_deadline = deadline;
+		tsched->params.edf.inherited = TRUE;
+	}
+
+	/* if in ready heap, move it to new place */
+	if ( tsched->params.edf.ready_h.index != -1 )
+		heap_update ( &ksched->params.edf.ready,
+			      &tsched->params.edf.ready_h );
+
+	EDF_LOG ( "%x %x [inherit]", kthread, donor );
+
+	/* owner might be in edf.ready: reconsider which one is active */
+	edf_schedule ( ksched );
+
+	return 0;
+}
+
+/*! Deadline by which threads are ordered: own or inherited (if earlier) */
+static timespec_t *edf_deadline ( kthread_t *kthread )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+
+	if ( tsched->params.edf.inherited && time_cmp (
+		&tsched->params.edf.inherited_deadline,
+		&tsched->params.edf.active_deadline ) < 0 )
+		return &tsched->params.edf.inherited_deadline;
+
+	return &tsched->params.edf.active_deadline;
+}
+
+/*!
+ * Job is completed (edf_wait or edf_exit is called): update statistics
+ * (first edf_wait only releases first job)
+ */
+static void edf_job_done ( kthread_t *kthread, timespec_t *now )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	ksched_edf_thread_params_t *edf = &tsched->params.edf;
+	timespec_t t;
+
+	if ( edf->in_job )
+	{
+		edf->jobs++;
+
+		/* response time: from job release until completion */
+		t = *now;
+		if ( time_cmp ( &t, &edf->next_run ) > 0 )
+			time_sub ( &t, &edf->next_run );
+		else
+			TIME_RESET ( &t );
+		edf->response = t;
+		if ( time_cmp ( &t, &edf->max_response ) > 0 )
+			edf->max_response = t;
+
+		/* lateness (if completed after deadline) */
+		if ( time_cmp ( now, &edf->active_deadline ) > 0 )
+		{
+			t = *now;
+			time_sub ( &t, &edf->active_deadline );
+			if ( time_cmp ( &t, &edf->max_lateness ) > 0 )
+				edf->max_lateness = t;
+
+			if ( !edf->missed )
+				edf->misses++;
+		}
+	}
+
+	edf->in_job = TRUE;
+	edf->missed = FALSE;
+}
+
+/*! Deadline passed before job was completed (count it only once) */
+static void edf_job_missed ( kthread_t *kthread )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+
+	if ( !tsched->params.edf.missed )
+	{
+		tsched->params.edf.misses++;
+		tsched->params.edf.missed = TRUE;
 	}
+}
+
+/*! time in microseconds (for printing) */
+#define EDF_USEC(T)	( (T)->tv_sec * 1000000 + (T)->tv_nsec / 1000 )
+
+/*! Print EDF statistics for thread */
+static void edf_thread_info ( ksched_t *ksched, kthread_t *kthread )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	ksched_edf_thread_params_t *edf = &tsched->params.edf;
+
+	kprintf ( "\tEDF: jobs=%d, deadline misses=%d, max lateness=%d us\n",
+		  edf->jobs, edf->misses, EDF_USEC ( &edf->max_lateness ) );
+	kprintf ( "\tEDF: response time=%d us (max=%d us)\n",
+		  EDF_USEC ( &edf->response ),
+		  EDF_USEC ( &edf->max_response ) );
+}
+
+/*! Describe reserved processor capacity (for "sysinfo sched") */
+static int edf_info ( ksched_t *ksched, char *buffer, size_t buf_size )
+{
+	edf_reservation_t *res;
+	int cnt = 0;
+
+	res = list_get ( &ksched->params.edf.admitted, FIRST );
+	for ( ; res; res = list_get_next ( &res->list ) )
+		cnt++;
+
+	ksprintf ( buffer, buf_size,
+		   "EDF: admitted threads=%d, reserved utilization=%u/%u\n",
+		   cnt, ksched->params.edf.utilization, EDF_UTIL_SCALE );
 
 	return 0;
 }
 
+/*!
+ * Admission control: is thread with given parameters (EDF_SET) schedulable
+ * together with already admitted threads?
+ * Utilization test (sum of wcet/period <= 1) is sufficient when no deadline
+ * is shorter than period; otherwise processor demand is also checked.
+ * Thread without wcet makes no reservation and is always accepted.
+ * \param kthread Thread (NULL if not yet created)
+ * \param sched_param Parameters to check
+ * \return 0 if accepted, EAGAIN if not schedulable, EINVAL for bad times
+ */
+static int edf_thread_admit ( ksched_t *ksched, kthread_t *kthread,
+			      sched_supp_t *sched_param )
+{
+	if ( !sched_param || !( sched_param->edf.flags & EDF_SET ) )
+		return 0;
+
+	return edf_admit ( ksched, kthread, &sched_param->edf );
+}
+
+/*! Admission test for reservation (also used for CBS servers) */
+int edf_admit ( ksched_t *ksched, kthread_t *kthread, sched_edf_t *params )
+{
+	list_t *admitted = &ksched->params.edf.admitted;
+	edf_reservation_t res, *own = NULL;
+	kthread_sched2_t *tsched;
+	uint32 util;
+	int retval;
+
+	retval = edf_reservation ( params, &res );
+	if ( retval || !res.wcet )
+		return retval;
+
+	/* thread already ordered by EDF replaces its reservation */
+	util = ksched->params.edf.utilization;
+	if ( kthread && ( kthread_get_sched_policy ( kthread ) == SCHED_EDF ||
+			  kthread_get_sched_policy ( kthread ) == SCHED_CBS ) )
+	{
+		tsched = kthread_get_sched2_param ( kthread );
+		own = &tsched->params.edf.res;
+		if ( own->wcet )
+			util -= own->util;
+		else
+			own = NULL;
+	}
+
+	if ( res.util > EDF_UTIL_SCALE - util )
+		return EAGAIN;
+	util += res.util;
+
+	/* test task set with new reservation instead of old one */
+	if ( own )
+		list_remove ( admitted, 0, &own->list );
+	list_append ( admitted, &res, &res.list );
+
+	retval = edf_demand_test ( admitted, util );
+
+	list_remove ( admitted, 0, &res.list );
+	if ( own )
+		list_append ( admitted, own, &own->list );
+
+	return retval;
+}
+
+/*! Convert time to microseconds (rounded up) */
+static int edf_usec ( timespec_t *t, uint32 *usec )
+{
+	if ( t->tv_sec < 0 || t->tv_sec >= EDF_MAX_SEC ||
+	     t->tv_nsec < 0 || t->tv_nsec >= 1000000000 )
+		return EINVAL;
+
+	*usec = (uint32) t->tv_sec * 1000000 + ( t->tv_nsec + 999 ) / 1000;
+
+	return 0;
+}
+
+/*! Prepare reservation from thread parameters (not yet admitted) */
+static int edf_reservation ( sched_edf_t *params, edf_reservation_t *res )
+{
+	uint32 util;
+
+	res->wcet = 0;
+	if ( edf_usec ( &params->wcet, &res->wcet ) )
+		return EINVAL;
+	if ( !res->wcet )
+		return 0;
+
+	if ( edf_usec ( &params->deadline, &res->deadline ) ||
+	     edf_usec ( &params->period, &res->period ) || !res->period )
+	{
+		res->wcet = 0;
+		return EINVAL;
+	}
+
+	if ( res->wcet >= res->period ) /* (mul_div_32 result must fit) */
+	{
+		util = EDF_UTIL_SCALE + ( res->wcet > res->period );
+	}
+	else {
+		util = mul_div_32 ( res->wcet, EDF_UTIL_SCALE, res->period );
+		if ( (uint64) util * res->period <
+		     (uint64) res->wcet * EDF_UTIL_SCALE )
+			util++;
+	}
+	res->util = util;
+
+	return 0;
+}
+
+/*! Processor demand of jobs with release and deadline in [0,t] */
+static uint64 edf_demand ( list_t *admitted, uint32 t )
+{
+	edf_reservation_t *res;
+	uint64 demand = 0;
+
+	res = list_get ( admitted, FIRST );
+	for ( ; res; res = list_get_next ( &res->list ) )
+		if ( t >= res->deadline )
+			demand += (uint64) res->wcet *
+				  ( ( t - res->deadline ) / res->period + 1 );
+
+	return demand;
+}
+
+/*!
+ * Processor demand test, for task set with deadlines shorter than periods:
+ * demand in [0,t] must not exceed t, for every absolute deadline t up to
+ * L = max ( D_max, sum ( (T_i - D_i) * U_i ) / ( 1 - U ) ) (Baruah et al.)
+ * When exact test would be too long (U == 1, L does not fit in 32 bits, or
+ * more than EDF_DBF_POINTS deadlines) task set is rejected.
+ * \param admitted Reservations (task set)
+ * \param util Total utilization of task set (not above EDF_UTIL_SCALE)
+ * \return 0 if task set is schedulable, EAGAIN otherwise
+ */
+static int edf_demand_test ( list_t *admitted, uint32 util )
+{
+	edf_reservation_t *res;
+	uint32 free = EDF_UTIL_SCALE - util, dmax = 0, sum = 0, term, t;
+	uint points = 0;
+	int constrained = FALSE;
+
+	res = list_get ( admitted, FIRST );
+	for ( ; res; res = list_get_next ( &res->list ) )
+	{
+		if ( res->deadline > dmax )
+			dmax = res->deadline;
+
+		if ( res->deadline >= res->period )
+			continue;
+
+		constrained = TRUE;
+		if ( (uint64) ( res->period - res->deadline ) * res->util >=
+		     (uint64) free << 32 )
+			return EAGAIN;
+		term = mul_div_32 ( res->period - res->deadline, res->util,
+				    free );
+		if ( sum + term < sum )
+			return EAGAIN;
+		sum += term;
+	}
+
+	if ( !constrained )
+		return 0;
+
+	if ( sum < dmax )
+		sum = dmax; /* sum is now L */
+
+	res = list_get ( admitted, FIRST );
+	for ( ; res; res = list_get_next ( &res->list ) )
+	{
+		for ( t = res->deadline; t <= sum; t += res->period )
+		{
+			if ( ++points > EDF_DBF_POINTS ||
+			     edf_demand ( admitted, t ) > t )
+				return EAGAIN;
+
+			if ( sum - t < res->period )
+				break;
+		}
+	}
+
+	return 0;
+}
+
+/*! Make thread reservation (replacing previous one, if any) */
+int edf_reserve ( ksched_t *ksched, kthread_t *kthread, sched_edf_t *params )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	edf_reservation_t *res = &tsched->params.edf.res;
+	int retval;
+
+	edf_release ( ksched, kthread );
+
+	retval = edf_reservation ( params, res );
+	if ( retval || !res->wcet )
+		return retval;
+
+	list_append ( &ksched->params.edf.admitted, res, &res->list );
+	ksched->params.edf.utilization += res->util;
+
+	return 0;
+}
+
+/*! Release thread reservation */
+static void edf_release ( ksched_t *ksched, kthread_t *kthread )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	edf_reservation_t *res = &tsched->params.edf.res;
+
+	if ( !res->wcet )
+		return;
+
+	list_remove ( &ksched->params.edf.admitted, 0, &res->list );
+	ksched->params.edf.utilization -= res->util;
+	res->wcet = 0;
+}
+
 /*! Check if task hasn't overrun its deadline */
 static int edf_check_deadline ( kthread_t *kthread )
 {
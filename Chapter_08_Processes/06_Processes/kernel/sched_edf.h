@@ -3,6 +3,21 @@
 
 #include "thread.h"
 #include "time.h"
+#include <lib/heap.h>
+
+/*! Processor time reserved for thread at admission (times in microseconds) */
+typedef struct _edf_reservation_t_
+{
+	uint32  wcet;
+		/* execution time per period (0 - thread has no reservation) */
+	uint32  deadline;
+	uint32  period;
+	uint32  util;
+		/* wcet / period, in EDF_UTIL_SCALE units (rounded up) */
+	list_h  list;
+		/* in list of admitted threads (if wcet > 0) */
+}
+edf_reservation_t;
 
 /*! Per thread scheduler data */
 typedef struct _ksched_edf_thread_params_t
@@ -13,9 +28,35 @@ typedef struct _ksched_edf_thread_params_t
 	timespec_t  active_deadline;
 	int         flags;
 
+	timespec_t  inherited_deadline;
+	int         inherited;
+		    /* deadline inherited from threads blocked on owned mutex
+		     * (if 'inherited' is set; used if earlier than own) */
+
 	void       *period_alarm;
 		    /* kernel alarm reference used in EDF */
 	void       *deadline_alarm;
+
+	heap_h      ready_h;
+		    /* element in EDF ready heap (index -1 if not there) */
+
+	edf_reservation_t  res;
+			   /* reservation made at admission */
+
+	/* statistics (printed with "sysinfo threads") */
+	uint        jobs;
+		    /* completed jobs (periods) */
+	uint        misses;
+		    /* jobs that missed their deadline */
+	timespec_t  max_lateness;
+		    /* maximal completion time after deadline */
+	timespec_t  response;
+	timespec_t  max_response;
+		    /* last and maximal response time (release - completion) */
+	int         in_job;
+		    /* job is released (edf_wait was called) */
+	int         missed;
+		    /* current job is already counted as missed */
 }
 ksched_edf_thread_params_t;
 
@@ -24,11 +65,23 @@ typedef struct _ksched_edf_t_
 {
 	kthread_t  *active; /* thread selected by EDF as top priority */
 
-	kthread_q   ready;
-	kthread_q   wait;
+	heap_t      ready;  /* ready threads, earliest deadline on top */
+	kthread_q   wait;   /* threads waiting for next period */
+
+	list_t      admitted;
+		    /* reservations of admitted threads */
+	uint32      utilization;
+		    /* sum of their utilizations (EDF_UTIL_SCALE == 100%) */
 }
 ksched_edf_t;
 
+#define EDF_READY_INIT	32	/* initial ready heap size (doubled if full) */
+
+#define EDF_UTIL_SCALE	1000000	/* utilization 1 (in parts per million) */
+#define EDF_MAX_SEC	4000	/* times must be shorter (in seconds), so
+				 * they fit in 32 bits in microseconds */
+#define EDF_DBF_POINTS	4096	/* max. deadlines checked in demand test */
+
 #define EDF_DEBUG	0	/* print extensive debug informations? */
 
 #if EDF_DEBUG == 1
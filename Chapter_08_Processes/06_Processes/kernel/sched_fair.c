@@ -0,0 +1,562 @@
+/*! Fair (virtual runtime) Scheduler
+ *
+ * Threads share processor in proportion to their weights (nice values).
+ * Each thread has virtual runtime: its execution time scaled with
+ * FAIR_NICE_0_WEIGHT / weight, so heavier threads' vruntime grows slower.
+ * Thread with smallest vruntime is selected:
+ * - only one fair thread ("active") is in master ready queue; others are
+ *   waiting in red-black tree ordered by vruntime (as EDF keeps its threads
+ *   in heap)
+ * - active thread runs for slice: its weighted part of 'latency', but not
+ *   less than 'min_granularity'; then thread with smallest vruntime replaces
+ *   it, if it has smaller vruntime
+ * - woken thread keeps its vruntime, but not less than min_vruntime - half
+ *   of latency: thread that often blocks so keeps its share (it preempts
+ *   active thread if its vruntime is smaller by at least min_granularity),
+ *   but can not save processor time while sleeping
+ */
+#define _K_SCHED_FAIR_C_
+#define _K_SCHED_
+
+#include "sched.h"
+#include "time.h"
+#include <kernel/errno.h>
+#include <kernel/kprint.h>
+#include <types/basic.h>
+#include <types/bits.h>
+
+static int fair_init ( ksched_t *ksched );
+static int fair_schedule ( ksched_t *ksched );
+static int fair_thread_admit ( ksched_t *ksched, kthread_t *kthread,
+			       sched_supp_t *sched_param );
+static int fair_thread_add ( ksched_t *ksched, kthread_t *kthread,
+			     int sched_priority, sched_supp_t *sched_param );
+static int fair_thread_remove ( ksched_t *ksched, kthread_t *kthread );
+static int fair_thread_activate ( ksched_t *ksched, kthread_t *kthread );
+static int fair_thread_deactivate ( ksched_t *ksched, kthread_t *kthread );
+static int fair_thread_wakeup ( ksched_t *ksched, kthread_t *kthread );
+static int fair_set_thread_sched_parameters ( ksched_t *ksched,
+					      kthread_t *kthread,
+					      sched_supp_t *sched_param );
+static void fair_thread_info ( ksched_t *ksched, kthread_t *kthread );
+static int fair_info ( ksched_t *ksched, char *buffer, size_t buf_size );
+
+static void fair_select ( ksched_t *ksched, int wakeup );
+static void fair_enqueue ( ksched_t *ksched, kthread_t *kthread );
+static void fair_runnable ( ksched_t *ksched, kthread_t *kthread, int ready );
+static void fair_account ( ksched_t *ksched, kthread_t *kthread );
+static void fair_update_min ( ksched_t *ksched );
+static void fair_set_nice ( kthread_t *kthread, int nice );
+static int fair_cmp ( void *a, void *b );
+static void fair_slice_alarm ( sigval_t sigev_value );
+
+/*! statically defined Fair Scheduler */
+ksched_t ksched_fair = (ksched_t)
+{
+	.sched_id =			SCHED_FAIR,
+
+	.init =				fair_init,
+	.schedule =			fair_schedule,
+	.thread_admit =			fair_thread_admit,
+	.thread_add =			fair_thread_add,
+	.thread_remove =		fair_thread_remove,
+	.thread_activate =		fair_thread_activate,
+	.thread_deactivate =		fair_thread_deactivate,
+	.thread_wakeup =		fair_thread_wakeup,
+	.set_thread_sched_parameters =	fair_set_thread_sched_parameters,
+	.get_thread_sched_parameters =	NULL,
+	.thread_inherit =		NULL,
+	.thread_info =			fair_thread_info,
+	.info =				fair_info,
+
+	.params.fair.latency =		{ 0, 40000000 },
+	.params.fair.min_granularity =	{ 0, 10000000 }
+};
+
+/*!
+ * Weights for nice values FAIR_NICE_MIN .. FAIR_NICE_MAX: thread with nice
+ * one lower gets about 25% more than thread with nice one higher (so 10%
+ * more of processor than before, when two such threads compete)
+ */
+static const uint fair_weight[FAIR_NICE_MAX - FAIR_NICE_MIN + 1] = {
+	88761, 71755, 56483, 46273, 36291,	/* -20 .. -16 */
+	29154, 23254, 18705, 14949, 11916,	/* -15 .. -11 */
+	 9548,  7620,  6100,  4904,  3906,	/* -10 .. -6 */
+	 3121,  2501,  1991,  1586,  1277,	/* -5 .. -1 */
+	 1024,   820,   655,   526,   423,	/* 0 .. 4 */
+	  335,   272,   215,   172,   137,	/* 5 .. 9 */
+	  110,    87,    70,    56,    45,	/* 10 .. 14 */
+	   36,    29,    23,    18,    15	/* 15 .. 19 */
+};
+
+/*! time in microseconds */
+#define FAIR_USEC(T)	( (uint64) (T)->tv_sec * 1000000 + (T)->tv_nsec / 1000 )
+
+/*! time in milliseconds (for printing) */
+#define FAIR_MSEC(T)	( (uint) (T)->tv_sec * 1000 + (T)->tv_nsec / 1000000 )
+
+/*! Fair scheduler data in thread descriptor */
+static inline ksched_fair_thread_params_t *fair_params ( kthread_t *kthread )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+
+	return &tsched->params.fair;
+}
+
+/*! Initialize fair scheduler (create slice timer) */
+static int fair_init ( ksched_t *ksched )
+{
+	ksched_fair_t *fair = &ksched->params.fair;
+	sigevent_t evp;
+
+	fair->active = NULL;
+	rbtree_init ( &fair->tree, fair_cmp );
+	TIME_RESET ( &fair->min_vruntime );
+	fair->load = 0;
+	fair->runnable = 0;
+
+	evp.sigev_notify = SIGEV_THREAD;
+	evp.sigev_notify_function = fair_slice_alarm;
+	evp.sigev_notify_attributes = NULL;
+	evp.sigev_value.sival_ptr = ksched;
+
+	ktimer_create ( CLOCK_REALTIME, &evp, &fair->ktimer, NULL );
+	TIME_RESET ( &fair->alarm.it_interval );
+	TIME_RESET ( &fair->alarm.it_value );
+
+	return 0;
+}
+
+/*! Select thread with smallest vruntime and reschedule */
+static int fair_schedule ( ksched_t *ksched )
+{
+	fair_select ( ksched, FALSE );
+
+	kthreads_schedule ();
+
+	return 0;
+}
+
+/*! Only nice value is checked: fair scheduler accepts any number of threads */
+static int fair_thread_admit ( ksched_t *ksched, kthread_t *kthread,
+			       sched_supp_t *sched_param )
+{
+	if ( sched_param && ( sched_param->fair.nice < FAIR_NICE_MIN ||
+			      sched_param->fair.nice > FAIR_NICE_MAX ) )
+		return EINVAL;
+
+	return 0;
+}
+
+/*! Add thread to fair scheduler: it starts with smallest vruntime */
+static int fair_thread_add ( ksched_t *ksched, kthread_t *kthread,
+			     int sched_priority, sched_supp_t *sched_param )
+{
+	ksched_fair_thread_params_t *tfair = fair_params ( kthread );
+
+	fair_set_nice ( kthread, sched_param ? sched_param->fair.nice : 0 );
+
+	tfair->vruntime = ksched->params.fair.min_vruntime;
+	kclock_gettime ( CLOCK_REALTIME, &tfair->start );
+	tfair->queued = FALSE;
+	tfair->runnable = FALSE;
+	TIME_RESET ( &tfair->runtime );
+	tfair->preempted = 0;
+
+	/* blocked thread is added to tree when woken */
+	if ( kthread_is_ready ( kthread ) )
+	{
+		fair_runnable ( ksched, kthread, TRUE );
+		fair_enqueue ( ksched, kthread );
+		fair_select ( ksched, TRUE );
+	}
+
+	return 0;
+}
+
+/*! Remove thread from fair scheduler (it continues in ready queue if ready) */
+static int fair_thread_remove ( ksched_t *ksched, kthread_t *kthread )
+{
+	ksched_fair_thread_params_t *tfair = fair_params ( kthread );
+	ksched_fair_t *fair = &ksched->params.fair;
+
+	if ( kthread == fair->active )
+	{
+		if ( kthread_is_active ( kthread ) )
+		{
+			/* disarm timer */
+			TIME_RESET ( &fair->alarm.it_value );
+			ktimer_settime ( fair->ktimer, 0, &fair->alarm, NULL );
+		}
+		fair->active = NULL;
+	}
+
+	if ( tfair->queued )
+	{
+		rbtree_remove ( &fair->tree, &tfair->node );
+		tfair->queued = FALSE;
+
+		/* ready (not blocked): return it to master ready queue
+		 * (marked ready first, so this scheduler doesn't take it) */
+		if ( kthread_is_alive ( kthread ) )
+		{
+			kthread_mark_ready ( kthread );
+			kthread_move_to_ready ( kthread, LAST );
+		}
+	}
+
+	fair_runnable ( ksched, kthread, FALSE );
+
+	/* some other fair thread should be in ready queue */
+	fair_select ( ksched, FALSE );
+
+	return 0;
+}
+
+/*! Thread is to become active: set alarm for end of its slice */
+static int fair_thread_activate ( ksched_t *ksched, kthread_t *kthread )
+{
+	ksched_fair_thread_params_t *tfair = fair_params ( kthread );
+	ksched_fair_t *fair = &ksched->params.fair;
+	uint32 slice;
+	timespec_t t;
+
+	kclock_gettime ( CLOCK_REALTIME, &tfair->start );
+
+	/* weighted part of latency: latency * weight / load */
+	slice = (uint32) FAIR_USEC ( &fair->latency );
+	if ( fair->load > tfair->weight )
+		slice = mul_div_32 ( slice, tfair->weight, fair->load );
+	if ( slice < FAIR_USEC ( &fair->min_granularity ) )
+		slice = (uint32) FAIR_USEC ( &fair->min_granularity );
+
+	t.tv_sec = slice / 1000000;
+	t.tv_nsec = ( slice % 1000000 ) * 1000;
+
+	fair->alarm.it_value = tfair->start;
+	time_add ( &fair->alarm.it_value, &t );
+
+	ktimer_settime ( fair->ktimer, TIMER_ABSTIME, &fair->alarm, NULL );
+
+	return 0;
+}
+
+/*!
+ * Deactivate thread because:
+ * 1. higher priority thread preempts it
+ * 2. its slice is over (from fair_slice_alarm) or woken thread preempts it
+ *    (from fair_select)
+ * 3. this thread blocks on some queue
+ */
+static int fair_thread_deactivate ( ksched_t *ksched, kthread_t *kthread )
+{
+	ksched_fair_t *fair = &ksched->params.fair;
+
+	TIME_RESET ( &fair->alarm.it_value );
+	ktimer_settime ( fair->ktimer, 0, &fair->alarm, NULL );
+
+	fair_account ( ksched, kthread );
+
+	if ( !kthread_is_ready ( kthread ) )
+	{
+		/* blocked: thread with smallest vruntime goes to ready queue
+		 * (kthreads_schedule, that called us, will pick it) */
+		if ( kthread == fair->active )
+			fair->active = NULL;
+		fair_runnable ( ksched, kthread, FALSE );
+		fair_select ( ksched, FALSE );
+	}
+
+	return 0;
+}
+
+/*! Woken thread is put in tree, not directly in ready queue */
+static int fair_thread_wakeup ( ksched_t *ksched, kthread_t *kthread )
+{
+	ksched_fair_thread_params_t *tfair = fair_params ( kthread );
+	ksched_fair_t *fair = &ksched->params.fair;
+	timespec_t min, half;
+
+	/* thread selected by fair_select goes to ready queue */
+	if ( kthread == fair->active )
+		return FALSE;
+
+	/* already in tree */
+	if ( tfair->queued )
+		return TRUE;
+
+	if ( !tfair->runnable )
+	{
+		/* sleeper credit is limited to half of latency */
+		half.tv_sec = fair->latency.tv_sec / 2;
+		half.tv_nsec = ( fair->latency.tv_sec % 2 ) * 500000000L +
+			       fair->latency.tv_nsec / 2;
+
+		min = fair->min_vruntime;
+		if ( time_cmp ( &min, &half ) > 0 )
+		{
+			time_sub ( &min, &half );
+			if ( time_cmp ( &tfair->vruntime, &min ) < 0 )
+				tfair->vruntime = min;
+		}
+
+		fair_runnable ( ksched, kthread, TRUE );
+	}
+
+	fair_enqueue ( ksched, kthread );
+	fair_select ( ksched, TRUE );
+
+	return TRUE;
+}
+
+/*! Change nice value (already checked with fair_thread_admit) */
+static int fair_set_thread_sched_parameters ( ksched_t *ksched,
+					      kthread_t *kthread,
+					      sched_supp_t *sched_param )
+{
+	ksched_fair_thread_params_t *tfair = fair_params ( kthread );
+	int runnable = tfair->runnable;
+
+	/* execution so far is accounted with old weight */
+	fair_account ( ksched, kthread );
+
+	if ( runnable )
+		fair_runnable ( ksched, kthread, FALSE );
+
+	fair_set_nice ( kthread, sched_param->fair.nice );
+
+	if ( runnable )
+		fair_runnable ( ksched, kthread, TRUE );
+
+	return 0;
+}
+
+/*! Print fair scheduler state for thread */
+static void fair_thread_info ( ksched_t *ksched, kthread_t *kthread )
+{
+	ksched_fair_thread_params_t *tfair = fair_params ( kthread );
+
+	kprintf ( "\tFAIR: nice=%d, weight=%d, vruntime=%d ms, runtime=%d ms\n",
+		  tfair->nice, tfair->weight, FAIR_MSEC ( &tfair->vruntime ),
+		  FAIR_MSEC ( &tfair->runtime ) );
+	kprintf ( "\tFAIR: gave processor to other fair thread %d times\n",
+		  tfair->preempted );
+}
+
+/*! Describe fair scheduler state ("sysinfo sched") */
+static int fair_info ( ksched_t *ksched, char *buffer, size_t buf_size )
+{
+	ksched_fair_t *fair = &ksched->params.fair;
+
+	ksprintf ( buffer, buf_size,
+		   "FAIR: runnable threads=%d, load=%u, min_vruntime=%u ms\n",
+		   fair->runnable, fair->load,
+		   FAIR_MSEC ( &fair->min_vruntime ) );
+
+	return 0;
+}
+
+/*!
+ * Select active fair thread (smallest vruntime) and put it in ready queue;
+ * others are kept in tree (caller should call kthreads_schedule)
+ * \param ksched Fair scheduler
+ * \param wakeup Thread is woken (or added): replace active thread only if
+ *               vruntime of first one is smaller by min_granularity
+ */
+static void fair_select ( ksched_t *ksched, int wakeup )
+{
+	ksched_fair_t *fair = &ksched->params.fair;
+	kthread_t *first, *active = fair->active;
+	ksched_fair_thread_params_t *tfirst;
+	timespec_t vruntime;
+
+	if ( active && !kthread_is_ready ( active ) )
+	{
+		fair_runnable ( ksched, active, FALSE );
+		fair->active = active = NULL;
+	}
+
+	first = rbtree_get ( &fair->tree );
+	if ( !first )
+		return;
+
+	tfirst = fair_params ( first );
+
+	if ( active )
+	{
+		/* vruntime of active thread, including current execution */
+		fair_account ( ksched, active );
+
+		vruntime = tfirst->vruntime;
+		if ( wakeup )
+			time_add ( &vruntime, &fair->min_granularity );
+
+		if ( time_cmp ( &vruntime, &fair_params ( active )->vruntime )
+		     >= 0 )
+			return;
+
+		/* move active thread to tree (if running, deactivate it so
+		 * its slice timer is disarmed) */
+		if ( kthread_is_active ( active ) )
+			ksched2_deactivate_thread ( active );
+		fair_params ( active )->preempted++;
+		fair->active = NULL;
+		fair_enqueue ( ksched, active );
+
+		first = rbtree_get ( &fair->tree );
+		tfirst = fair_params ( first );
+	}
+
+	rbtree_remove ( &fair->tree, &tfirst->node );
+	tfirst->queued = FALSE;
+
+	fair->active = first;
+	fair_update_min ( ksched );
+
+	kthread_move_to_ready ( first, LAST );
+}
+
+/*!
+ * Put thread in tree of runnable threads
+ * Thread is waiting (not in master scheduler ready list) until selected.
+ */
+static void fair_enqueue ( ksched_t *ksched, kthread_t *kthread )
+{
+	ksched_fair_thread_params_t *tfair = fair_params ( kthread );
+
+	if ( tfair->queued )
+		return;
+
+#ifdef LATENCY_TRACE
+	/* woken thread (not preempted one): latency is measured from now */
+	if ( !kthread_is_ready ( kthread ) )
+		klatency_wakeup ( kthread );
+#endif
+	if ( kthread_is_ready ( kthread ) && !kthread_is_active ( kthread ) )
+		kthread_remove_from_ready ( kthread );
+	kthread_mark_waiting ( kthread );
+
+	rbtree_insert ( &ksched->params.fair.tree, kthread, &tfair->node );
+	tfair->queued = TRUE;
+
+	fair_update_min ( ksched );
+}
+
+/*! Count thread in scheduler load (ready) or remove it (blocked, removed) */
+static void fair_runnable ( ksched_t *ksched, kthread_t *kthread, int ready )
+{
+	ksched_fair_thread_params_t *tfair = fair_params ( kthread );
+	ksched_fair_t *fair = &ksched->params.fair;
+
+	if ( tfair->runnable == ready )
+		return;
+
+	tfair->runnable = ready;
+
+	if ( ready )
+	{
+		fair->load += tfair->weight;
+		fair->runnable++;
+	}
+	else {
+		fair->load -= tfair->weight;
+		fair->runnable--;
+	}
+}
+
+/*! Add execution since last accounting to thread vruntime (if activated) */
+static void fair_account ( ksched_t *ksched, kthread_t *kthread )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	ksched_fair_thread_params_t *tfair = &tsched->params.fair;
+	timespec_t now, used;
+	uint64 delta;
+	uint32 vdelta;
+
+	if ( !tsched->activated )
+		return;
+
+	kclock_gettime ( CLOCK_REALTIME, &now );
+	used = now;
+	time_sub ( &used, &tfair->start );
+	tfair->start = now;
+	time_add ( &tfair->runtime, &used );
+
+	delta = FAIR_USEC ( &used );
+	if ( delta > FAIR_MAX_DELTA )
+		delta = FAIR_MAX_DELTA;
+
+	/* vruntime += delta * FAIR_NICE_0_WEIGHT / weight */
+	vdelta = (uint32) delta;
+	if ( tfair->weight != FAIR_NICE_0_WEIGHT )
+		vdelta = mul_div_32 ( vdelta, FAIR_NICE_0_WEIGHT,
+				      tfair->weight );
+
+	used.tv_sec = vdelta / 1000000;
+	used.tv_nsec = ( vdelta % 1000000 ) * 1000;
+	time_add ( &tfair->vruntime, &used );
+
+	fair_update_min ( ksched );
+}
+
+/*! min_vruntime follows smallest vruntime of runnable threads (only grows) */
+static void fair_update_min ( ksched_t *ksched )
+{
+	ksched_fair_t *fair = &ksched->params.fair;
+	kthread_t *first = rbtree_get ( &fair->tree );
+	timespec_t *min = NULL;
+
+	if ( fair->active )
+		min = &fair_params ( fair->active )->vruntime;
+
+	if ( first && ( !min ||
+	     time_cmp ( &fair_params ( first )->vruntime, min ) < 0 ) )
+		min = &fair_params ( first )->vruntime;
+
+	if ( min && time_cmp ( min, &fair->min_vruntime ) > 0 )
+		fair->min_vruntime = *min;
+}
+
+/*! Set nice value and weight for thread (nice is limited to valid range) */
+static void fair_set_nice ( kthread_t *kthread, int nice )
+{
+	ksched_fair_thread_params_t *tfair = fair_params ( kthread );
+
+	if ( nice < FAIR_NICE_MIN )
+		nice = FAIR_NICE_MIN;
+	if ( nice > FAIR_NICE_MAX )
+		nice = FAIR_NICE_MAX;
+
+	tfair->nice = nice;
+	tfair->weight = fair_weight[nice - FAIR_NICE_MIN];
+}
+
+/*! Compare threads by vruntime (for tree) */
+static int fair_cmp ( void *a, void *b )
+{
+	return time_cmp ( &fair_params ( a )->vruntime,
+			  &fair_params ( b )->vruntime );
+}
+
+/*! Timer interrupt: slice of active fair thread is over */
+static void fair_slice_alarm ( sigval_t sigev_value )
+{
+	ksched_t *ksched = sigev_value.sival_ptr;
+	kthread_t *kthread = kthread_get_active ();
+
+	if ( ksched != ksched2_get ( kthread_get_sched_policy (kthread) ) )
+	{
+		LOG ( DEBUG, "Fair slice alarm for non fair thread!" );
+		return;
+	}
+
+	/* account execution, give processor to thread with smaller vruntime */
+	ksched2_deactivate_thread ( kthread );
+	fair_select ( ksched, FALSE );
+
+	/* still active: new slice */
+	if ( kthread_is_active ( kthread ) )
+		ksched2_activate_thread ( kthread );
+
+	kthreads_schedule ();
+}
@@ -0,0 +1,74 @@
+/*! Fair (virtual runtime) scheduler */
+#pragma once
+
+#include "time.h"
+#include <lib/rbtree.h>
+
+/*! Per thread scheduler data */
+typedef struct _ksched_fair_thread_params_t_
+{
+	timespec_t  vruntime;
+		    /* virtual runtime: execution time scaled with
+		     * FAIR_NICE_0_WEIGHT / weight */
+	int         nice;
+	uint        weight;
+		    /* nice value and its weight (from fair_weight table) */
+
+	timespec_t  start;
+		    /* when execution was last accounted (if activated) */
+
+	rbtree_h    node;
+		    /* element in tree of runnable threads (if 'queued') */
+	int         queued;
+		    /* waiting in tree (not in master ready queue) */
+	int         runnable;
+		    /* is ready (counted in scheduler load) */
+
+	/* statistics (printed with "sysinfo threads") */
+	timespec_t  runtime;
+		    /* processor time used under this scheduler */
+	uint        preempted;
+		    /* how many times it gave processor to other fair thread */
+}
+ksched_fair_thread_params_t;
+
+/*! Fair scheduler global parameters */
+typedef struct _ksched_fair_t_
+{
+	kthread_t    *active;
+		      /* fair thread in ready queue (running if it has highest
+		       * priority); other runnable fair threads are in tree */
+
+	rbtree_t      tree;
+		      /* runnable fair threads, ordered by vruntime */
+
+	timespec_t    min_vruntime;
+		      /* (monotonic) smallest vruntime of runnable threads;
+		       * new and woken threads are placed relative to it */
+
+	uint          load;
+	uint          runnable;
+		      /* sum of weights and number of runnable threads */
+
+	timespec_t    latency;
+		      /* period in which each runnable thread should run once
+		       * (slice is its weighted part of it) */
+
+	timespec_t    min_granularity;
+		      /* minimal slice; also vruntime advantage woken thread
+		       * must have to preempt active one (bounds switch rate) */
+
+	ktimer_t     *ktimer;
+		      /* slice timer (only one fair thread is active) */
+
+	itimerspec_t  alarm;
+		      /* alarm parameters */
+}
+ksched_fair_t;
+
+/*! weight of thread with nice value 0 */
+#define FAIR_NICE_0_WEIGHT	1024
+
+/*! longest execution accounted at once, in microseconds (to fit in 32 bits
+ * when scaled with weights) */
+#define FAIR_MAX_DELTA		60000000
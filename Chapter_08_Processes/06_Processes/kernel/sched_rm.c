@@ -0,0 +1,344 @@
+/*! Rate Monotonic (RM) Scheduler
+ *
+ * RM threads are scheduled by master (priority) scheduler only: this
+ * scheduler assigns their priorities, in rate monotonic order (shorter
+ * period - higher priority), whenever thread is added, removed or changes
+ * its period. Dispatching so costs the same as for SCHED_FIFO threads.
+ *
+ * Thread is admitted only if response time analysis shows that each thread
+ * (with new one) completes its execution (wcet) before end of its period:
+ *   R = C(i) + sum ( ceil ( R / T(j) ) * C(j) ), for j with priority >= i
+ * is iterated from R = C(i) until it converges (R is worst case response
+ * time) or R exceeds period T(i) (thread is not schedulable).
+ * Threads with same priority (same period, or not enough priorities in
+ * range) are counted as interfering with each other (pessimistic).
+ */
+#define _K_SCHED_RM_C_
+#define _K_SCHED_
+
+#include "sched.h"
+#include "pthread.h"
+#include <kernel/errno.h>
+#include <kernel/kprint.h>
+#include <types/basic.h>
+#include <types/bits.h>
+#include <types/pthread.h>
+
+static int rm_init ( ksched_t *ksched );
+static int rm_thread_admit ( ksched_t *ksched, kthread_t *kthread,
+			     sched_supp_t *sched_param );
+static int rm_thread_add ( ksched_t *ksched, kthread_t *kthread,
+			   int sched_priority, sched_supp_t *sched_param );
+static int rm_thread_remove ( ksched_t *ksched, kthread_t *kthread );
+static int rm_set_thread_sched_parameters ( ksched_t *ksched,
+					    kthread_t *kthread,
+					    sched_supp_t *sched_param );
+static void rm_thread_info ( ksched_t *ksched, kthread_t *kthread );
+static int rm_info ( ksched_t *ksched, char *buffer, size_t buf_size );
+
+static int rm_task_params ( sched_supp_t *sched_param, rm_task_t *task );
+static int rm_analysis ( ksched_t *ksched, list_t *tasks );
+static int rm_response ( list_t *tasks, rm_task_t *task );
+static void rm_assign ( ksched_t *ksched );
+static int rm_cmp ( void *a, void *b );
+
+/*! statically defined Rate Monotonic Scheduler */
+ksched_t ksched_rm = (ksched_t)
+{
+	.sched_id =			SCHED_RM,
+
+	.init =				rm_init,
+	.schedule =			NULL,
+	.thread_admit =			rm_thread_admit,
+	.thread_add =			rm_thread_add,
+	.thread_remove =		rm_thread_remove,
+	.thread_activate =		NULL,
+	.thread_deactivate =		NULL,
+	.thread_wakeup =		NULL,
+	.set_thread_sched_parameters =	rm_set_thread_sched_parameters,
+	.get_thread_sched_parameters =	NULL,
+	.thread_inherit =		NULL,
+	.thread_info =			rm_thread_info,
+	.info =				rm_info,
+
+	.params.rm.prio_high =		THREAD_MAX_PRIO - 1,
+	.params.rm.prio_low =		THREAD_DEF_PRIO + 1
+};
+
+/*! Initialize RM scheduler */
+static int rm_init ( ksched_t *ksched )
+{
+	list_init ( &ksched->params.rm.tasks );
+
+	return 0;
+}
+
+/*!
+ * Admission control: are all RM threads schedulable with given one?
+ * (if thread is already RM thread, its old parameters are replaced)
+ */
+static int rm_thread_admit ( ksched_t *ksched, kthread_t *kthread,
+			     sched_supp_t *sched_param )
+{
+	list_t *tasks = &ksched->params.rm.tasks;
+	kthread_sched2_t *tsched;
+	rm_task_t task, *own = NULL;
+	int retval;
+
+	if ( kthread && kthread_get_sched_policy ( kthread ) == SCHED_RM )
+	{
+		if ( !sched_param ) /* no change */
+			return 0;
+
+		tsched = kthread_get_sched2_param ( kthread );
+		own = &tsched->params.rm.task;
+	}
+
+	if ( !sched_param )
+		return EINVAL;
+
+	retval = rm_task_params ( sched_param, &task );
+	if ( retval )
+		return retval;
+	task.kthread = NULL;
+
+	/* test task set with new parameters instead of old ones */
+	if ( own )
+		list_remove ( tasks, 0, &own->list );
+	list_sort_add ( tasks, &task, &task.list, rm_cmp );
+
+	retval = rm_analysis ( ksched, tasks );
+
+	list_remove ( tasks, 0, &task.list );
+	if ( own )
+		list_sort_add ( tasks, own, &own->list, rm_cmp );
+
+	/* restore priorities and response times of admitted threads */
+	rm_analysis ( ksched, tasks );
+
+	return retval;
+}
+
+/*! Add thread to RM: assign priorities to all RM threads */
+static int rm_thread_add ( ksched_t *ksched, kthread_t *kthread,
+			   int sched_priority, sched_supp_t *sched_param )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	rm_task_t *task = &tsched->params.rm.task;
+
+	/* without (valid) parameters: lowest RM priority, not analyzed */
+	if ( !sched_param || rm_task_params ( sched_param, task ) )
+	{
+		task->period = (uint32) -1;
+		task->wcet = 0;
+	}
+	task->kthread = kthread;
+
+	list_sort_add ( &ksched->params.rm.tasks, task, &task->list, rm_cmp );
+	rm_assign ( ksched );
+
+	return 0;
+}
+
+/*! Remove thread from RM (its priority is not changed) */
+static int rm_thread_remove ( ksched_t *ksched, kthread_t *kthread )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	rm_task_t *task = &tsched->params.rm.task;
+
+	list_remove ( &ksched->params.rm.tasks, 0, &task->list );
+	task->kthread = NULL;
+
+	rm_assign ( ksched );
+
+	return 0;
+}
+
+/*! Change period and wcet (already checked with rm_thread_admit) */
+static int rm_set_thread_sched_parameters ( ksched_t *ksched,
+					    kthread_t *kthread,
+					    sched_supp_t *sched_param )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	rm_task_t *task = &tsched->params.rm.task;
+	list_t *tasks = &ksched->params.rm.tasks;
+
+	list_remove ( tasks, 0, &task->list );
+	if ( rm_task_params ( sched_param, task ) )
+	{
+		task->period = (uint32) -1;
+		task->wcet = 0;
+	}
+	list_sort_add ( tasks, task, &task->list, rm_cmp );
+
+	rm_assign ( ksched );
+
+	return 0;
+}
+
+/*! Print RM parameters for thread */
+static void rm_thread_info ( ksched_t *ksched, kthread_t *kthread )
+{
+	kthread_sched2_t *tsched = kthread_get_sched2_param ( kthread );
+	rm_task_t *task = &tsched->params.rm.task;
+
+	kprintf ( "\tRM: period=%u us, wcet=%u us, priority=%d, "
+		  "response time <= %u us\n", task->period, task->wcet,
+		  task->prio, task->response );
+}
+
+/*! Describe RM scheduler state ("sysinfo sched") */
+static int rm_info ( ksched_t *ksched, char *buffer, size_t buf_size )
+{
+	rm_task_t *task;
+	uint32 util = 0;
+	int cnt = 0;
+
+	task = list_get ( &ksched->params.rm.tasks, FIRST );
+	for ( ; task; task = list_get_next ( &task->list ) )
+	{
+		cnt++;
+		if ( task->wcet )
+			util += mul_div_32 ( task->wcet, RM_UTIL_SCALE,
+					     task->period );
+	}
+
+	ksprintf ( buffer, buf_size,
+		   "RM: threads=%d, utilization=%u/%u, priorities %d-%d\n",
+		   cnt, util, RM_UTIL_SCALE, ksched->params.rm.prio_low,
+		   ksched->params.rm.prio_high );
+
+	return 0;
+}
+
+/*! Convert time to microseconds (rounded up) */
+static int rm_usec ( timespec_t *t, uint32 *usec )
+{
+	if ( t->tv_sec < 0 || t->tv_sec >= RM_MAX_SEC ||
+	     t->tv_nsec < 0 || t->tv_nsec >= 1000000000 )
+		return EINVAL;
+
+	*usec = (uint32) t->tv_sec * 1000000 + ( t->tv_nsec + 999 ) / 1000;
+
+	return 0;
+}
+
+/*! Get task parameters from thread parameters: 0 < wcet <= period */
+static int rm_task_params ( sched_supp_t *sched_param, rm_task_t *task )
+{
+	if ( rm_usec ( &sched_param->rm.period, &task->period ) ||
+	     rm_usec ( &sched_param->rm.wcet, &task->wcet ) ||
+	     !task->wcet || task->wcet > task->period )
+		return EINVAL;
+
+	return 0;
+}
+
+/*!
+ * Assign priorities in rate monotonic order and calculate response times
+ * \param ksched RM scheduler
+ * \param tasks List of tasks sorted by period
+ * \return 0 if all tasks are schedulable, EAGAIN otherwise
+ */
+static int rm_analysis ( ksched_t *ksched, list_t *tasks )
+{
+	rm_task_t *task, *prev = NULL;
+	int prio = ksched->params.rm.prio_high;
+	int retval = 0;
+
+	task = list_get ( tasks, FIRST );
+	for ( ; task; prev = task, task = list_get_next ( &task->list ) )
+	{
+		if ( prev && task->period != prev->period &&
+		     prio > ksched->params.rm.prio_low )
+			prio--;
+		task->prio = prio;
+	}
+
+	task = list_get ( tasks, FIRST );
+	for ( ; task; task = list_get_next ( &task->list ) )
+		if ( task->wcet && !rm_response ( tasks, task ) )
+			retval = EAGAIN;
+
+	return retval;
+}
+
+/*!
+ * Response time analysis for one task (priorities must be assigned)
+ * \return TRUE if task completes before end of its period
+ */
+static int rm_response ( list_t *tasks, rm_task_t *task )
+{
+	rm_task_t *other;
+	uint64 r, next;
+	uint32 jobs;
+	uint i;
+
+	task->response = 0;
+	r = task->wcet;
+
+	for ( i = 0; i < RM_RTA_ITER; i++ )
+	{
+		/* task execution and execution of all jobs of higher (or
+		 * same) priority tasks released in [0, r) */
+		next = task->wcet;
+
+		other = list_get ( tasks, FIRST );
+		for ( ; other; other = list_get_next ( &other->list ) )
+		{
+			if ( other == task || other->prio < task->prio )
+				continue;
+
+			/* r <= period < 2^32 */
+			jobs = (uint32) r / other->period +
+			       ( (uint32) r % other->period != 0 );
+			next += (uint64) jobs * other->wcet;
+		}
+
+		if ( next > task->period )
+			return FALSE;
+
+		if ( next == r )
+		{
+			task->response = (uint32) r;
+			return TRUE;
+		}
+
+		r = next;
+	}
+
+	return FALSE; /* not converged: rejected */
+}
+
+/*! Set priorities of RM threads (after thread is added, changed, removed) */
+static void rm_assign ( ksched_t *ksched )
+{
+	rm_task_t *task;
+	kthread_pi_t *pi;
+	int prio;
+
+	rm_analysis ( ksched, &ksched->params.rm.tasks );
+
+	task = list_get ( &ksched->params.rm.tasks, FIRST );
+	for ( ; task; task = list_get_next ( &task->list ) )
+	{
+		pi = kthread_get_pi_param ( task->kthread );
+		if ( pi->base_prio == task->prio )
+			continue;
+
+		/* new priority is base one; owned mutexes might raise it */
+		pi->base_prio = task->prio;
+		prio = kpthread_mutex_prio ( task->kthread );
+
+		if ( kthread_get_prio ( task->kthread ) != prio )
+			kthread_set_prio ( task->kthread, prio );
+	}
+}
+
+/*! Compare tasks by period (for sorted list) */
+static int rm_cmp ( void *a, void *b )
+{
+	rm_task_t *ta = a, *tb = b;
+
+	return ( ta->period > tb->period ) - ( ta->period < tb->period );
+}
@@ -0,0 +1,49 @@
+/*! Rate Monotonic scheduler */
+#pragma once
+
+#include "thread.h"
+#include <lib/list.h>
+
+/*! Periodic task (times in microseconds) */
+typedef struct _rm_task_t_
+{
+	kthread_t  *kthread;
+		    /* thread (NULL for candidate in admission test) */
+	uint32      period;
+	uint32      wcet;
+		    /* execution time per period (0 - not analyzed) */
+	int         prio;
+		    /* priority by rate monotonic order (from rm_analysis) */
+	uint32      response;
+		    /* worst case response time (from rm_analysis) */
+	list_h      list;
+		    /* in list of RM tasks, sorted by period */
+}
+rm_task_t;
+
+/*! Per thread scheduler data */
+typedef struct _ksched_rm_thread_params_t_
+{
+	rm_task_t  task;
+}
+ksched_rm_thread_params_t;
+
+/*! Rate Monotonic global parameters */
+typedef struct _ksched_rm_t_
+{
+	list_t  tasks;
+		/* RM threads, sorted by period (shortest first) */
+
+	int     prio_high;
+	int     prio_low;
+		/* priority range for RM threads: shortest period gets
+		 * 'prio_high', each longer one priority less (tasks that do
+		 * not fit in range share 'prio_low') */
+}
+ksched_rm_t;
+
+#define RM_UTIL_SCALE	1000000	/* utilization 1 (in parts per million) */
+#define RM_MAX_SEC	4000	/* times must be shorter (in seconds), so
+				 * they fit in 32 bits in microseconds */
+#define RM_RTA_ITER	4096	/* max. iterations in response time analysis
+				 * (task is rejected if not converged) */
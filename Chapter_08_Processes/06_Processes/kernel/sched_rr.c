@@ -22,13 +22,18 @@ ksched_t ksched_rr = (ksched_t)
 
 	.init = 		rr_init,
 	.schedule = 		NULL,
+	.thread_admit =		NULL,
 	.thread_add =		rr_thread_add,
 	.thread_remove =	rr_thread_del,
 	.thread_activate =	rr_thread_activate,
 	.thread_deactivate =	rr_thread_deactivate,
+	.thread_wakeup =	NULL,
 
 	.set_thread_sched_parameters =	NULL,
 	.get_thread_sched_parameters =	NULL,
+	.thread_inherit =		NULL,
+	.thread_info =			NULL,
+	.info =				NULL,
 
 	.params.rr.time_slice =	{ 0, 50000000 },
 	.params.rr.threshold =	{ 0, 10000000 }
@@ -11,6 +11,15 @@
 #include <kernel/syscall.h>
 
 static int ksignal_received_signal ( kthread_t *kthread, void *param );
+static int ksigev_notify ( ksigev_notify_t *notify, kprocess_t *proc );
+
+static kmem_cache_t *ksig_cache; /* pending signals (ksiginfo_t) */
+
+/*! Initialize signal subsystem (called from 'kthreads_init') */
+void ksignal_init ()
+{
+	ksig_cache = kmem_cache_create ( "ksiginfo_t", sizeof (ksiginfo_t) );
+}
 
 /*! Initialize thread signal handling data */
 int ksignal_thread_init ( kthread_t *kthread )
@@ -25,6 +34,8 @@ int ksignal_thread_init ( kthread_t *kthread )
 
 	list_init ( &sh->pending_signals );
 
+	sh->sigev_worker = FALSE;
+
 	return EXIT_SUCCESS;
 }
 
@@ -135,7 +146,7 @@ int ksignal_queue ( kthread_t *kthread, siginfo_t *sig )
 
 		/* copy sig to user space */
 		proc = kthread_get_process ( kthread );
-		us = ffs_alloc(proc->stack_pool, sizeof (siginfo_t));
+		us = sfs_alloc(proc->stack_pool, sizeof (siginfo_t));
 		ASSERT (us);
 		/*if ( !us )
 			return ENOMEM;*/
@@ -167,12 +178,13 @@ int ksignal_queue ( kthread_t *kthread, siginfo_t *sig )
 		sigaddset ( sh->mask, sig->si_signo );
 
 		/* add signal to list of pending signals */
-		ksig = kmalloc ( sizeof (ksiginfo_t) );
+		ksig = kmem_cache_alloc ( ksig_cache );
 		ksig->siginfo = *sig;
 
 		list_append ( &sh->pending_signals, ksig, &ksig->list );
 		/* list_sort_add ( &sh->pending_signals, ksig, &ksig->list,
 				ksignal_compare ); */
+		kthreads_need_signal_check ();
 		retval = EAGAIN;
 	}
 
@@ -203,7 +215,7 @@ int ksignal_process_pending ( kthread_t *kthread )
 			retval = ksignal_queue ( kthread, &ksig->siginfo );
 
 			list_remove ( &sh->pending_signals, 0, &ksig->list );
-			kfree ( ksig );
+			kmem_cache_free ( ksig_cache, ksig );
 
 			/* handle only first signal?
 				* no, all of them - they will mask ... */
@@ -287,8 +299,16 @@ static int ksignal_received_signal ( kthread_t *kthread, void *param )
 	}
 }
 
-/*! Process event defined with sigevent_t */
-int ksignal_process_event ( sigevent_t *evp, kthread_t *kthread, int code )
+/*!
+ * Process event defined with sigevent_t
+ * \param evp Event definition
+ * \param kthread Thread that defined event (owner)
+ * \param code Signal code (e.g. SI_TIMER)
+ * \param notify Notification state (required for SIGEV_THREAD)
+ * \return 0 if event is processed and rescheduling may be required
+ */
+int ksignal_process_event ( sigevent_t *evp, kthread_t *kthread, int code,
+			    ksigev_notify_t *notify )
 {
 	int retval = EXIT_SUCCESS;
 	kthread_t *target = kthread;
@@ -310,10 +330,9 @@ int ksignal_process_event ( sigevent_t *evp, kthread_t *kthread, int code )
 
 	case SIGEV_THREAD_ID:
 		pid = evp->sigev_notify_thread_id;
-		target = pid.ptr;
+		target = kthread_get_descriptor ( &pid );
 
-		if ( !target || !kthread_is_alive (target) ||
-			pid.id != kthread_get_id (target) )
+		if ( !target || !kthread_is_alive (target) )
 			return ESRCH;
 
 	case SIGEV_SIGNAL:
@@ -321,26 +340,18 @@ int ksignal_process_event ( sigevent_t *evp, kthread_t *kthread, int code )
 		sig.si_value = evp->sigev_value;
 		sig.si_code = code;
 		sig.si_errno = 0;
-		sig.si_pid.id = kthread_get_id ( kthread );
-		sig.si_pid.ptr = kthread;
+		kthread_set_descriptor ( kthread, &sig.si_pid );
 
 		retval = ksignal_queue ( target, &sig );
 
 		break;
 
 	case SIGEV_THREAD:
-		if ( evp->sigev_notify_function )
-		{
-			if ( !kthread_create (	evp->sigev_notify_function,
-						evp->sigev_value.sival_ptr, 0,
-						SCHED_FIFO, THREAD_DEF_PRIO,
-						NULL, NULL, 0,
-						kthread_get_process(kthread) ) )
-				retval = EINVAL;
-		}
-		else {
+		if ( evp->sigev_notify_function && notify )
+			retval = ksigev_notify ( notify,
+					kthread_get_process (kthread) );
+		else
 			retval = EINVAL;
-		}
 		break;
 
 	default:
@@ -352,6 +363,259 @@ int ksignal_process_event ( sigevent_t *evp, kthread_t *kthread, int code )
 }
 
 
+/*! SIGEV_THREAD notifications --------------------------------------------- */
+
+/*! Initialize notification state for event source */
+void ksigev_notify_init ( ksigev_notify_t *notify, sigevent_t *evp )
+{
+	ASSERT ( notify && evp );
+
+	notify->evp = evp;
+	notify->pending = FALSE;
+	notify->overrun = 0;
+	notify->overrun_last = 0;
+	notify->pool = NULL;
+}
+
+/*! Remove pending notification (event source is deleted) */
+void ksigev_notify_cancel ( ksigev_notify_t *notify )
+{
+	ASSERT ( notify );
+
+	if ( notify->pending )
+	{
+		list_remove ( &notify->pool->pending, 0, &notify->list );
+		notify->pending = FALSE;
+	}
+}
+
+/*! Pass notification to worker (blocked in sys__sigev_wait) */
+static void ksigev_deliver ( ksigev_notify_t *notify, kthread_t *worker,
+			     kprocess_t *proc )
+{
+	void *p, (**func) ( sigval_t );
+	sigval_t *value;
+
+	p = arch_syscall_get_params ( kthread_get_context ( worker ) );
+	func = U2K_GET_ADR ( *( (void **) p ), proc );
+	p += sizeof (void *);
+	value = U2K_GET_ADR ( *( (sigval_t **) p ), proc );
+
+	*func = notify->evp->sigev_notify_function;
+	*value = notify->evp->sigev_value;
+
+	notify->overrun_last = notify->overrun;
+	notify->overrun = 0;
+
+	kthread_set_errno ( worker, EXIT_SUCCESS );
+	kthread_set_syscall_retval ( worker, EXIT_SUCCESS );
+	kthread_move_to_ready ( worker, LAST );
+}
+
+/*!
+ * Event occurred: give notification to idle worker or put it in queue
+ * \return 0 if worker is released, EAGAIN if notification is queued or lost
+ */
+static int ksigev_notify ( ksigev_notify_t *notify, kprocess_t *proc )
+{
+	ksigev_pool_t *pool = proc->sigev_pool;
+	kthread_t *worker;
+
+	if ( !pool || pool->closed )
+		return ESRCH;
+
+	if ( notify->pending )
+	{
+		/* previous notification still waits for worker */
+		notify->overrun++;
+		return EAGAIN;
+	}
+
+	worker = kthreadq_remove ( &pool->idle, NULL );
+	if ( worker )
+	{
+		ksigev_deliver ( notify, worker, proc );
+		return EXIT_SUCCESS;
+	}
+
+	/* all workers are busy */
+	notify->pending = TRUE;
+	notify->pool = pool;
+	list_append ( &pool->pending, notify, &notify->list );
+
+	return EAGAIN;
+}
+
+/*!
+ * Create pool of notification threads for process or add threads to it
+ * \param proc Process
+ * \param attr Attributes from sigev_notify_attributes (kernel address or NULL);
+ *             sigev_threads defines pool size
+ * \return 0 if successful, error number otherwise
+ */
+int ksigev_pool_setup ( kprocess_t *proc, pthread_attr_t *attr )
+{
+	ksigev_pool_t *pool = proc->sigev_pool;
+	uint threads = SIGEV_POOL_DEFAULT;
+	kthread_t *worker;
+	ksignal_handling_t *sh;
+	ksigev_notify_t *notify;
+
+	if ( attr && attr->sigev_threads )
+		threads = attr->sigev_threads;
+
+	if ( !pool )
+	{
+		pool = kmalloc ( sizeof (ksigev_pool_t) );
+		if ( !pool )
+			return ENOMEM;
+
+		pool->threads = 0;
+		pool->sched_policy = SCHED_FIFO;
+		pool->sched_priority = THREAD_DEF_PRIO;
+		pool->stacksize = 0;
+		if ( attr )
+		{
+			/* workers are not periodic (EDF) threads */
+			if ( attr->sched_policy == SCHED_RR )
+				pool->sched_policy = SCHED_RR;
+			if ( attr->sched_params.sched_priority >=
+				THREAD_MIN_PRIO &&
+			     attr->sched_params.sched_priority <=
+				THREAD_MAX_PRIO )
+				pool->sched_priority =
+					attr->sched_params.sched_priority;
+			pool->stacksize = attr->stacksize;
+		}
+		kthreadq_init ( &pool->idle );
+		list_init ( &pool->pending );
+		pool->closed = FALSE;
+
+		proc->sigev_pool = pool;
+	}
+
+	/* pool only grows, up to largest requested size */
+	while ( pool->threads < threads )
+	{
+		worker = kthread_create ( proc->pi->sigev_worker, NULL, 0,
+					  pool->sched_policy,
+					  pool->sched_priority, NULL, NULL,
+					  pool->stacksize, proc );
+		if ( !worker )
+		{
+			if ( pool->threads )
+				return EXIT_SUCCESS;
+
+			/* no workers: drop pool (attr is used on next try) */
+			while ( (notify = list_remove (&pool->pending, FIRST,
+						       NULL)) )
+				notify->pending = FALSE;
+
+			proc->sigev_pool = NULL;
+			kfree ( pool );
+
+			return ENOMEM;
+		}
+
+		sh = kthread_get_sigparams ( worker );
+		sh->sigev_worker = TRUE;
+		pool->threads++;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/*!
+ * Thread is terminating: update pool; when only workers remain in process
+ * release them (process ends when they exit)
+ */
+void ksignal_thread_exit ( kthread_t *kthread )
+{
+	ksignal_handling_t *sh = kthread_get_sigparams ( kthread );
+	kprocess_t *proc = kthread_get_process ( kthread );
+	ksigev_pool_t *pool = proc->sigev_pool;
+	ksigev_notify_t *notify;
+	kthread_t *worker;
+
+	if ( !pool )
+		return;
+
+	if ( sh->sigev_worker )
+		pool->threads--;
+
+	if ( proc->thread_count == pool->threads && !pool->closed )
+	{
+		pool->closed = TRUE;
+
+		while ( (notify = list_remove (&pool->pending, FIRST, NULL)) )
+			notify->pending = FALSE;
+
+		while ( ( worker = kthreadq_remove ( &pool->idle, NULL ) ) )
+		{
+			kthread_set_errno ( worker, ESRCH );
+			kthread_set_syscall_retval ( worker, EXIT_FAILURE );
+			kthread_move_to_ready ( worker, LAST );
+		}
+	}
+
+	if ( !proc->thread_count )
+	{
+		proc->sigev_pool = NULL;
+		kfree ( pool );
+	}
+}
+
+/*!
+ * Wait for notification (called from SIGEV_THREAD worker loop)
+ * \param func Where to store notification function
+ * \param value Where to store its parameter
+ * \return 0 when notification is received, -1 when worker should exit
+ */
+int sys__sigev_wait ( void *p )
+{
+	void (**func) ( sigval_t );
+	sigval_t *value;
+
+	kprocess_t *proc = kthread_get_process (NULL);
+	ksignal_handling_t *sh = kthread_get_sigparams (NULL);
+	ksigev_pool_t *pool = proc->sigev_pool;
+	ksigev_notify_t *notify;
+
+	func =	*( (void **) p );	p += sizeof (void *);
+	value =	*( (sigval_t **) p );
+
+	ASSERT_ERRNO_AND_EXIT ( func && value, EINVAL );
+	func = U2K_GET_ADR ( func, proc );
+	value = U2K_GET_ADR ( value, proc );
+
+	/* only pool threads may wait for notifications */
+	if ( !pool || !sh->sigev_worker )
+		EXIT ( EINVAL );
+
+	if ( pool->closed )
+		EXIT ( ESRCH );
+
+	notify = list_remove ( &pool->pending, FIRST, NULL );
+	if ( notify )
+	{
+		notify->pending = FALSE;
+
+		*func = notify->evp->sigev_notify_function;
+		*value = notify->evp->sigev_value;
+
+		notify->overrun_last = notify->overrun;
+		notify->overrun = 0;
+
+		EXIT ( EXIT_SUCCESS );
+	}
+
+	SET_ERRNO ( EXIT_SUCCESS );
+	kthread_enqueue ( NULL, &pool->idle );
+	kthreads_schedule ();
+
+	return EXIT_SUCCESS;
+}
+
 /*! Interface to threads ---------------------------------------------------- */
 
 /*!
@@ -378,14 +642,11 @@ int sys__sigqueue ( void *p )
 	ASSERT_ERRNO_AND_EXIT ( signo > 0 && signo <= SIGMAX, EINVAL );
 
 	thread = (pthread_t) pid; /* pid_t should be pthread_t */
-	ASSERT_ERRNO_AND_EXIT ( thread.ptr, EINVAL );
 
-	kthread = thread.ptr;
-	ASSERT_ERRNO_AND_EXIT ( kthread_get_id (kthread) == thread.id, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( kthread_check_kthread ( kthread ), EINVAL );
+	kthread = kthread_get_descriptor ( &thread );
+	ASSERT_ERRNO_AND_EXIT ( kthread, EINVAL );
 
-	sender.id = kthread_get_id (NULL);
-	sender.ptr = kthread_get_active ();
+	kthread_set_descriptor ( NULL, &sender );
 
 	sig.si_signo = signo;
 	sig.si_value = sigval;
@@ -551,7 +812,7 @@ int sys__sigwaitinfo ( void *p )
 				*info = ksig->siginfo;
 
 			list_remove ( &sh->pending_signals, 0, &ksig->list );
-			kfree ( ksig );
+			kmem_cache_free ( ksig_cache, ksig );
 
 			EXIT2 ( EXIT_SUCCESS, retval );
 		}
@@ -6,14 +6,45 @@
 
 struct _ksignal_handling_t_;
 typedef struct _ksignal_handling_t_ ksignal_handling_t;
+struct _ksigev_pool_t_;
+typedef struct _ksigev_pool_t_ ksigev_pool_t;
 
 #include "thread.h"
 
+/*! SIGEV_THREAD notification state (part of object that generates events) */
+typedef struct _ksigev_notify_t_
+{
+	sigevent_t     *evp;
+			/* notification function and its parameter */
+
+	int		pending;
+			/* waiting in pool queue for free worker thread */
+
+	uint		overrun;
+			/* events lost while notification was pending */
+
+	uint		overrun_last;
+			/* events lost before last delivered notification */
+
+	ksigev_pool_t  *pool;
+			/* pool in which notification is pending */
+
+	list_h		list;
+}
+ksigev_notify_t;
+
 /*! interface to kernel */
+void ksignal_init ();
 int ksignal_thread_init ( kthread_t *kthread );
+void ksignal_thread_exit ( kthread_t *kthread );
 int ksignal_queue ( kthread_t *receiver, siginfo_t *sig );
 int ksignal_process_pending ( kthread_t *kthread );
-int ksignal_process_event ( sigevent_t *evp, kthread_t *kthread, int code );
+int ksignal_process_event ( sigevent_t *evp, kthread_t *kthread, int code,
+			    ksigev_notify_t *notify );
+
+void ksigev_notify_init ( ksigev_notify_t *notify, sigevent_t *evp );
+void ksigev_notify_cancel ( ksigev_notify_t *notify );
+int ksigev_pool_setup ( kprocess_t *proc, pthread_attr_t *attr );
 
 struct _ksignal_handling_t_
 {
@@ -23,8 +54,40 @@ struct _ksignal_handling_t_
 
 	list_t	     pending_signals;
 		     /* siginfo_t elements */
+
+	int	     sigev_worker;
+		     /* thread is in SIGEV_THREAD pool of its process */
 };
 
+/*!
+ * Pool of threads for SIGEV_THREAD notifications (one per process)
+ * Workers are created when pool is set up (with timer_create); each waits
+ * (in sigev_worker, api/signal.c) for notification and calls its function.
+ * If all workers are busy, notification waits in queue; further events from
+ * same source are counted as overruns (for timer_getoverrun).
+ */
+struct _ksigev_pool_t_
+{
+	uint	    threads;
+		    /* worker threads in pool */
+
+	int	    sched_policy;
+	int	    sched_priority;
+	size_t	    stacksize;
+		    /* worker thread attributes */
+
+	kthread_q   idle;
+		    /* workers waiting for notification */
+
+	list_t	    pending;
+		    /* notifications waiting for worker (ksigev_notify_t) */
+
+	int	    closed;
+		    /* only workers remained in process; they are terminating */
+};
+
+#define SIGEV_POOL_DEFAULT	2	/* workers, if not set in attr. */
+
 #ifdef	_K_SIGNAL_C_
 /*! rest of the file is only for 'kernel/signal.c' -------------------------- */
 
@@ -35,6 +35,7 @@ static int (*k_sysfunc[SYSFUNCS]) ( void *params ) =
 	sys__timer_delete,
 	sys__timer_settime,
 	sys__timer_gettime,
+	sys__timer_getoverrun,
 
 	sys__open,
 	sys__close,
@@ -49,6 +50,9 @@ static int (*k_sysfunc[SYSFUNCS]) ( void *params ) =
 
 	sys__pthread_setschedparam,
 
+	sys__futex_wait,
+	sys__futex_wake,
+
 	sys__pthread_mutex_init,
 	sys__pthread_mutex_destroy,
 	sys__pthread_mutex_lock,
@@ -73,6 +77,7 @@ static int (*k_sysfunc[SYSFUNCS]) ( void *params ) =
 	sys__pthread_sigmask,
 	sys__sigqueue,
 	sys__sigwaitinfo,
+	sys__sigev_wait,
 
 	sys__posix_spawn
 };
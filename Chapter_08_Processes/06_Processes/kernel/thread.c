@@ -6,6 +6,7 @@
 #include "memory.h"
 #include "device.h"
 #include "sched.h"
+#include "pthread.h"
 #include <arch/processor.h>
 #include <arch/interrupt.h>
 #include <arch/syscall.h>
@@ -15,9 +16,13 @@
 #include <kernel/errno.h>
 
 static list_t all_threads; /* all threads */
+static khandles_t thread_handles; /* all threads, by user descriptors */
 
 static kthread_t *active_thread = NULL; /* active thread */
 
+static kmem_cache_t *kthread_cache; /* thread descriptors */
+static kmem_cache_t *kstate_cache; /* saved thread states */
+
 kprocess_t kernel_proc; /* kernel process (currently only for idle thread) */
 static list_t procs; /* list of all processes */
 
@@ -30,8 +35,15 @@ static void idle_thread ( void *param );
 void kthreads_init ()
 {
 	list_init ( &all_threads );
+	khandles_init ( &thread_handles );
 	list_init ( &procs );
 
+	kthread_cache = kmem_cache_create ( "kthread_t", sizeof (kthread_t) );
+	kstate_cache = kmem_cache_create ( "kthread_state_t",
+					   sizeof (kthread_state_t) );
+	ksignal_init ();
+	kpthread_init ();
+
 	active_thread = NULL;
 	ksched_init ();
 
@@ -40,6 +52,10 @@ void kthreads_init ()
 	kernel_proc.stack_pool = NULL; /* use kernel pool */
 	kernel_proc.m.start = NULL;
 	kernel_proc.m.size = (size_t) 0xffffffff;
+	list_init ( &kernel_proc.kobjects );
+	khandles_init ( &kernel_proc.handles );
+	kernel_proc.sigev_pool = NULL;
+	TIME_RESET ( &kernel_proc.cputime );
 
 	(void) kthread_create ( idle_thread, NULL, 0, SCHED_FIFO, 0, NULL,
 				NULL, 0, &kernel_proc );
@@ -63,7 +79,7 @@ kthread_t *kthread_start_process ( char *prog_name, void *param, int prio )
 	kprocess_t *proc;
 	kthread_t *kthread;
 	char **args = NULL, *arg, *karg, **kargs;
-	size_t argsize;
+	size_t argsize, stack_class[3];
 	int i;
 
 	prog = list_get ( &progs, FIRST );
@@ -99,7 +115,11 @@ kthread_t *kthread_start_process ( char *prog_name, void *param, int prio )
 	proc->m.start = proc->pi;
 
 	/* initialize memory pool for threads stacks */
-	proc->stack_pool = ffs_init ( proc->pi->stack, prog->pi->stack_size );
+	stack_class[0] = prog->pi->thread_stack;
+	stack_class[1] = HANDLER_STACK_SIZE;
+	stack_class[2] = sizeof (siginfo_t);
+	proc->stack_pool = sfs_init ( proc->pi->stack, prog->pi->stack_size,
+				      stack_class, 3 );
 
 	/* set addresses in process header to relative addresses */
 	proc->pi->heap = (void *) prog->m->size;
@@ -114,6 +134,9 @@ kthread_t *kthread_start_process ( char *prog_name, void *param, int prio )
 		prio = THR_DEFAULT_PRIO;
 
 	list_init ( &proc->kobjects );
+	khandles_init ( &proc->handles );
+	proc->sigev_pool = NULL;
+	TIME_RESET ( &proc->cputime );
 
 	if ( param ) /* have arguments? */
 	{
@@ -125,7 +148,7 @@ kthread_t *kthread_start_process ( char *prog_name, void *param, int prio )
 			  - (size_t) param;
 		if ( argsize > 0 )
 		{
-			args = ffs_alloc ( proc->stack_pool, argsize );
+			args = sfs_alloc ( proc->stack_pool, argsize );
 			arg = (void *) args + (i + 1) * sizeof (void *);
 			kargs = param;
 			i = 0;
@@ -172,7 +195,7 @@ kthread_t *kthread_create ( void *start_routine, void *arg, uint flags,
 	kthread_t *kthread;
 
 	/* thread descriptor */
-	kthread = kmalloc ( sizeof (kthread_t) );
+	kthread = kmem_cache_alloc ( kthread_cache );
 	ASSERT ( kthread );
 
 	/* initialize thread descriptor */
@@ -184,6 +207,9 @@ kthread_t *kthread_create ( void *start_routine, void *arg, uint flags,
 	kthread->queue = NULL;
 	kthreadq_init ( &kthread->join_queue );
 
+	/* not ready until added to ready queue (and to its scheduler) */
+	kthread->state.state = THR_STATE_PASSIVE;
+
 	kthread_create_new_state ( kthread, start_routine, arg,
 				   stackaddr, stacksize, FALSE );
 	kthread->state.flags = flags;
@@ -195,6 +221,7 @@ kthread_t *kthread_create ( void *start_routine, void *arg, uint flags,
 	ksignal_thread_init ( kthread );
 
 	list_append ( &all_threads, kthread, &kthread->all );
+	kthread->handle = khandle_alloc ( &thread_handles, kthread );
 
 	kthread->sched_policy = sched_policy;
 	if ( sched_priority < 0 )
@@ -203,6 +230,29 @@ kthread_t *kthread_create ( void *start_routine, void *arg, uint flags,
 		sched_priority = PRIO_LEVELS - 1;
 	kthread->sched_priority = sched_priority;
 
+	kthread->pi.base_prio = sched_priority;
+	kthread->pi.blocked_on = NULL;
+	list_init ( &kthread->pi.held );
+
+	TIME_RESET ( &kthread->cpu.time );
+	kthread->cpu.running = FALSE;
+	kthread->cpu.switches = kthread->cpu.preempted = 0;
+#ifdef LATENCY_TRACE
+	kthread->latency.waiting = FALSE;
+	kthread->latency.preempted = FALSE;
+#endif
+
+	/* timer slack is inherited from creating thread */
+	if ( active_thread )
+	{
+		kthread->timer_slack = active_thread->timer_slack;
+	}
+	else {
+		kthread->timer_slack.tv_sec = 0;
+		kthread->timer_slack.tv_nsec = TIMER_SLACK_DEFAULT * 1000;
+	}
+	kthread->sleep_timer = kclock_sleep_timer_create ( kthread );
+
 	kthread->ref_cnt = 1;
 	kthread_move_to_ready ( kthread, LAST );
 
@@ -224,7 +274,7 @@ void kthread_create_new_state ( kthread_t *kthread,
 	/* save old state if requested (put it at beginning of state list) */
 	if ( save_old_state )
 	{
-		kthread_state_t *state = kmalloc ( sizeof (kthread_state_t) );
+		kthread_state_t *state = kmem_cache_alloc ( kstate_cache );
 		*state = kthread->state;
 		list_prepend ( &kthread->states, state, &state->list );
 	}
@@ -240,7 +290,7 @@ void kthread_create_new_state ( kthread_t *kthread,
 		/* use process stack heap */
 		if ( !stack_size )
 			stack_size = proc->pi->thread_stack;
-		stack = ffs_alloc ( proc->stack_pool, stack_size );
+		stack = sfs_alloc ( proc->stack_pool, stack_size );
 	}
 	else {
 		/* use kernel heap */
@@ -268,6 +318,9 @@ void kthread_create_new_state ( kthread_t *kthread,
 	arch_create_thread_context ( &kthread->state.context, start_func, param,
 				     proc->pi->exit, stack, stack_size, proc );
 
+	/* new context (if thread is active, it must be selected again) */
+	kthreads_need_resched ();
+
 	*kthread->state.errno = 0;
 	kthread->state.exit_status = NULL;
 	kthread->state.pparam = NULL;
@@ -293,7 +346,7 @@ int kthread_restore_state ( kthread_t *kthread )
 	if ( kthread->state.stack )
 	{
 		if ( kthread->proc->stack_pool ) /* user level thread */
-			ffs_free ( kthread->proc->stack_pool,
+			sfs_free ( kthread->proc->stack_pool,
 				   kthread->state.stack );
 		else /* kernel level thread */
 			kfree ( kthread->state.stack );
@@ -305,9 +358,16 @@ int kthread_restore_state ( kthread_t *kthread )
 	state = list_remove ( &kthread->states, FIRST, NULL );
 	if ( state )
 	{
+		/* release arch resources of current context (e.g. FPU area) */
+		arch_destroy_thread_context ( &kthread->state.context );
+
 		kthread->state = *state;
-		kfree ( state );
+		kmem_cache_free ( kstate_cache, state );
 		retval = TRUE;
+
+		/* restored context and signal mask */
+		kthreads_need_resched ();
+		kthreads_need_signal_check ();
 	}
 
 	return retval;
@@ -353,7 +413,7 @@ void kthread_add_cleanup ( kthread_t *kthread, void *cleanup_function,
 /*! kfree for cleanup */
 void kthread_param_free ( param_t p1, param_t p2, param_t p3 )
 {
-	ffs_free ( p1.p_ptr, p2.p_ptr );
+	sfs_free ( p1.p_ptr, p2.p_ptr );
 }
 
 /*!
@@ -397,9 +457,14 @@ int kthread_exit ( kthread_t *kthread, void *exit_status, int force )
 	}
 	else if ( kthread->state.state == THR_STATE_WAIT )
 	{
-		/* remove target 'thread' from its queue */
-		if ( !kthreadq_remove ( kthread->queue, kthread ) )
+		/* remove target 'thread' from its queue (if not in queue,
+		 * its scheduler keeps it: removed with scheduler below) */
+		if ( kthread->queue &&
+		     !kthreadq_remove ( kthread->queue, kthread ) )
 			ASSERT ( FALSE );
+
+		/* owners of mutex it was blocked on drop inherited priority */
+		kpthread_mutex_waiter_exit ( kthread );
 	}
 	else if ( kthread->state.state == THR_STATE_SUSPENDED )
 	{
@@ -418,10 +483,18 @@ int kthread_exit ( kthread_t *kthread, void *exit_status, int force )
 	}
 
 	kthread->state.state = THR_STATE_PASSIVE;
+
+	/* last processor time (while process still exists) */
+	kthread_cpu_stop ( kthread, NULL );
+	ktimer_cpu_release ( kthread );
+
 	kthread->ref_cnt--;
 	kthread->state.exit_status = exit_status;
 	kthread->proc->thread_count--;
 
+	/* SIGEV_THREAD workers (release them if only they remain) */
+	ksignal_thread_exit ( kthread );
+
 	/* remove it from its scheduler */
 	ksched2_thread_remove ( kthread );
 
@@ -433,6 +506,7 @@ int kthread_exit ( kthread_t *kthread, void *exit_status, int force )
 	{
 		/* last (non-kernel) thread - remove process */
 
+		ktimer_cpu_release ( kthread->proc );
 		kfree_process_kobjects ( kthread->proc );
 
 		kfree ( kthread->proc->pi );
@@ -476,16 +550,21 @@ static void kthread_remove_descriptor ( kthread_t *kthread )
 {
 	ASSERT ( kthread );
 
+	ktimer_delete ( kthread->sleep_timer );
+	kthread->sleep_timer = NULL;
+
 	k_free_id ( kthread->id );
 	kthread->id = 0;
 
+	khandle_free ( &thread_handles, kthread->handle );
+
 #ifdef DEBUG
 	ASSERT( kthread == list_find_and_remove (&all_threads, &kthread->all) );
 #else
 	(void) list_remove ( &all_threads, 0, &kthread->all );
 #endif
 
-	kfree ( kthread );
+	kmem_cache_free ( kthread_cache, kthread );
 }
 
 /*!
@@ -579,24 +658,117 @@ inline void kthreadq_init ( kthread_q *q )
 {
 	ASSERT ( q );
 	list_init ( &q->q );
+	q->flags = KTHREADQ_FIFO;
+	memset ( q->mask, 0, sizeof (q->mask) );
+}
+inline void kthreadq_init_prio ( kthread_q *q )
+{
+	kthreadq_init ( q );
+	q->flags = KTHREADQ_PRIO;
+}
+
+#define KTHREADQ_BIT(prio)	( ( (uint32) 1 ) << ( (prio) % 32 ) )
+
+/*! last thread of closest higher priority level present in queue (or NULL) */
+static kthread_t *kthreadq_prio_higher ( kthread_q *q, int prio )
+{
+	uint w = prio / 32;
+	uint32 higher;
+
+	/* levels above 'prio' in its word, then in following words */
+	higher = q->mask[w] & ~( ( KTHREADQ_BIT ( prio ) << 1 ) - 1 );
+
+	while ( !higher && ++w < KTHREADQ_WORDS )
+		higher = q->mask[w];
+
+	if ( !higher )
+		return NULL;
+
+	return q->last[ w * 32 + lsb_index ( higher ) ];
+}
+
+/*! insert thread in priority ordered queue: last (or first) of its priority */
+static void kthreadq_prio_insert ( kthread_q *q, kthread_t *kthread, int first )
+{
+	int prio = kthread->sched_priority;
+	uint32 *mask = &q->mask[ prio / 32 ];
+	kthread_t *after;
+
+	if ( ( *mask & KTHREADQ_BIT ( prio ) ) && !first )
+		after = q->last[prio];
+	else
+		after = kthreadq_prio_higher ( q, prio );
+
+	list_insert_after ( &q->q, kthread, &kthread->list,
+			    after ? &after->list : NULL );
+
+	if ( !( *mask & KTHREADQ_BIT ( prio ) ) || !first )
+	{
+		/* new last on its level */
+		q->last[prio] = kthread;
+		*mask |= KTHREADQ_BIT ( prio );
+	}
+
+	kthread->queue = q;
+}
+
+/*! remove thread from priority ordered queue (thread must be in queue) */
+static void kthreadq_prio_remove ( kthread_q *q, kthread_t *kthread )
+{
+	int prio = kthread->sched_priority;
+	kthread_t *prev;
+
+	if ( q->last[prio] == kthread )
+	{
+		prev = kthread->list.prev ? kthread->list.prev->object : NULL;
+
+		if ( prev && prev->sched_priority == prio )
+			q->last[prio] = prev;
+		else
+			q->mask[ prio / 32 ] &= ~KTHREADQ_BIT ( prio );
+	}
+
+	list_remove ( &q->q, 0, &kthread->list );
+	kthread->queue = NULL;
 }
+
 inline void kthreadq_append ( kthread_q *q, kthread_t *kthread )
 {
 	ASSERT ( kthread && q );
-	list_append ( &q->q, kthread, &kthread->list );
+	if ( q->flags & KTHREADQ_PRIO )
+		kthreadq_prio_insert ( q, kthread, FALSE );
+	else
+		list_append ( &q->q, kthread, &kthread->list );
 }
 inline void kthreadq_prepend ( kthread_q *q, kthread_t *kthread )
 {
 	ASSERT ( kthread && q );
-	list_prepend ( &q->q, kthread, &kthread->list );
+	if ( q->flags & KTHREADQ_PRIO )
+		kthreadq_prio_insert ( q, kthread, TRUE );
+	else
+		list_prepend ( &q->q, kthread, &kthread->list );
 }
 inline kthread_t *kthreadq_remove ( kthread_q *q, kthread_t *kthread )
 {
 	ASSERT ( q );
+
+	if ( !( q->flags & KTHREADQ_PRIO ) )
+	{
+		if ( kthread )
+			return list_find_and_remove ( &q->q, &kthread->list );
+		else
+			return list_remove ( &q->q, FIRST, NULL );
+	}
+
+	if ( !kthread )
+		kthread = list_get ( &q->q, FIRST );
+	else if ( kthread->queue != q )
+		kthread = NULL;
+
 	if ( kthread )
-		return list_find_and_remove ( &q->q, &kthread->list );
-	else
-		return list_remove ( &q->q, FIRST, NULL );
+		kthreadq_prio_remove ( q, kthread );
+
+	return kthread;
 }
 inline kthread_t *kthreadq_get ( kthread_q *q )
 {
@@ -628,6 +800,7 @@ inline int kthread_get_prio ( kthread_t *kthread )
 int kthread_set_prio ( kthread_t *kthread, int prio )
 {
 	kthread_t *kthr = kthread;
+	kthread_q *q;
 	int old_prio;
 
 	if ( !kthr )
@@ -655,8 +828,19 @@ int kthread_set_prio ( kthread_t *kthread, int prio )
 		kthreads_schedule ();
 		break;
 
-	case THR_STATE_WAIT: /* as now there is only FIFO queue */
-		kthr->sched_priority = prio;
+	case THR_STATE_WAIT:
+		/* if in priority ordered queue, move it to new place
+		 * (removing clears kthr->queue) */
+		q = kthr->queue;
+		if ( q && ( q->flags & KTHREADQ_PRIO ) &&
+		     kthreadq_remove ( q, kthr ) )
+		{
+			kthr->sched_priority = prio;
+			kthreadq_append ( q, kthr );
+		}
+		else {
+			kthr->sched_priority = prio;
+		}
 		break;
 
 	case THR_STATE_PASSIVE: /* report error or just change priority? */
@@ -710,10 +894,11 @@ inline int kthread_is_suspended (kthread_t *kthread, void **func, void **param)
 	return FALSE;
 }
 
-/*! check if thread descriptor is valid, i.e. is in all thread list */
+/*! check if thread descriptor is valid, i.e. is in thread handle table */
 inline int kthread_check_kthread ( kthread_t *kthread )
 {
-	return kthread && list_find ( &all_threads, &kthread->all );
+	return kthread &&
+		khandle_check ( &thread_handles, kthread->handle, kthread );
 }
 
 inline int kthread_get_id ( kthread_t *kthread )
@@ -745,16 +930,28 @@ inline void *kthread_get_process ( kthread_t *kthread )
 		return active_thread->proc;
 }
 
-/*! Get kernel thread descriptor from user thread descriptor */
+/*!
+ * Get kernel thread descriptor from user thread descriptor
+ * (returned thread can be passive - finished, but not yet joined)
+ * \return kernel thread descriptor, NULL if 'thread' is not valid
+ */
 inline kthread_t *kthread_get_descriptor ( pthread_t *thread )
 {
-	kthread_t *kthread;
-
-	if ( thread && (kthread = thread->ptr) && thread->id == kthread->id &&
-		kthread->state.state != THR_STATE_PASSIVE )
-		return kthread;
-	else
+	if ( !thread )
 		return NULL;
+
+	return khandle_get ( &thread_handles, thread->index, thread->gen );
+}
+
+/*! Set user thread descriptor to reference given kernel thread */
+inline void kthread_set_descriptor ( kthread_t *kthread, pthread_t *thread )
+{
+	if ( !kthread )
+		kthread = active_thread;
+
+	thread->id = kthread->id;
+	thread->index = kthread->handle;
+	thread->gen = thread_handles.h[kthread->handle].gen;
 }
 
 inline void *kthread_get_sched2_param ( kthread_t *kthread )
@@ -773,6 +970,40 @@ inline void *kthread_get_sigparams ( kthread_t *kthread )
 	return &kthread->sig_handling;
 }
 
+inline kthread_pi_t *kthread_get_pi_param ( kthread_t *kthread )
+{
+	if ( !kthread )
+		kthread = active_thread;
+	ASSERT ( kthread );
+	return &kthread->pi;
+}
+
+inline timespec_t *kthread_get_timer_slack ( kthread_t *kthread )
+{
+	if ( !kthread )
+		kthread = active_thread;
+	ASSERT ( kthread );
+	return &kthread->timer_slack;
+}
+
+inline ktimer_t *kthread_get_sleep_timer ( kthread_t *kthread )
+{
+	if ( !kthread )
+		kthread = active_thread;
+	ASSERT ( kthread );
+	return kthread->sleep_timer;
+}
+
+#ifdef LATENCY_TRACE
+inline void *kthread_get_latency_param ( kthread_t *kthread )
+{
+	if ( !kthread )
+		kthread = active_thread;
+	ASSERT ( kthread );
+	return &kthread->latency;
+}
+#endif
+
 inline void kthread_set_active ( kthread_t *kthread )
 {
 	ASSERT ( kthread );
@@ -785,6 +1016,13 @@ inline void kthread_mark_ready ( kthread_t *kthread )
 	ASSERT ( kthread );
 	kthread->state.state = THR_STATE_READY;
 }
+/*! thread waits, but not in thread queue (kept by secondary scheduler) */
+inline void kthread_mark_waiting ( kthread_t *kthread )
+{
+	ASSERT ( kthread );
+	kthread->state.state = THR_STATE_WAIT;
+	kthread->queue = NULL;
+}
 inline void kthread_set_queue ( kthread_t *kthread, kthread_q *queue )
 {
 	ASSERT ( kthread && queue );
@@ -847,6 +1085,7 @@ inline void kthread_set_syscall_retval ( kthread_t *kthread, int ret_val )
 int kthread_info ()
 {
 	kthread_t *kthread;
+	timespec_t t;
 	int i = 1;
 
 	kprintf ( "Threads info\n" );
@@ -870,12 +1109,124 @@ int kthread_info ()
 			 kthread->sched_priority, kthread->state.state,
 			 kthread->state.exit_status );
 
+		kthread_cputime ( kthread, &t );
+		kprintf ( "\tcpu time=%d ms, activated %u times (%u times "
+			  "preempted)\n", t.tv_sec * 1000 + t.tv_nsec / 1000000,
+			  kthread->cpu.switches, kthread->cpu.preempted );
+
+		ksched2_thread_info ( kthread );
+
 		kthread = list_get_next ( &kthread->all );
 	}
 
 	return 0;
 }
 
+/*! Processor time accounting --------------------------------------------- */
+
+/*!
+ * Thread becomes active: start measuring its processor time
+ * \param now Current time (NULL - read clock)
+ */
+void kthread_cpu_start ( kthread_t *kthread, timespec_t *now )
+{
+	ASSERT ( kthread );
+
+	if ( now )
+		kthread->cpu.start = *now;
+	else
+		kclock_gettime ( CLOCK_MONOTONIC, &kthread->cpu.start );
+
+	kthread->cpu.running = TRUE;
+	kthread->cpu.switches++;
+}
+
+/*!
+ * Thread stops being active: add time since activation to thread's and
+ * process's processor time
+ * \param now Current time (NULL - read clock)
+ */
+void kthread_cpu_stop ( kthread_t *kthread, timespec_t *now )
+{
+	timespec_t t;
+
+	ASSERT ( kthread );
+
+	if ( !kthread->cpu.running )
+		return;
+
+	if ( now )
+		t = *now;
+	else
+		kclock_gettime ( CLOCK_MONOTONIC, &t );
+
+	/* clock could be set back (clock_settime) */
+	if ( time_cmp ( &t, &kthread->cpu.start ) > 0 )
+	{
+		time_sub ( &t, &kthread->cpu.start );
+		time_add ( &kthread->cpu.time, &t );
+		time_add ( &kthread->proc->cputime, &t );
+	}
+
+	kthread->cpu.running = FALSE;
+
+	if ( kthread_is_active ( kthread ) )
+		kthread->cpu.preempted++;
+}
+
+/*! Is thread's processor time clock running (is thread active)? */
+inline int kthread_cpu_running ( kthread_t *kthread )
+{
+	if ( !kthread )
+		kthread = active_thread;
+
+	return kthread->cpu.running;
+}
+
+/*! Get processor time used by thread (NULL - active thread) */
+void kthread_cputime ( kthread_t *kthread, timespec_t *time )
+{
+	timespec_t now;
+
+	if ( !kthread )
+		kthread = active_thread;
+	ASSERT ( kthread && time );
+
+	*time = kthread->cpu.time;
+
+	if ( kthread->cpu.running )
+	{
+		kclock_gettime ( CLOCK_MONOTONIC, &now );
+		if ( time_cmp ( &now, &kthread->cpu.start ) > 0 )
+		{
+			time_sub ( &now, &kthread->cpu.start );
+			time_add ( time, &now );
+		}
+	}
+}
+
+/*! Get processor time used by all threads of process */
+void kprocess_cputime ( kprocess_t *proc, timespec_t *time )
+{
+	timespec_t now;
+
+	ASSERT ( proc && time );
+
+	*time = proc->cputime;
+
+	/* add time of its active thread, from its activation */
+	if ( active_thread && active_thread->proc == proc &&
+	     active_thread->cpu.running )
+	{
+		kclock_gettime ( CLOCK_MONOTONIC, &now );
+		if ( time_cmp ( &now, &active_thread->cpu.start ) > 0 )
+		{
+			time_sub ( &now, &active_thread->cpu.start );
+			time_add ( time, &now );
+		}
+	}
+}
+
 /*! Idle thread ------------------------------------------------------------- */
 #include <api/syscall.h>
 
@@ -889,7 +1240,7 @@ static void idle_thread ( void *param )
 /*! Change thread scheduling parameters ------------------------------------- */
 int kthread_setschedparam (kthread_t *kthread, int policy, sched_param_t *param)
 {
-	int sched_priority;
+	int sched_priority, retval;
 	sched_supp_t *supp;
 
 	ASSERT_ERRNO_AND_EXIT ( kthread, EINVAL );
@@ -905,15 +1256,24 @@ int kthread_setschedparam (kthread_t *kthread, int policy, sched_param_t *param)
 		if ( param->sched_priority )
 			sched_priority = param->sched_priority;
 		else
-			sched_priority = kthread->sched_priority;
+			sched_priority = kthread->pi.base_prio;
 
 		supp = &param->supp;
 	}
 	else {
-		sched_priority = kthread->sched_priority;
+		sched_priority = kthread->pi.base_prio;
 		supp = NULL;
 	}
 
+	/* scheduler might not accept thread with given parameters */
+	retval = ksched2_admit ( kthread, policy, supp );
+	if ( retval )
+		EXIT ( retval );
+
+	/* new priority is base one; owned mutexes might still raise it */
+	kthread->pi.base_prio = sched_priority;
+	sched_priority = kpthread_mutex_prio ( kthread );
+
 	/* change in priority? */
 	if ( kthread->sched_priority != sched_priority )
 		kthread_set_prio ( kthread, sched_priority );
@@ -17,6 +17,21 @@ typedef struct _kthread_t_ kthread_t;
 #include "sched.h"
 #include "signal.h"
 #include "time.h"
+#include "latency.h"
+
+/*! Thread data for mutex priority protocols (used by kernel/pthread.c) */
+typedef struct _kthread_pi_t_
+{
+	int	 base_prio;
+		 /* priority without boosts from owned mutexes */
+
+	void	*blocked_on;
+		 /* mutex with PTHREAD_PRIO_INHERIT thread is blocked on */
+
+	list_t	 held;
+		 /* owned mutexes with priority protocol (inherit or protect) */
+}
+kthread_pi_t;
 
 /*! Interface for kernel (this and other subsystems) ------------------------ */
 void kthreads_init ();
@@ -52,6 +67,7 @@ int kthreadq_release_all ( kthread_q *q_id );
 
 /*! Thread queue manipulation - basic operations */
 extern inline void kthreadq_init ( kthread_q *q );
+extern inline void kthreadq_init_prio ( kthread_q *q );
 extern inline void kthreadq_append ( kthread_q *q, kthread_t *kthread );
 extern inline void kthreadq_prepend ( kthread_q *q, kthread_t *kthread );
 extern inline kthread_t *kthreadq_remove ( kthread_q *q, kthread_t *kthread );
@@ -81,10 +97,21 @@ extern inline kthread_t *kthread_get_active ();
 extern inline void *kthread_get_context ( kthread_t *thread );
 extern inline void *kthread_get_process ( kthread_t *kthread );
 extern inline kthread_t *kthread_get_descriptor ( pthread_t *thr );
+extern inline void kthread_set_descriptor ( kthread_t *, pthread_t *thr );
 
 /*! Get scheduling and signal parts of thread descriptor */
 extern inline void *kthread_get_sched2_param ( kthread_t *kthread );
 extern inline void *kthread_get_sigparams ( kthread_t *kthread );
+extern inline kthread_pi_t *kthread_get_pi_param ( kthread_t *kthread );
+#ifdef LATENCY_TRACE
+extern inline void *kthread_get_latency_param ( kthread_t *kthread );
+#endif
+
+/*! default timer slack (for timers without own) */
+extern inline timespec_t *kthread_get_timer_slack ( kthread_t *kthread );
+
+/*! timer used for sleep operations */
+extern inline ktimer_t *kthread_get_sleep_timer ( kthread_t *kthread );
 
 /* save extra parameter when blocking thread */
 extern inline void kthread_set_private_param (kthread_t *kthread, void *qdata);
@@ -96,12 +123,20 @@ extern inline int kthread_get_errno ( kthread_t *kthread );
 extern inline int *kthread_get_errno_ptr ( kthread_t *kthread );
 extern inline void kthread_set_syscall_retval (kthread_t *kthread, int ret_val);
 
+/*! processor time accounting (called when thread is activated/deactivated) */
+void kthread_cpu_start ( kthread_t *kthread, timespec_t *now );
+void kthread_cpu_stop ( kthread_t *kthread, timespec_t *now );
+void kthread_cputime ( kthread_t *kthread, timespec_t *time );
+void kprocess_cputime ( kprocess_t *proc, timespec_t *time );
+extern inline int kthread_cpu_running ( kthread_t *kthread );
+
 /*! display active & ready threads info on console */
 int kthread_info ();
 
 #ifdef _K_SCHED_
 extern inline void kthread_set_active ( kthread_t *kthread );
 extern inline void kthread_mark_ready ( kthread_t *kthread );
+extern inline void kthread_mark_waiting ( kthread_t *kthread );
 extern inline void kthread_set_queue ( kthread_t *kthread, kthread_q *queue );
 extern inline kthread_q *kthread_get_queue ( kthread_t *kthread );
 #endif /* _K_SCHED_ */
@@ -166,12 +201,36 @@ typedef struct _kthread_state_cleanup_t_
 kthread_state_cleanup_t;
 
 
+/*! Processor usage of thread */
+typedef struct _kthread_cpu_t_
+{
+	timespec_t  time;
+		    /* processor time used (until last deactivation) */
+
+	timespec_t  start;
+		    /* when thread was last activated */
+
+	int	    running;
+		    /* thread is active ('start' is valid) */
+
+	uint	    switches;
+		    /* how many times thread was activated */
+
+	uint	    preempted;
+		    /* deactivations while thread still could run */
+}
+kthread_cpu_t;
+
+
 /*! Thread descriptor */
 struct _kthread_t_
 {
 	id_t		    id;
 			    /* thread id (number) */
 
+	int		    handle;
+			    /* index in thread handle table */
+
 	kprocess_t 	   *proc;
 			    /* process this thread belongs to */
 
@@ -188,6 +247,9 @@ struct _kthread_t_
 	kthread_sched2_t    sched2;
 			    /* secondary scheduler parameters */
 
+	kthread_pi_t	    pi;
+			    /* priority inheritance/ceiling data */
+
 	kthread_q	   *queue;
 			    /* in witch queue thread is (if not active) */
 
@@ -197,6 +259,21 @@ struct _kthread_t_
 	ksignal_handling_t  sig_handling;
 			    /* signal handling */
 
+	kthread_cpu_t	    cpu;
+			    /* processor usage */
+
+	timespec_t	    timer_slack;
+			    /* default slack for its timers and sleeps */
+
+	ktimer_t	   *sleep_timer;
+			    /* timer for sleep operations (no allocation
+			     * on each sleep) */
+
+#ifdef LATENCY_TRACE
+	klatency_thread_t   latency;
+			    /* wakeup to run latency measurement */
+#endif
+
 	list_h		    list;
 			    /* list element for "thread state" list */
 
@@ -15,21 +15,66 @@
 static void kclock_wake_thread ( sigval_t sigval );
 static void kclock_interrupt_sleep ( kthread_t *kthread, void *param );
 static int ktimer_cmp ( void *_a, void *_b );
+static int ktimer_cmp_latest ( void *_a, void *_b );
+static void ktimer_add ( ktimer_t *ktimer );
+static void ktimer_remove ( ktimer_t *ktimer );
+static void ktimer_set_slack ( ktimer_t *ktimer, int flags );
+static void ktimer_alarm ();
 static void ktimer_schedule ();
+static void ktimer_now ( ktimer_t *ktimer, timespec_t *now );
+static void ktimer_cpu_alarm ( sigval_t sigval );
 
-/*! List of active timers */
-static list_t ktimers;
+/*! Active timers (heap, sorted by expiration time) */
+static heap_t ktimers;
+
+/*! Same timers sorted by latest expiration time (expiration + slack) */
+static heap_t ktimers_latest;
+
+/*! Timer interrupt statistics */
+static uint ktimer_alarms;	/* timer interrupts */
+static uint ktimer_expired;	/* timers expired in them */
+static uint ktimer_saved;	/* interrupts saved by using slack */
+
+/*!
+ * Active timers on processor time clocks (few expected: not sorted, since
+ * only clocks of active thread and its process are running)
+ */
+static list_t kcputimers;
+
+/*! All timers on processor time clocks (to detach them from dead owners) */
+static list_t kcputimers_all;
+
+/*! Kernel timer for first expiration among running processor time clocks */
+static ktimer_t *kcpu_alarm;
 
 static timespec_t threshold;
 
+static kmem_cache_t *ktimer_cache; /* timer descriptors */
+
 
 /*! Initialize time management subsystem */
 int k_time_init ()
 {
+	sigevent_t evp;
+
 	arch_timer_init ();
 
-	/* timer list is empty */
-	list_init ( &ktimers );
+	/* timer heap is empty */
+	heap_init ( &ktimers, ktimer_cmp,
+		    kmalloc ( KTIMERS_INIT_SIZE * sizeof (heap_h *) ),
+		    KTIMERS_INIT_SIZE );
+	heap_init ( &ktimers_latest, ktimer_cmp_latest,
+		    kmalloc ( KTIMERS_INIT_SIZE * sizeof (heap_h *) ),
+		    KTIMERS_INIT_SIZE );
+	ktimer_cache = kmem_cache_create ( "ktimer_t", sizeof (ktimer_t) );
+
+	list_init ( &kcputimers );
+	list_init ( &kcputimers_all );
+	evp.sigev_notify = SIGEV_THREAD;
+	evp.sigev_notify_function = ktimer_cpu_alarm;
+	evp.sigev_notify_attributes = NULL;
+	evp.sigev_value.sival_ptr = NULL;
+	ktimer_create ( CLOCK_MONOTONIC, &evp, &kcpu_alarm, NULL );
 
 	arch_get_min_interval ( &threshold );
 	threshold.tv_nsec /= 2;
@@ -42,14 +87,19 @@ int k_time_init ()
 
 /*!
  * Get current time
- * \param clockid Clock to use
+ * \param clockid Clock to use (processor time clocks: of active thread)
  * \param time Pointer where to store time
  */
 int kclock_gettime ( clockid_t clockid, timespec_t *time )
 {
-	ASSERT(time && (clockid==CLOCK_REALTIME || clockid==CLOCK_MONOTONIC));
+	ASSERT ( time && CLOCK_IS_VALID ( clockid ) );
 
-	arch_get_time ( time );
+	if ( clockid == CLOCK_THREAD_CPUTIME_ID )
+		kthread_cputime ( NULL, time );
+	else if ( clockid == CLOCK_PROCESS_CPUTIME_ID )
+		kprocess_cputime ( kthread_get_process (NULL), time );
+	else
+		arch_get_time ( time );
 
 	return EXIT_SUCCESS;
 }
@@ -68,6 +118,28 @@ int kclock_settime ( clockid_t clockid, timespec_t *time )
 	return EXIT_SUCCESS;
 }
 
+/*!
+ * Create sleep timer for thread: it is armed for each sleep and disarmed
+ * on wakeup, but deleted only with thread descriptor
+ * \param kthread Thread descriptor (timer owner)
+ * \return Timer descriptor
+ */
+ktimer_t *kclock_sleep_timer_create ( void *kthread )
+{
+	ktimer_t *ktimer;
+	sigevent_t evp;
+
+	evp.sigev_notify = SIGEV_WAKE_THREAD;
+	evp.sigev_value.sival_ptr = kthread;
+	evp.sigev_notify_function = kclock_wake_thread;
+	evp.sigev_notify_attributes = NULL;
+
+	ktimer_create ( CLOCK_REALTIME, &evp, &ktimer, kthread );
+	ASSERT ( ktimer );
+
+	return ktimer;
+}
+
 /*!
  * Resume suspended thread (called on timer activation)
  * \param sigval Thread that should be released
@@ -76,23 +148,20 @@ static void kclock_wake_thread ( sigval_t sigval )
 {
 	kthread_t *kthread;
 	ktimer_t *ktimer;
-	int retval = 0;
 
 	kthread = sigval.sival_ptr;
 	ASSERT ( kthread );
 	ASSERT ( kthread_check_kthread ( kthread ) ); /* is this valid thread */
 	ASSERT ( kthread_is_suspended ( kthread, NULL, NULL ) );
 
-	ktimer = kthread_get_private_param ( kthread );
+	/* one-shot timer: already disarmed */
+	ktimer = kthread_get_sleep_timer ( kthread );
 	timespec_t *remain = ktimer->param;
 	if ( remain )
 		TIME_RESET ( remain ); /* timer expired */
 
 	kthread_move_to_ready ( kthread, LAST );
 
-	retval += ktimer_delete ( ktimer );
-	ASSERT ( retval == EXIT_SUCCESS );
-
 	kthreads_schedule ();
 }
 
@@ -123,7 +192,8 @@ static void kclock_interrupt_sleep ( kthread_t *kthread, void *param )
 		time_sub ( remain, &now );
 	}
 
-	ktimer_delete (ktimer);
+	/* disarm (timer is kept for next sleep) */
+	ktimer_settime ( ktimer, 0, NULL, NULL );
 
 	kthread_set_syscall_retval ( kthread, EXIT_FAILURE );
 	kthread_set_errno ( kthread, EINTR );
@@ -132,7 +202,7 @@ static void kclock_interrupt_sleep ( kthread_t *kthread, void *param )
 /*! Timers ------------------------------------------------------------------ */
 
 /*!
- * Compare timers by expiration times (used when inserting new timer in list)
+ * Compare timers by expiration times (used for ordering timers in heap)
  * \param a First timer
  * \param b Second timer
  * \return -1 when a < b, 0 when a == b, 1 when a > b
@@ -144,6 +214,73 @@ static int ktimer_cmp ( void *_a, void *_b )
 	return time_cmp ( &a->itimer.it_value, &b->itimer.it_value );
 }
 
+/*! Compare timers by latest expiration times (for 'ktimers_latest') */
+static int ktimer_cmp_latest ( void *_a, void *_b )
+{
+	ktimer_t *a = _a, *b = _b;
+
+	return time_cmp ( &a->latest, &b->latest );
+}
+
+/*! Add armed timer to active timers (enlarge heaps if full) */
+static void ktimer_add ( ktimer_t *ktimer )
+{
+	heap_h **old, **new;
+
+	if ( heap_is_full ( &ktimers ) )
+	{
+		old = ktimers.elem;
+		new = kmalloc ( 2 * ktimers.max * sizeof (heap_h *) );
+		ASSERT ( new );
+		heap_resize ( &ktimers, new, 2 * ktimers.max );
+		kfree ( old );
+
+		old = ktimers_latest.elem;
+		new = kmalloc ( 2 * ktimers_latest.max * sizeof (heap_h *) );
+		ASSERT ( new );
+		heap_resize ( &ktimers_latest, new, 2 * ktimers_latest.max );
+		kfree ( old );
+	}
+
+	ktimer->latest = ktimer->itimer.it_value;
+	time_add ( &ktimer->latest, &ktimer->slack );
+
+	heap_insert ( &ktimers, ktimer, &ktimer->heap );
+	heap_insert ( &ktimers_latest, ktimer, &ktimer->latest_heap );
+}
+
+/*! Remove timer from active timers */
+static void ktimer_remove ( ktimer_t *ktimer )
+{
+	heap_remove ( &ktimers, &ktimer->heap );
+	heap_remove ( &ktimers_latest, &ktimer->latest_heap );
+}
+
+/*!
+ * Set timer slack: from flags (TIMER_SLACK) if given there, otherwise
+ * owner thread default is used; kernel timers have no slack
+ */
+static void ktimer_set_slack ( ktimer_t *ktimer, int flags )
+{
+	uint us;
+
+	if ( flags & TIMER_SLACK_SET )
+	{
+		us = TIMER_SLACK_GET ( flags );
+		if ( us > TIMER_SLACK_MAX )
+			us = TIMER_SLACK_MAX;
+		ktimer->slack.tv_sec = us / 1000000;
+		ktimer->slack.tv_nsec = ( us % 1000000 ) * 1000;
+	}
+	else if ( ktimer->owner )
+	{
+		ktimer->slack = *kthread_get_timer_slack ( ktimer->owner );
+	}
+	else {
+		TIME_RESET ( &ktimer->slack );
+	}
+}
+
 /*!
  * Create new timer
  * \param clockid	Clock used in timer
@@ -156,20 +293,32 @@ int ktimer_create ( clockid_t clockid, sigevent_t *evp, ktimer_t **_ktimer,
 		    void *owner )
 {
 	ktimer_t *ktimer;
-	ASSERT ( clockid == CLOCK_REALTIME || clockid == CLOCK_MONOTONIC );
+	ASSERT ( CLOCK_IS_VALID ( clockid ) );
 	ASSERT ( evp && _ktimer );
+	ASSERT ( owner || !CLOCK_IS_CPUTIME ( clockid ) );
 	/* add other checks on evp if required */
 
-	ktimer = kmalloc ( sizeof (ktimer_t) );
+	ktimer = kmem_cache_alloc ( ktimer_cache );
 	ASSERT ( ktimer );
 
 	ktimer->id = k_new_id ();
 	ktimer->clockid = clockid;
 	ktimer->evp = *evp;
 	ktimer->owner = owner;
+	if ( clockid == CLOCK_THREAD_CPUTIME_ID )
+		ktimer->clock_owner = owner;
+	else if ( clockid == CLOCK_PROCESS_CPUTIME_ID )
+		ktimer->clock_owner = kthread_get_process ( owner );
+	else
+		ktimer->clock_owner = NULL;
+	ksigev_notify_init ( &ktimer->notify, &ktimer->evp );
 	TIMER_DISARM ( ktimer );
+	TIME_RESET ( &ktimer->slack );
 	ktimer->param = NULL;
 
+	if ( ktimer->clock_owner )
+		list_append ( &kcputimers_all, ktimer, &ktimer->cpu_list );
+
 	*_ktimer = ktimer;
 
 	return EXIT_SUCCESS;
@@ -187,12 +336,24 @@ int ktimer_delete ( ktimer_t *ktimer )
 	/* remove from active timers (if it was there) */
 	if ( TIMER_IS_ARMED ( ktimer ) )
 	{
-		list_remove ( &ktimers, 0, &ktimer->list );
-		ktimer_schedule ();
+		if ( CLOCK_IS_CPUTIME ( ktimer->clockid ) )
+		{
+			list_remove ( &kcputimers, 0, &ktimer->list );
+			ktimer_cpu_schedule ();
+		}
+		else {
+			ktimer_remove ( ktimer );
+			ktimer_schedule ();
+		}
 	}
 
+	if ( ktimer->clock_owner )
+		list_remove ( &kcputimers_all, 0, &ktimer->cpu_list );
+
+	ksigev_notify_cancel ( &ktimer->notify );
+
 	k_free_id ( ktimer->id );
-	kfree ( ktimer );
+	kmem_cache_free ( ktimer_cache, ktimer );
 
 	return EXIT_SUCCESS;
 }
@@ -212,7 +373,11 @@ int ktimer_settime ( ktimer_t *ktimer, int flags, itimerspec_t *value,
 
 	ASSERT ( ktimer );
 
-	kclock_gettime ( ktimer->clockid, &now );
+	/* processor time clock of terminated thread/process */
+	if ( CLOCK_IS_CPUTIME ( ktimer->clockid ) && !ktimer->clock_owner )
+		return EINVAL;
+
+	ktimer_now ( ktimer, &now );
 
 	if ( ovalue )
 	{
@@ -227,7 +392,10 @@ int ktimer_settime ( ktimer_t *ktimer, int flags, itimerspec_t *value,
 	if ( TIMER_IS_ARMED ( ktimer ) )
 	{
 		TIMER_DISARM ( ktimer );
-		list_remove ( &ktimers, 0, &ktimer->list );
+		if ( ktimer->clock_owner )
+			list_remove ( &kcputimers, 0, &ktimer->list );
+		else
+			ktimer_remove ( ktimer );
 	}
 
 	if ( value && TIME_IS_SET ( &value->it_value ) )
@@ -236,11 +404,18 @@ int ktimer_settime ( ktimer_t *ktimer, int flags, itimerspec_t *value,
 		ktimer->itimer = *value;
 		if ( !(flags & TIMER_ABSTIME) ) /* convert to absolute time */
 			time_add ( &ktimer->itimer.it_value, &now );
+		ktimer_set_slack ( ktimer, flags );
 
-		list_sort_add ( &ktimers, ktimer, &ktimer->list, ktimer_cmp );
+		if ( ktimer->clock_owner )
+			list_append ( &kcputimers, ktimer, &ktimer->list );
+		else
+			ktimer_add ( ktimer );
 	}
 
-	ktimer_schedule ();
+	if ( ktimer->clock_owner )
+		ktimer_cpu_schedule ();
+	else
+		ktimer_schedule ();
 
 	return EXIT_SUCCESS;
 }
@@ -256,7 +431,10 @@ int ktimer_gettime ( ktimer_t *ktimer, itimerspec_t *value )
 	ASSERT( ktimer && value );
 	timespec_t now;
 
-	kclock_gettime ( ktimer->clockid, &now );
+	if ( CLOCK_IS_CPUTIME ( ktimer->clockid ) && !ktimer->clock_owner )
+		return EINVAL;
+
+	ktimer_now ( ktimer, &now );
 
 	*value = ktimer->itimer;
 
@@ -267,12 +445,24 @@ int ktimer_gettime ( ktimer_t *ktimer, itimerspec_t *value )
 	return EXIT_SUCCESS;
 }
 
-/*! Activate timers and reschedule threads if required */
+/*! Timer interrupt: count it and activate timers */
+static void ktimer_alarm ()
+{
+	ktimer_alarms++;
+	ktimer_schedule ();
+}
+
+/*!
+ * Activate expired timers and reschedule threads if required; next timer
+ * interrupt is set at earliest 'latest' expiration time, so that all timers
+ * whose [expiration, expiration + slack] intervals include that time expire
+ * in the same interrupt
+ */
 static void ktimer_schedule ()
 {
 	ktimer_t *first;
-	timespec_t time, ref_time;
-	int resched = 0;
+	timespec_t time, ref_time, group;
+	int resched = 0, groups = 0;
 
 	kclock_gettime ( CLOCK_REALTIME, &time );
 	/* should have separate "scheduler" for each clock */
@@ -282,7 +472,7 @@ static void ktimer_schedule ()
 	/* use "ref_time" instead of "time" when looking timers to activate */
 
 	/* should any timer be activated? */
-	first = list_get ( &ktimers, FIRST );
+	first = heap_get ( &ktimers );
 	while ( first != NULL )
 	{
 		/* timers have absolute values in 'it_value' */
@@ -290,20 +480,32 @@ static void ktimer_schedule ()
 		{
 			/* 'activate' timer */
 
-			/* but first remove timer from list */
-			first = list_remove ( &ktimers, FIRST, NULL );
+			/* timers not within 'threshold' of previous ones
+			 * would (without slack) require separate interrupt */
+			if ( !groups ||
+			     time_cmp ( &first->itimer.it_value, &group ) > 0 )
+			{
+				groups++;
+				group = first->itimer.it_value;
+				time_add ( &group, &threshold );
+			}
+			ktimer_expired++;
 
-			/* and add to list if period is given */
+			/* if period is given, keep it in heap with new time */
 			if ( TIME_IS_SET ( &first->itimer.it_interval) )
 			{
 				/* calculate next activation time */
 				time_add ( &first->itimer.it_value,
 					   &first->itimer.it_interval );
-				/* put back into list */
-				list_sort_add ( &ktimers, first,
-						&first->list, ktimer_cmp );
+				time_add ( &first->latest,
+					   &first->itimer.it_interval );
+				/* move it to its new place in heaps */
+				heap_update ( &ktimers, &first->heap );
+				heap_update ( &ktimers_latest,
+					      &first->latest_heap );
 			}
 			else {
+				ktimer_remove ( first );
 				TIMER_DISARM ( first );
 			}
 
@@ -317,32 +519,191 @@ static void ktimer_schedule ()
 			}
 			else {
 				/* timer set by thread */
-				if ( !ksignal_process_event (
-					&first->evp, first->owner, SI_TIMER ) )
+				if ( !ksignal_process_event ( &first->evp,
+						first->owner, SI_TIMER,
+						&first->notify ) )
 				{
 					resched++;
 				}
 			}
 
-			first = list_get ( &ktimers, FIRST );
+			first = heap_get ( &ktimers );
 		}
 		else {
 			break;
 		}
 	}
 
-	first = list_get ( &ktimers, FIRST );
+	if ( groups > 1 )
+		ktimer_saved += groups - 1;
+
+	first = heap_get ( &ktimers_latest );
 	if ( first )
 	{
-		ref_time = first->itimer.it_value;
+		ref_time = first->latest;
 		time_sub ( &ref_time, &time );
-		arch_timer_set ( &ref_time, ktimer_schedule );
+		arch_timer_set ( &ref_time, ktimer_alarm );
 	}
 
 	if ( resched )
 		kthreads_schedule ();
 }
 
+/*! Get current time on clock used by timer (processor time of its owner) */
+static void ktimer_now ( ktimer_t *ktimer, timespec_t *now )
+{
+	if ( ktimer->clockid == CLOCK_THREAD_CPUTIME_ID )
+		kthread_cputime ( ktimer->clock_owner, now );
+	else if ( ktimer->clockid == CLOCK_PROCESS_CPUTIME_ID )
+		kprocess_cputime ( ktimer->clock_owner, now );
+	else
+		kclock_gettime ( ktimer->clockid, now );
+}
+
+/*!
+ * Activate expired processor time timers and set kernel alarm for first
+ * expiration among running clocks (called when timer is changed, when
+ * active thread is changed and from that alarm)
+ */
+void ktimer_cpu_schedule ()
+{
+	ktimer_t *ktimer;
+	kthread_t *active;
+	timespec_t now, ref_time, left;
+	itimerspec_t alarm, *it;
+	int running, resched = 0;
+
+	if ( !list_get ( &kcputimers, FIRST ) && !TIMER_IS_ARMED (kcpu_alarm) )
+		return; /* nothing to do (common case) */
+
+	/* activate expired timers, one by one (signal might cause rescheduling
+	 * and changes in list) */
+	do {
+		ktimer = list_get ( &kcputimers, FIRST );
+		for ( ; ktimer; ktimer = list_get_next ( &ktimer->list ) )
+		{
+			/* as in ktimer_schedule: timers that would expire
+			 * within 'threshold' are activated now */
+			ktimer_now ( ktimer, &ref_time );
+			time_add ( &ref_time, &threshold );
+
+			it = &ktimer->itimer;
+			if ( time_cmp ( &it->it_value, &ref_time ) <= 0 )
+				break;
+		}
+
+		if ( !ktimer )
+			break;
+
+		/* periodic timer is left in list, with next expiration time */
+		if ( TIME_IS_SET ( &it->it_interval ) )
+		{
+			do
+				time_add ( &it->it_value, &it->it_interval );
+			while ( time_cmp ( &it->it_value, &ref_time ) <= 0 );
+		}
+		else {
+			list_remove ( &kcputimers, 0, &ktimer->list );
+			TIMER_DISARM ( ktimer );
+		}
+
+		if ( !ksignal_process_event ( &ktimer->evp, ktimer->owner,
+					      SI_TIMER, &ktimer->notify ) )
+			resched++;
+	}
+	while ( ktimer );
+
+	/* first expiration of timers on running clocks: only of active
+	 * thread and its process */
+	active = kthread_get_active ();
+	TIME_RESET ( &alarm.it_interval );
+	TIME_RESET ( &alarm.it_value );
+
+	ktimer = list_get ( &kcputimers, FIRST );
+	for ( ; ktimer; ktimer = list_get_next ( &ktimer->list ) )
+	{
+		if ( ktimer->clockid == CLOCK_THREAD_CPUTIME_ID )
+			running = ktimer->clock_owner == active &&
+				  kthread_cpu_running ( active );
+		else
+			running = active &&
+				  ktimer->clock_owner ==
+					kthread_get_process ( active );
+		if ( !running )
+			continue;
+
+		ktimer_now ( ktimer, &now );
+		left = ktimer->itimer.it_value;
+		if ( time_cmp ( &left, &now ) > 0 )
+			time_sub ( &left, &now );
+		else
+			left = threshold; /* expired meanwhile */
+
+		if ( !TIME_IS_SET ( &alarm.it_value ) ||
+		     time_cmp ( &left, &alarm.it_value ) < 0 )
+			alarm.it_value = left;
+	}
+
+	/* (re)arm or disarm alarm */
+	if ( TIME_IS_SET ( &alarm.it_value ) || TIMER_IS_ARMED ( kcpu_alarm ) )
+		ktimer_settime ( kcpu_alarm, 0, &alarm, NULL );
+
+	if ( resched )
+		kthreads_schedule ();
+}
+
+/*! Kernel alarm: some processor time timer might have expired */
+static void ktimer_cpu_alarm ( sigval_t sigval )
+{
+	ktimer_cpu_schedule ();
+}
+
+/*!
+ * Thread or process is terminating: disarm processor time timers on its clock
+ * or owned by it (they can not be signaled anymore); timers on its clock are
+ * also detached from it (they can not be armed again)
+ */
+void ktimer_cpu_release ( void *owner )
+{
+	ktimer_t *ktimer, *next;
+
+	ktimer = list_get ( &kcputimers_all, FIRST );
+	for ( ; ktimer; ktimer = next )
+	{
+		next = list_get_next ( &ktimer->cpu_list );
+
+		if ( ktimer->clock_owner != owner && ktimer->owner != owner )
+			continue;
+
+		if ( TIMER_IS_ARMED ( ktimer ) )
+		{
+			list_remove ( &kcputimers, 0, &ktimer->list );
+			TIMER_DISARM ( ktimer );
+		}
+
+		/* clock is gone: timer can't be armed again (EINVAL) */
+		if ( ktimer->clock_owner == owner )
+		{
+			list_remove ( &kcputimers_all, 0, &ktimer->cpu_list );
+			ktimer->clock_owner = NULL;
+		}
+	}
+}
+
+/*!
+ * Timer interrupt statistics: interrupts saved are timers that expired
+ * (within slack) together with earlier ones, but would require separate
+ * interrupt without slack
+ */
+int ktimer_info ( char *buffer, size_t buf_size )
+{
+	ksprintf ( buffer, buf_size, "Timers: active=%u, interrupts=%u, "
+		   "expired=%u, interrupts saved by slack=%u\n",
+		   ktimers.size, ktimer_alarms, ktimer_expired, ktimer_saved );
+
+	return EXIT_SUCCESS;
+}
+
 
 /*! Interface to threads ---------------------------------------------------- */
 
@@ -362,10 +723,7 @@ int sys__clock_gettime ( void *p )
 	clockid = *( (clockid_t *) p );	p += sizeof (clockid_t);
 	time = *( (void **) p );
 
-	ASSERT_ERRNO_AND_EXIT (
-	    time && (clockid==CLOCK_REALTIME || clockid==CLOCK_MONOTONIC),
-	    EINVAL
-	);
+	ASSERT_ERRNO_AND_EXIT ( time && CLOCK_IS_VALID ( clockid ), EINVAL );
 	time =  U2K_GET_ADR ( time, kthread_get_process (NULL) );
 	ASSERT_ERRNO_AND_EXIT ( time, EINVAL );
 
@@ -420,7 +778,6 @@ int sys__clock_nanosleep ( void *p )
 	int retval = EXIT_SUCCESS;
 	kthread_t *kthread = kthread_get_active ();
 	ktimer_t *ktimer;
-	sigevent_t evp;
 	itimerspec_t itimer;
 
 	clockid =	*( (clockid_t *) p );	p += sizeof (clockid_t);
@@ -439,23 +796,17 @@ int sys__clock_nanosleep ( void *p )
 
 	/* Timers are used for "sleep" operations through steps 1-4 */
 
-	/* 1. create timer, but not arm it yet */
-	evp.sigev_notify = SIGEV_WAKE_THREAD;
-	evp.sigev_value.sival_ptr = kthread;
-	evp.sigev_notify_function = kclock_wake_thread;
-
-	retval += ktimer_create ( clockid, &evp, &ktimer, kthread );
-	ASSERT ( retval == EXIT_SUCCESS );
+	/* 1. take thread sleep timer (created with thread), not armed yet */
+	ktimer = kthread_get_sleep_timer ( kthread );
+	ASSERT ( !TIMER_IS_ARMED ( ktimer ) );
+	ktimer->clockid = clockid;
 
 	/* save remainder location, if provided */
 	if ( remain )
-	{
 		remain =  U2K_GET_ADR ( remain, kthread_get_process (NULL) );
-		ktimer->param = remain;
-	}
+	ktimer->param = remain;
 
 	/* 2. suspend thread */
-	kthread_set_private_param ( kthread, ktimer );
 	retval += kthread_suspend ( kthread, kclock_interrupt_sleep, ktimer );
 	ASSERT ( retval == EXIT_SUCCESS );
 
@@ -489,26 +840,37 @@ int sys__timer_create ( void *p )
 	int retval = EXIT_SUCCESS;
 	kprocess_t *proc;
 	kobject_t *kobj;
+	pthread_attr_t *attr;
 
 	clockid =	*( (clockid_t *) p );	p += sizeof (clockid_t);
 	evp =		*( (sigevent_t **) p );	p += sizeof (sigevent_t *);
 	timerid =	*( (timer_t **) p );
 
 	proc = kthread_get_process (NULL);
-	ASSERT_ERRNO_AND_EXIT (
-	clockid == CLOCK_REALTIME || clockid == CLOCK_MONOTONIC, EINVAL );
+	ASSERT_ERRNO_AND_EXIT ( CLOCK_IS_VALID ( clockid ), EINVAL );
 	ASSERT_ERRNO_AND_EXIT ( evp && timerid, EINVAL );
 	evp = U2K_GET_ADR ( evp, proc );
 	timerid = U2K_GET_ADR ( timerid, proc );
 	ASSERT_ERRNO_AND_EXIT ( evp && timerid, EINVAL );
 
+	if ( evp->sigev_notify == SIGEV_THREAD )
+	{
+		/* workers for notifications (pool size from attributes) */
+		attr = evp->sigev_notify_attributes;
+		if ( attr )
+			attr = U2K_GET_ADR ( attr, proc );
+
+		retval = ksigev_pool_setup ( proc, attr );
+		if ( retval )
+			EXIT ( retval );
+	}
+
 	retval = ktimer_create ( clockid, evp, &ktimer, kthread_get_active() );
 	if ( retval == EXIT_SUCCESS )
 	{
 		kobj = kmalloc_kobject ( proc, 0 );
 		kobj->kobject = ktimer;
-		timerid->id = ktimer->id;
-		timerid->ptr = kobj;
+		kobject_set_descriptor ( kobj, ktimer->id, timerid );
 	}
 	EXIT ( retval );
 }
@@ -533,10 +895,8 @@ int sys__timer_delete ( void *p )
 	ASSERT_ERRNO_AND_EXIT ( timerid, EINVAL );
 	timerid = U2K_GET_ADR ( timerid, proc );
 	ASSERT_ERRNO_AND_EXIT ( timerid, EINVAL );
-	kobj = timerid->ptr;
+	kobj = kobject_get ( proc, timerid );
 	ASSERT_ERRNO_AND_EXIT ( kobj, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				EINVAL );
 
 	ktimer = kobj->kobject;
 	ASSERT_ERRNO_AND_EXIT ( ktimer && ktimer->id == timerid->id, EINVAL );
@@ -551,7 +911,7 @@ int sys__timer_delete ( void *p )
 /*!
  * Arm/disarm timer
  * \param timerid	Timer descriptor (user descriptor)
- * \param flags		Various flags
+ * \param flags		Various flags (TIMER_ABSTIME, TIMER_SLACK(us))
  * \param value		Set timer values (it_value+it_period)
  * \param ovalue	Where to store time to next timer expiration (+period)
  * \return status	0 for success
@@ -578,10 +938,8 @@ int sys__timer_settime ( void *p )
 	timerid = U2K_GET_ADR ( timerid, proc );
 	ASSERT_ERRNO_AND_EXIT ( timerid, EINVAL );
 
-	kobj = timerid->ptr;
+	kobj = kobject_get ( proc, timerid );
 	ASSERT_ERRNO_AND_EXIT ( kobj, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				EINVAL );
 
 	ktimer = kobj->kobject;
 	ASSERT_ERRNO_AND_EXIT ( ktimer && ktimer->id == timerid->id, EINVAL );
@@ -618,10 +976,8 @@ int sys__timer_gettime ( void *p )
 	timerid = U2K_GET_ADR ( timerid, proc );
 	ASSERT_ERRNO_AND_EXIT ( timerid, EINVAL );
 
-	kobj = timerid->ptr;
+	kobj = kobject_get ( proc, timerid );
 	ASSERT_ERRNO_AND_EXIT ( kobj, EINVAL );
-	ASSERT_ERRNO_AND_EXIT ( list_find ( &proc->kobjects, &kobj->list ),
-				EINVAL );
 
 	ktimer = kobj->kobject;
 	ASSERT_ERRNO_AND_EXIT ( ktimer && ktimer->id == timerid->id, EINVAL );
@@ -632,3 +988,32 @@ int sys__timer_gettime ( void *p )
 
 	EXIT ( retval );
 }
+
+/*!
+ * Get timer overrun count (for SIGEV_THREAD timers: number of expirations
+ * lost before last delivered notification, while all pool threads were busy)
+ * \param timerid	Timer descriptor (user descriptor)
+ * \return overrun count, -1 on error
+ */
+int sys__timer_getoverrun ( void *p )
+{
+	timer_t *timerid;
+
+	ktimer_t *ktimer;
+	kprocess_t *proc;
+	kobject_t *kobj;
+
+	timerid = *( (timer_t **) p );
+
+	proc = kthread_get_process (NULL);
+	ASSERT_ERRNO_AND_EXIT ( timerid, EINVAL );
+	timerid = U2K_GET_ADR ( timerid, proc );
+
+	kobj = kobject_get ( proc, timerid );
+	ASSERT_ERRNO_AND_EXIT ( kobj, EINVAL );
+
+	ktimer = kobj->kobject;
+	ASSERT_ERRNO_AND_EXIT ( ktimer && ktimer->id == timerid->id, EINVAL );
+
+	EXIT2 ( EXIT_SUCCESS, ktimer->notify.overrun_last );
+}
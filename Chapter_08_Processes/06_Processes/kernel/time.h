@@ -22,6 +22,15 @@ int ktimer_settime ( ktimer_t *ktimer, int flags, itimerspec_t *value,
 		     itimerspec_t *ovalue );
 int ktimer_gettime ( ktimer_t *ktimer, itimerspec_t *value );
 
+/*! timers on processor time clocks */
+void ktimer_cpu_schedule ();
+void ktimer_cpu_release ( void *owner );
+
+int ktimer_info ( char *buffer, size_t buf_size );
+
+/*! thread sleep timer (created with thread and reused for each sleep) */
+ktimer_t *kclock_sleep_timer_create ( void *kthread );
+
 /* signal notification type for wakeup */
 #define	SIGEV_WAKE_THREAD	(SIGEV_THREAD_ID + 1)
 
@@ -29,7 +38,8 @@ int ktimer_gettime ( ktimer_t *ktimer, itimerspec_t *value );
 #ifdef	_K_TIME_C_
 /*! rest of the file is only for 'kernel/timer.c' --------------------------- */
 
-#include <lib/list.h>
+#include <lib/heap.h>
+#include "signal.h"
 
 /*! Kernel timer */
 struct _ktimer_t_
@@ -43,16 +53,36 @@ struct _ktimer_t_
 		      /* what to do when timer expires */
 	itimerspec_t  itimer;
 		      /* interval timers {it_value, it_interval} */
+	timespec_t    slack;
+		      /* expiration may be delayed up to 'slack', so that
+		       * timer expires together with other timers */
+	timespec_t    latest;
+		      /* latest expiration: it_value + slack */
 	void	     *owner;
 		      /* owner threads or NULL if kernel timer */
+	void	     *clock_owner;
+		      /* thread or process whose processor time clock is used
+		       * (for CLOCK_THREAD/PROCESS_CPUTIME_ID timers; NULL
+		       * for them when clock owner terminates) */
 
 	void	     *param;
 		      /* additional parameter (remainder for sleep)*/
 
+	ksigev_notify_t notify;
+		      /* SIGEV_THREAD notification state (and overruns) */
+
+	heap_h	      heap;
+		      /* active timers are in heap, sorted by expiration */
+	heap_h	      latest_heap;
+		      /* and in heap sorted by latest expiration */
 	list_h	      list;
-		      /* active timers are in sorted list */
+		      /* active processor time timers are in list instead */
+	list_h	      cpu_list;
+		      /* all processor time timers (armed or not) */
 };
 
+#define KTIMERS_INIT_SIZE	64	/* initial size of active timers heap */
+
 #define TIMER_IS_ARMED(T)	TIME_IS_SET ( &(T)->itimer.it_value )
 #define TIMER_DISARM(T)		TIME_RESET ( &(T)->itimer.it_value )
 
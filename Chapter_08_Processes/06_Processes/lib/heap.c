@@ -0,0 +1,183 @@
+/*!
+ * Binary heap (priority queue) of objects
+ * (simple operations on heap are inline functions in heap.h)
+ */
+
+#include <lib/heap.h>
+
+#ifndef ASSERT
+#include ASSERT_H
+#endif
+
+#define PARENT(i)	( ( (i) - 1 ) / 2 )
+#define LEFT(i)		( 2 * (i) + 1 )
+
+/* put element 'hdr' at position 'i' */
+#define PLACE(heap, i, hdr)				\
+do {							\
+	(heap)->elem[i] = (hdr);			\
+	(hdr)->index = (i);				\
+} while (0)
+
+/*! Move element at position 'i' toward top while it is "smaller" than parent */
+static void sift_up ( heap_t *heap, uint i )
+{
+	heap_h *hdr = heap->elem[i];
+
+	while ( i > 0 &&
+		heap->cmp ( hdr->object, heap->elem[PARENT(i)]->object ) < 0 )
+	{
+		PLACE ( heap, i, heap->elem[PARENT(i)] );
+		i = PARENT(i);
+	}
+
+	PLACE ( heap, i, hdr );
+}
+
+/*! Move element at position 'i' toward bottom while child is "smaller" */
+static void sift_down ( heap_t *heap, uint i )
+{
+	heap_h *hdr = heap->elem[i];
+	uint child;
+
+	while ( ( child = LEFT(i) ) < heap->size )
+	{
+		if ( child + 1 < heap->size &&
+			heap->cmp ( heap->elem[child + 1]->object,
+				    heap->elem[child]->object ) < 0 )
+			child++;
+
+		if ( heap->cmp ( heap->elem[child]->object, hdr->object ) >= 0 )
+			break;
+
+		PLACE ( heap, i, heap->elem[child] );
+		i = child;
+	}
+
+	PLACE ( heap, i, hdr );
+}
+
+/*!
+ * Initialize empty heap
+ * \param heap Heap header
+ * \param cmp Compare function (as for list_sort_add)
+ * \param mem Array for 'max' element pointers
+ * \param max Capacity
+ */
+void heap_init ( heap_t *heap, int (*cmp) ( void *, void * ),
+		 heap_h **mem, uint max )
+{
+	ASSERT ( heap && cmp && mem && max > 0 );
+
+	heap->elem = mem;
+	heap->size = 0;
+	heap->max = max;
+	heap->cmp = cmp;
+}
+
+/*!
+ * Move heap elements to new array (old array can be released afterwards)
+ * \param heap Heap header
+ * \param mem New array for 'max' element pointers
+ * \param max Capacity of new array (not less than current heap size)
+ */
+void heap_resize ( heap_t *heap, heap_h **mem, uint max )
+{
+	uint i;
+
+	ASSERT ( heap && mem && max >= heap->size );
+
+	for ( i = 0; i < heap->size; i++ )
+		mem[i] = heap->elem[i];
+
+	heap->elem = mem;
+	heap->max = max;
+}
+
+/*!
+ * Add element to heap
+ * \param heap Heap header
+ * \param object Object to add
+ * \param hdr Heap element in object
+ * \return 0 if successful, -1 if heap is full
+ */
+int heap_insert ( heap_t *heap, void *object, heap_h *hdr )
+{
+	ASSERT ( heap && object && hdr );
+
+	if ( heap->size == heap->max )
+		return -1;
+
+	hdr->object = object;
+	PLACE ( heap, heap->size, hdr );
+	heap->size++;
+
+	sift_up ( heap, heap->size - 1 );
+
+	return 0;
+}
+
+/*!
+ * Remove element from heap
+ * \param heap Heap header
+ * \param hdr Element to remove, or NULL for top element
+ * \return removed object, NULL if heap was empty
+ */
+void *heap_remove ( heap_t *heap, heap_h *hdr )
+{
+	uint i;
+
+	ASSERT ( heap );
+
+	if ( !heap->size )
+		return NULL;
+
+	if ( !hdr )
+		hdr = heap->elem[0];
+
+	ASSERT ( hdr->index >= 0 && (uint) hdr->index < heap->size &&
+		 heap->elem[hdr->index] == hdr );
+
+	i = hdr->index;
+	hdr->index = -1;
+	heap->size--;
+
+	if ( i < heap->size )
+	{
+		/* fill the gap with last element and restore heap order */
+		PLACE ( heap, i, heap->elem[heap->size] );
+
+		if ( i > 0 && heap->cmp ( heap->elem[i]->object,
+				heap->elem[PARENT(i)]->object ) < 0 )
+			sift_up ( heap, i );
+		else
+			sift_down ( heap, i );
+	}
+
+	return hdr->object;
+}
+
+/*!
+ * Restore heap order after key of element in heap is changed
+ * \param heap Heap header
+ * \param hdr Changed element
+ */
+void heap_update ( heap_t *heap, heap_h *hdr )
+{
+	uint i;
+
+	ASSERT ( heap && hdr && hdr->index >= 0 &&
+		 (uint) hdr->index < heap->size );
+
+	i = hdr->index;
+
+	if ( i > 0 && heap->cmp ( hdr->object,
+				  heap->elem[PARENT(i)]->object ) < 0 )
+		sift_up ( heap, i );
+	else
+		sift_down ( heap, i );
+}
+
+#undef PARENT
+#undef LEFT
+#undef PLACE
@@ -58,6 +58,30 @@ void list_prepend ( list_t *list, void *object, list_h *hdr )
 	list->first = hdr;
 }
 
+/*! Add element to list, after given element (as first if 'after' is NULL) */
+void list_insert_after ( list_t *list, void *object, list_h *hdr,
+			 list_h *after )
+{
+	ASSERT ( list && object && hdr );
+
+	if ( !after )
+	{
+		list_prepend ( list, object, hdr );
+		return;
+	}
+
+	hdr->object = object; /* save reference to object */
+	hdr->prev = after;
+	hdr->next = after->next;
+
+	if ( after->next )
+		after->next->prev = hdr;
+	else
+		list->last = hdr; /* 'after' was last */
+
+	after->next = hdr;
+}
+
 /*! Add element to sorted list */
 void list_sort_add ( list_t *list, void *object, list_h *hdr,
 				   int (*cmp) ( void *, void * ) )
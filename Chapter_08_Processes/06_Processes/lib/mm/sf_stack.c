@@ -0,0 +1,170 @@
+/*!  Segregated fit allocator for thread stacks */
+
+#define _SF_STACK_C_
+#include <lib/sf_stack.h>
+
+#ifndef ASSERT
+#include ASSERT_H
+#endif
+
+/*!
+ * Initialize allocator
+ * \param mem_segm Memory pool start address
+ * \param size Memory pool size
+ * \param class_size Sizes of classes (zero sizes and duplicates are ignored)
+ * \param classes Number of elements in 'class_size' (max. SFS_CLASSES)
+ * \return memory pool descriptor, NULL if pool is too small
+ */
+void *sfs_init ( void *mem_segm, size_t size, size_t class_size[],
+		 uint classes )
+{
+	size_t start, csize;
+	sfs_mpool_t *mpool;
+	uint i, j;
+
+	ASSERT ( mem_segm && classes <= SFS_CLASSES );
+
+	start = (size_t) mem_segm;
+	ALIGN_FW ( start );
+	mpool = (void *) start;		/* place descriptor here */
+	start += sizeof (sfs_mpool_t);
+
+	if ( start - (size_t) mem_segm >= size )
+		return NULL;
+
+	mpool->ffs = ffs_init ( (void *) start,
+				size - ( start - (size_t) mem_segm ) );
+	if ( !mpool->ffs )
+		return NULL;
+
+	/* insert classes sorted by size */
+	mpool->classes = 0;
+	for ( i = 0; i < classes; i++ )
+	{
+		csize = class_size[i];
+		ALIGN_FW ( csize );
+
+		for ( j = 0; j < mpool->classes; j++ )
+			if ( mpool->class[j].size == csize )
+				break;
+
+		if ( !csize || j < mpool->classes )
+			continue;
+
+		for ( j = mpool->classes; j > 0; j-- )
+		{
+			if ( mpool->class[j - 1].size < csize )
+				break;
+			mpool->class[j] = mpool->class[j - 1];
+		}
+		mpool->class[j].size = csize;
+		mpool->class[j].free = NULL;
+		mpool->classes++;
+	}
+
+	return mpool;
+}
+
+/*!
+ * Get block of at least 'size' bytes
+ * \param mpool Memory pool to be used
+ * \param size Requested block size
+ * \return Block address, NULL if there is not enough memory
+ */
+void *sfs_alloc ( sfs_mpool_t *mpool, size_t size )
+{
+	sfs_class_t *class = NULL;
+	sfs_hdr_t *hdr;
+	size_t cls;
+
+	ASSERT ( mpool );
+
+	/* smallest class that is large enough */
+	for ( cls = 0; cls < mpool->classes; cls++ )
+	{
+		if ( size <= mpool->class[cls].size )
+		{
+			class = &mpool->class[cls];
+			break;
+		}
+	}
+
+	if ( class )
+	{
+		if ( class->free )
+		{
+			hdr = class->free;
+			class->free = hdr->next;
+
+			return hdr + 1;
+		}
+		size = class->size;
+	}
+	else {
+		cls = SFS_NO_CLASS;
+	}
+
+	hdr = ffs_alloc ( mpool->ffs, sizeof (sfs_hdr_t) + size );
+
+	/* no memory? return free blocks from all classes and retry */
+	if ( !hdr && sfs_release_free ( mpool ) )
+		hdr = ffs_alloc ( mpool->ffs, sizeof (sfs_hdr_t) + size );
+
+	if ( !hdr )
+		return NULL;
+
+	hdr->cls = cls;
+
+	return hdr + 1;
+}
+
+/*!
+ * Free block (put it in its class list)
+ * \param mpool Memory pool to be used
+ * \param block Block address (as returned by sfs_alloc)
+ * \return 0 if successful, -1 otherwise
+ */
+int sfs_free ( sfs_mpool_t *mpool, void *block )
+{
+	sfs_hdr_t *hdr;
+	sfs_class_t *class;
+
+	ASSERT ( mpool && block );
+
+	hdr = ( (sfs_hdr_t *) block ) - 1;
+
+	if ( hdr->cls == SFS_NO_CLASS )
+		return ffs_free ( mpool->ffs, hdr );
+
+	ASSERT ( hdr->cls < mpool->classes );
+
+	class = &mpool->class[hdr->cls];
+	hdr->next = class->free;
+	class->free = hdr;
+
+	return 0;
+}
+
+/*!
+ * Return all free blocks from class lists to first fit pool
+ * \param mpool Memory pool to be used
+ * \return number of returned blocks
+ */
+static int sfs_release_free ( sfs_mpool_t *mpool )
+{
+	sfs_hdr_t *hdr;
+	uint i;
+	int cnt = 0;
+
+	for ( i = 0; i < mpool->classes; i++ )
+	{
+		while ( ( hdr = mpool->class[i].free ) != NULL )
+		{
+			mpool->class[i].free = hdr->next;
+			ffs_free ( mpool->ffs, hdr );
+			cnt++;
+		}
+	}
+
+	return cnt;
+}
@@ -0,0 +1,72 @@
+/*!
+ * Hierarchical bit mask for O(1) searching of highest set bit (priority)
+ * (operations on bit mask are inline functions in prio_bitmap.h)
+ */
+
+#include <lib/prio_bitmap.h>
+
+#ifndef ASSERT
+#include ASSERT_H
+#endif
+
+/* number of words required for 'bits' bits */
+#define WORDS(bits)	( ( (bits) + PRIO_BITMAP_WBITS - 1 ) >> PRIO_BITMAP_SHIFT )
+
+/*!
+ * Calculate memory required for bit mask words
+ * \param levels Number of priority levels (bits)
+ * \return size in bytes
+ */
+size_t prio_bitmap_size ( uint levels )
+{
+	size_t words = 0;
+
+	ASSERT ( levels > 0 );
+
+	do {
+		levels = WORDS ( levels );
+		words += levels;
+	}
+	while ( levels > 1 );
+
+	return words * sizeof (uint32);
+}
+
+/*!
+ * Initialize bit mask (all bits cleared)
+ * \param bm Bit mask descriptor
+ * \param levels Number of priority levels (bits)
+ * \param mem Memory for words, at least prio_bitmap_size(levels) bytes
+ */
+void prio_bitmap_init ( prio_bitmap_t *bm, uint levels, void *mem )
+{
+	uint words[PRIO_BITMAP_MAX_DEPTH], n, i, d, depth;
+	uint32 *w = mem;
+
+	ASSERT ( bm && mem && levels > 0 );
+
+	/* number of words in each level, from leafs upward */
+	n = levels;
+	depth = 0;
+	do {
+		ASSERT ( depth < PRIO_BITMAP_MAX_DEPTH );
+		n = WORDS ( n );
+		words[depth++] = n;
+	}
+	while ( n > 1 );
+
+	bm->levels = levels;
+	bm->depth = depth;
+
+	/* summary word first, leaf words last */
+	for ( d = 0; d < depth; d++ )
+	{
+		n = words[depth - 1 - d];
+		bm->word[d] = w;
+		for ( i = 0; i < n; i++ )
+			w[i] = 0;
+		w += n;
+	}
+}
+
+#undef WORDS
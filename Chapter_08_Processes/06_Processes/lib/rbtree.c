@@ -0,0 +1,331 @@
+/*!
+ * Red-black tree of objects
+ * (simple operations on tree are inline functions in rbtree.h)
+ *
+ * Rules kept after each operation: root is black, red element has no red
+ * child, all paths from element to missing (NULL) children have same number
+ * of black elements. Longest path is so at most twice the shortest one.
+ */
+
+#include <lib/rbtree.h>
+
+#ifndef ASSERT
+#include ASSERT_H
+#endif
+
+#define IS_RED(n)	( (n) != NULL && (n)->red )
+
+/*! Put element 'new' (may be NULL) in place of element 'old' */
+static void replace ( rbtree_t *tree, rbtree_h *old, rbtree_h *new )
+{
+	if ( !old->parent )
+		tree->root = new;
+	else if ( old == old->parent->left )
+		old->parent->left = new;
+	else
+		old->parent->right = new;
+
+	if ( new )
+		new->parent = old->parent;
+}
+
+/*! Rotate left: right child of 'n' takes its place */
+static void rotate_left ( rbtree_t *tree, rbtree_h *n )
+{
+	rbtree_h *r = n->right;
+
+	n->right = r->left;
+	if ( r->left )
+		r->left->parent = n;
+
+	replace ( tree, n, r );
+
+	r->left = n;
+	n->parent = r;
+}
+
+/*! Rotate right: left child of 'n' takes its place */
+static void rotate_right ( rbtree_t *tree, rbtree_h *n )
+{
+	rbtree_h *l = n->left;
+
+	n->left = l->right;
+	if ( l->right )
+		l->right->parent = n;
+
+	replace ( tree, n, l );
+
+	l->right = n;
+	n->parent = l;
+}
+
+/*! Next element in order (NULL if 'n' is last) */
+static rbtree_h *next_node ( rbtree_h *n )
+{
+	if ( n->right )
+	{
+		for ( n = n->right; n->left; n = n->left )
+			;
+		return n;
+	}
+
+	while ( n->parent && n == n->parent->right )
+		n = n->parent;
+
+	return n->parent;
+}
+
+/*!
+ * Initialize empty tree
+ * \param tree Tree header
+ * \param cmp Compare function (as for list_sort_add)
+ */
+void rbtree_init ( rbtree_t *tree, int (*cmp) ( void *, void * ) )
+{
+	ASSERT ( tree && cmp );
+
+	tree->root = tree->first = NULL;
+	tree->size = 0;
+	tree->cmp = cmp;
+}
+
+/*!
+ * Add element to tree (after elements equal to it)
+ * \param tree Tree header
+ * \param object Object to add
+ * \param hdr Tree element in object
+ */
+void rbtree_insert ( rbtree_t *tree, void *object, rbtree_h *hdr )
+{
+	rbtree_h *p, *g, *u, **link;
+	int leftmost = TRUE;
+
+	ASSERT ( tree && object && hdr );
+
+	hdr->object = object;
+	hdr->parent = hdr->left = hdr->right = NULL;
+	hdr->red = TRUE;
+
+	/* binary search tree insertion */
+	link = &tree->root;
+	while ( *link )
+	{
+		hdr->parent = *link;
+		if ( tree->cmp ( object, (*link)->object ) < 0 )
+		{
+			link = &(*link)->left;
+		}
+		else {
+			link = &(*link)->right;
+			leftmost = FALSE;
+		}
+	}
+	*link = hdr;
+
+	if ( leftmost )
+		tree->first = hdr;
+	tree->size++;
+
+	/* red element with red parent: recolor or rotate */
+	while ( IS_RED ( ( p = hdr->parent ) ) )
+	{
+		g = p->parent; /* exists: root is black */
+
+		if ( p == g->left )
+		{
+			u = g->right;
+			if ( IS_RED ( u ) )
+			{
+				p->red = u->red = FALSE;
+				g->red = TRUE;
+				hdr = g;
+				continue;
+			}
+			if ( hdr == p->right )
+			{
+				rotate_left ( tree, p );
+				p = hdr;
+			}
+			p->red = FALSE;
+			g->red = TRUE;
+			rotate_right ( tree, g );
+		}
+		else {
+			u = g->left;
+			if ( IS_RED ( u ) )
+			{
+				p->red = u->red = FALSE;
+				g->red = TRUE;
+				hdr = g;
+				continue;
+			}
+			if ( hdr == p->left )
+			{
+				rotate_right ( tree, p );
+				p = hdr;
+			}
+			p->red = FALSE;
+			g->red = TRUE;
+			rotate_left ( tree, g );
+		}
+		break;
+	}
+
+	tree->root->red = FALSE;
+}
+
+/*!
+ * Restore black count after black element is removed from under 'p'
+ * \param tree Tree header
+ * \param n Element that took place of removed one (may be NULL)
+ * \param p Parent of 'n'
+ */
+static void remove_fixup ( rbtree_t *tree, rbtree_h *n, rbtree_h *p )
+{
+	rbtree_h *s;
+
+	while ( n != tree->root && !IS_RED ( n ) )
+	{
+		/* sibling 's' exists: its path has (at least) one black more */
+		if ( n == p->left )
+		{
+			s = p->right;
+			if ( s->red )
+			{
+				s->red = FALSE;
+				p->red = TRUE;
+				rotate_left ( tree, p );
+				s = p->right;
+			}
+			if ( !IS_RED ( s->left ) && !IS_RED ( s->right ) )
+			{
+				s->red = TRUE;
+				n = p;
+				p = n->parent;
+				continue;
+			}
+			if ( !IS_RED ( s->right ) )
+			{
+				s->left->red = FALSE;
+				s->red = TRUE;
+				rotate_right ( tree, s );
+				s = p->right;
+			}
+			s->red = p->red;
+			p->red = FALSE;
+			s->right->red = FALSE;
+			rotate_left ( tree, p );
+		}
+		else {
+			s = p->left;
+			if ( s->red )
+			{
+				s->red = FALSE;
+				p->red = TRUE;
+				rotate_right ( tree, p );
+				s = p->left;
+			}
+			if ( !IS_RED ( s->left ) && !IS_RED ( s->right ) )
+			{
+				s->red = TRUE;
+				n = p;
+				p = n->parent;
+				continue;
+			}
+			if ( !IS_RED ( s->left ) )
+			{
+				s->right->red = FALSE;
+				s->red = TRUE;
+				rotate_left ( tree, s );
+				s = p->left;
+			}
+			s->red = p->red;
+			p->red = FALSE;
+			s->left->red = FALSE;
+			rotate_right ( tree, p );
+		}
+		n = tree->root;
+	}
+
+	if ( n )
+		n->red = FALSE;
+}
+
+/*!
+ * Remove element from tree
+ * \param tree Tree header
+ * \param hdr Element to remove, or NULL for first element
+ * \return removed object, NULL if tree was empty
+ */
+void *rbtree_remove ( rbtree_t *tree, rbtree_h *hdr )
+{
+	rbtree_h *n, *p, *y;
+	int black;
+
+	ASSERT ( tree );
+
+	if ( !tree->root )
+		return NULL;
+
+	if ( !hdr )
+		hdr = tree->first;
+
+	if ( hdr == tree->first )
+		tree->first = next_node ( hdr );
+	tree->size--;
+
+	black = !hdr->red;
+
+	if ( !hdr->left || !hdr->right )
+	{
+		/* at most one child: it takes place of removed element */
+		n = hdr->left ? hdr->left : hdr->right;
+		p = hdr->parent;
+		replace ( tree, hdr, n );
+	}
+	else {
+		/* next element 'y' (without left child) takes its place */
+		y = next_node ( hdr );
+		black = !y->red;
+		n = y->right;
+
+		if ( y->parent == hdr )
+		{
+			p = y;
+		}
+		else {
+			p = y->parent;
+			replace ( tree, y, n );
+			y->right = hdr->right;
+			y->right->parent = y;
+		}
+
+		replace ( tree, hdr, y );
+		y->left = hdr->left;
+		y->left->parent = y;
+		y->red = hdr->red;
+	}
+
+	if ( black )
+		remove_fixup ( tree, n, p );
+
+	hdr->parent = hdr->left = hdr->right = NULL;
+
+	return hdr->object;
+}
+
+/*!
+ * Get next object in order
+ * \param hdr Element in tree
+ * \return object after given one, NULL if it is last
+ */
+void *rbtree_next ( rbtree_h *hdr )
+{
+	ASSERT ( hdr );
+
+	hdr = next_node ( hdr );
+
+	return hdr ? hdr->object : NULL;
+}
+
+#undef IS_RED
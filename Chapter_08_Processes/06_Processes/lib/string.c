@@ -1,6 +1,7 @@
 /*! Memory and string manipulation functions */
 
 #include <lib/string.h>
+#include <arch/string.h>
 
 /*!
  * Sets the first 'n' bytes of the block of memory pointed by 's' to the
@@ -13,6 +14,9 @@
  */
 void *memset ( void *s, int c, size_t n )
 {
+#ifdef ARCH_MEMSET
+	return arch_memset ( s, c, n );
+#else
 	size_t p;
 	char *m = (char *) s;
 
@@ -20,6 +24,7 @@ void *memset ( void *s, int c, size_t n )
 		*m = (char) c;
 
 	return s;
+#endif
 }
 
 /*!
@@ -53,6 +58,9 @@ void *memsetw (void *s, int c, size_t n)
  */
 void *memcpy ( void *dest, const void *src, size_t n )
 {
+#ifdef ARCH_MEMCPY
+	return arch_memcpy ( dest, src, n );
+#else
 	char *d = (char *) dest, *s = (char *) src;
 	size_t p;
 
@@ -60,6 +68,7 @@ void *memcpy ( void *dest, const void *src, size_t n )
 		*d = *s;
 
 	return dest;
+#endif
 }
 
 /*!
@@ -74,6 +83,9 @@ void *memcpy ( void *dest, const void *src, size_t n )
  */
 void *memmove ( void *dest, const void *src, size_t n )
 {
+#ifdef ARCH_MEMMOVE
+	return arch_memmove ( dest, src, n );
+#else
 	char *d, *s;
 	size_t p;
 
@@ -92,6 +104,7 @@ void *memmove ( void *dest, const void *src, size_t n )
 	}
 
 	return dest;
+#endif
 }
 
 /*!
@@ -0,0 +1,130 @@
+/*!
+ * Benchmark: kernel timer queue operations (as in kernel/time.c)
+ *
+ * Compared are sorted list (previous implementation, list_sort_add) and
+ * binary heap (heap.h) with up to 10000 armed timers. Operations:
+ * - arm: add timer with random expiration time
+ * - re-arm: remove timer from random position and add it with new time
+ * - expire: remove first timer (one-shot timer activation)
+ * Results from both queues are also compared (heap must give same order).
+ */
+
+#include <lib/heap.h>
+#include <lib/list.h>
+#include <types/bits.h>
+
+#define MAX_TIMERS	10000
+#define REARM		10000	/* re-arm operations per test */
+
+typedef struct _ktimer_t_
+{
+	uint	key;
+	list_h	list;
+	heap_h	heap;
+}
+ktimer_t;
+
+static ktimer_t timer[MAX_TIMERS];
+static heap_h *heap_mem[MAX_TIMERS];
+
+static list_t list;
+static heap_t heap;
+
+static int timer_cmp ( void *_a, void *_b )
+{
+	ktimer_t *a = _a, *b = _b;
+
+	return ( a->key > b->key ) - ( a->key < b->key );
+}
+
+static void add ( ktimer_t *t, int use_heap )
+{
+	if ( use_heap )
+		heap_insert ( &heap, t, &t->heap );
+	else
+		list_sort_add ( &list, t, &t->list, timer_cmp );
+}
+
+static void rem ( ktimer_t *t, int use_heap )
+{
+	if ( use_heap )
+		heap_remove ( &heap, &t->heap );
+	else
+		list_remove ( &list, 0, &t->list );
+}
+
+static ktimer_t *first ( int use_heap )
+{
+	if ( use_heap )
+		return heap_remove ( &heap, NULL );
+	else
+		return list_remove ( &list, FIRST, NULL );
+}
+
+/* expiration order of last run (to compare list with heap) */
+static uint order[MAX_TIMERS];
+
+/*! run test with 'n' timers, return costs (in ns) in 'arm', 'rearm', 'exp' */
+static void run ( uint n, int use_heap, unsigned long long cost[3] )
+{
+	unsigned long long t1, t2, t3, t4;
+	uint seed = 12345, i, j;
+	ktimer_t *t;
+
+	list_init ( &list );
+	heap_init ( &heap, timer_cmp, heap_mem, MAX_TIMERS );
+
+	t1 = test_time_ns ();
+	for ( i = 0; i < n; i++ )
+	{
+		timer[i].key = rand ( &seed ) << 14 | i; /* unique keys */
+		add ( &timer[i], use_heap );
+	}
+
+	t2 = test_time_ns ();
+	for ( i = 0; i < REARM; i++ )
+	{
+		j = rand ( &seed ) % n;
+		rem ( &timer[j], use_heap );
+		timer[j].key = rand ( &seed ) << 14 | j;
+		add ( &timer[j], use_heap );
+	}
+
+	t3 = test_time_ns ();
+	for ( i = 0; i < n; i++ )
+	{
+		t = first ( use_heap );
+		ASSERT ( t );
+		if ( use_heap )
+			ASSERT ( order[i] == t->key );
+		else
+			order[i] = t->key;
+	}
+	ASSERT ( !first ( use_heap ) );
+	t4 = test_time_ns ();
+
+	cost[0] = ( t2 - t1 ) / n;
+	cost[1] = ( t3 - t2 ) / REARM;
+	cost[2] = ( t4 - t3 ) / n;
+}
+
+int main ()
+{
+	uint n;
+	unsigned long long l[3], h[3];
+
+	printf ( "Timer queue cost per operation [ns]\n" );
+	printf ( "timers\tarm (list/heap)\tre-arm (list/heap)\t"
+		 "expire (list/heap)\n" );
+
+	for ( n = 10; n <= MAX_TIMERS; n *= 10 )
+	{
+		run ( n, FALSE, l ); /* list first: it records expected order */
+		run ( n, TRUE, h );
+
+		printf ( "%u\t%llu / %llu\t%llu / %llu\t\t%llu / %llu\n", n,
+			 l[0], h[0], l[1], h[1], l[2], h[2] );
+	}
+
+	return 0;
+}
@@ -0,0 +1,135 @@
+/*!
+ * Benchmark: ready queue bit mask operations performed by kthreads_schedule
+ *
+ * Each "schedule" step emulates master scheduler work on ready threads:
+ * - find highest priority ready thread (get_first_ready)
+ * - remove it from ready threads (kthread_remove_from_ready)
+ * - return previously active thread to ready threads (kthread_move_to_ready)
+ *
+ * Ready threads are kept at lower priorities (as is usual: most threads at
+ * default priority, idle thread at 0), which is the worst case for a linear
+ * scan from the highest priority downward.
+ *
+ * Compared are linear scan of flat mask (previous implementation) and
+ * hierarchical bit mask (prio_bitmap.h) for 64 to 4096 priority levels.
+ */
+
+#include <lib/prio_bitmap.h>
+
+#define MAX_LEVELS	4096
+#define READY_THREADS	8	/* ready threads at any time */
+#define READY_PRIO	32	/* ready threads have priority < READY_PRIO */
+#define ITERATIONS	2000000
+
+/*! flat mask - previous implementation (4 priorities per word) ------------- */
+static uint flat_mask[MAX_LEVELS];
+static uint flat_len;
+
+static void flat_set ( uint prio )
+{
+	flat_mask[prio / sizeof (uint)] |= (uint) ( 1 << prio % sizeof (uint) );
+}
+static void flat_clear ( uint prio )
+{
+	flat_mask[prio / sizeof (uint)] &= ~( (uint) ( 1 << prio % sizeof(uint)));
+}
+static int flat_highest ()
+{
+	int i;
+
+	for ( i = flat_len - 1; i >= 0; i-- )
+		if ( flat_mask[i] )
+			return i * sizeof (uint) + msb_index ( flat_mask[i] );
+
+	return -1;
+}
+
+/*! hierarchical mask ------------------------------------------------------- */
+static prio_bitmap_t bm;
+static uint32 bm_mem[MAX_LEVELS];
+
+/*! ready threads per priority (emulates ready queues) */
+static uint count[MAX_LEVELS];
+
+static unsigned long long run ( uint levels, int hierarchical )
+{
+	unsigned long long t1, t2;
+	uint seed = 12345, prio, i;
+	int first, sum = 0;
+
+	for ( i = 0; i < levels; i++ )
+		count[i] = 0;
+
+	flat_len = ( levels + sizeof (uint) - 1 ) / sizeof (uint);
+	for ( i = 0; i < flat_len; i++ )
+		flat_mask[i] = 0;
+
+	ASSERT ( prio_bitmap_size ( levels ) <= sizeof (bm_mem) );
+	prio_bitmap_init ( &bm, levels, bm_mem );
+
+	for ( i = 0; i < READY_THREADS; i++ )
+	{
+		prio = rand ( &seed ) % READY_PRIO;
+		count[prio]++;
+		if ( hierarchical )
+			prio_bitmap_set ( &bm, prio );
+		else
+			flat_set ( prio );
+	}
+
+	t1 = test_time_ns ();
+
+	for ( i = 0; i < ITERATIONS; i++ )
+	{
+		/* get_first_ready + kthread_remove_from_ready */
+		if ( hierarchical )
+			first = prio_bitmap_highest ( &bm );
+		else
+			first = flat_highest ();
+
+		ASSERT ( first >= 0 && count[first] > 0 );
+		sum += first;
+
+		if ( --count[first] == 0 )
+		{
+			if ( hierarchical )
+				prio_bitmap_clear ( &bm, first );
+			else
+				flat_clear ( first );
+		}
+
+		/* kthread_move_to_ready (previously active thread) */
+		prio = rand ( &seed ) % READY_PRIO;
+		count[prio]++;
+		if ( hierarchical )
+			prio_bitmap_set ( &bm, prio );
+		else
+			flat_set ( prio );
+	}
+
+	t2 = test_time_ns ();
+
+	ASSERT ( sum > 0 );
+
+	return ( t2 - t1 ) * 1000 / ITERATIONS; /* in picoseconds */
+}
+
+int main ()
+{
+	uint levels;
+	unsigned long long flat, hier;
+
+	printf ( "Ready queue bit mask cost per schedule step [ns]\n" );
+	printf ( "PRIO_LEVELS\tflat scan\thierarchical\n" );
+
+	for ( levels = 64; levels <= MAX_LEVELS; levels *= 2 )
+	{
+		flat = run ( levels, FALSE );
+		hier = run ( levels, TRUE );
+
+		printf ( "%u\t\t%llu.%03llu\t\t%llu.%03llu\n", levels,
+			 flat / 1000, flat % 1000, hier / 1000, hier % 1000 );
+	}
+
+	return 0;
+}
@@ -0,0 +1,220 @@
+/*!
+ * Test and benchmark: red-black tree as run queue of fair scheduler
+ * (as in kernel/sched_fair.c, threads ordered by virtual runtime)
+ *
+ * Operations:
+ * - tick: first thread runs (is removed), its vruntime is increased and it
+ *   is put back in tree
+ * - block/wake: thread at random position is removed and put back with
+ *   vruntime near smallest one
+ * Tree rules and order are checked after each round, and removed thread is
+ * compared with one from sorted list (equal keys must be in FIFO order in
+ * both). Cost per operation is compared with sorted list.
+ */
+
+#include <lib/rbtree.h>
+#include <lib/list.h>
+#include <types/bits.h>
+
+#define MAX_THREADS	10000
+#define STEPS		10000	/* tick and block/wake operations per test */
+
+typedef struct _thread_t_
+{
+	uint	  vruntime;
+	rbtree_h  node;
+	list_h	  list;
+}
+thread_t;
+
+static thread_t thread[MAX_THREADS];
+
+static rbtree_t tree;
+static list_t list;
+
+static int thread_cmp ( void *_a, void *_b )
+{
+	thread_t *a = _a, *b = _b;
+
+	return ( a->vruntime > b->vruntime ) - ( a->vruntime < b->vruntime );
+}
+
+/*! check tree rules, return black height of subtree */
+static int check ( rbtree_h *n, rbtree_h *parent, uint *cnt )
+{
+	int lh, rh;
+
+	if ( !n )
+		return 1;
+
+	ASSERT ( n->parent == parent );
+	ASSERT ( !n->red || ( !( n->left && n->left->red ) &&
+			      !( n->right && n->right->red ) ) );
+	if ( n->left )
+		ASSERT ( thread_cmp ( n->left->object, n->object ) <= 0 );
+	if ( n->right )
+		ASSERT ( thread_cmp ( n->object, n->right->object ) <= 0 );
+
+	lh = check ( n->left, n, cnt );
+	rh = check ( n->right, n, cnt );
+	ASSERT ( lh == rh );
+
+	(*cnt)++;
+
+	return lh + !n->red;
+}
+
+static void check_tree ()
+{
+	thread_t *t, *prev = NULL;
+	uint cnt = 0;
+
+	ASSERT ( !tree.root || !tree.root->red );
+	check ( tree.root, NULL, &cnt );
+	ASSERT ( cnt == tree.size );
+
+	/* in order walk gives same sequence as sorted list */
+	t = rbtree_get ( &tree );
+	ASSERT ( t == list_get ( &list, FIRST ) );
+	for ( cnt = 0; t; t = rbtree_next ( &t->node ), cnt++ )
+	{
+		if ( prev )
+			ASSERT ( list_get_next ( &prev->list ) == t );
+		prev = t;
+	}
+	ASSERT ( cnt == tree.size );
+}
+
+static void add ( thread_t *t, int use_tree )
+{
+	if ( use_tree )
+		rbtree_insert ( &tree, t, &t->node );
+	else
+		list_sort_add ( &list, t, &t->list, thread_cmp );
+}
+
+static void rem ( thread_t *t, int use_tree )
+{
+	if ( use_tree )
+		rbtree_remove ( &tree, &t->node );
+	else
+		list_remove ( &list, 0, &t->list );
+}
+
+static thread_t *first ( int use_tree )
+{
+	if ( use_tree )
+		return rbtree_remove ( &tree, NULL );
+	else
+		return list_remove ( &list, FIRST, NULL );
+}
+
+/*! run test with 'n' threads, return costs (in ns) in 'cost' */
+static void run ( uint n, int use_tree, unsigned long long cost[2] )
+{
+	unsigned long long t1, t2, t3;
+	uint seed = 12345, i, j;
+	thread_t *t;
+
+	rbtree_init ( &tree, thread_cmp );
+	list_init ( &list );
+
+	for ( i = 0; i < n; i++ )
+	{
+		thread[i].vruntime = rand ( &seed ) % 1000;
+		add ( &thread[i], use_tree );
+	}
+
+	t1 = test_time_ns ();
+	for ( i = 0; i < STEPS; i++ )
+	{
+		t = first ( use_tree );
+		ASSERT ( t );
+		t->vruntime += 1 + rand ( &seed ) % 100;
+		add ( t, use_tree );
+	}
+
+	t2 = test_time_ns ();
+	for ( i = 0; i < STEPS; i++ )
+	{
+		j = rand ( &seed ) % n;
+		rem ( &thread[j], use_tree );
+		t = use_tree ? rbtree_get ( &tree ) : list_get ( &list, FIRST );
+		thread[j].vruntime = t ? t->vruntime + rand ( &seed ) % 4 : 0;
+		add ( &thread[j], use_tree );
+	}
+	t3 = test_time_ns ();
+
+	cost[0] = ( t2 - t1 ) / STEPS;
+	cost[1] = ( t3 - t2 ) / STEPS;
+}
+
+/*! same operations on tree and list, removed threads must match */
+static void compare ( uint n )
+{
+	uint seed = 54321, i, j, r;
+	thread_t *t;
+
+	rbtree_init ( &tree, thread_cmp );
+	list_init ( &list );
+
+	for ( i = 0; i < n; i++ )
+	{
+		thread[i].vruntime = rand ( &seed ) % 10; /* many equal */
+		add ( &thread[i], TRUE );
+		add ( &thread[i], FALSE );
+	}
+	check_tree ();
+
+	for ( r = 0; r < 10; r++ )
+	{
+		for ( i = 0; i < n; i++ )
+		{
+			t = first ( TRUE );
+			ASSERT ( t == first ( FALSE ) );
+			t->vruntime += rand ( &seed ) % 3;
+			add ( t, TRUE );
+			add ( t, FALSE );
+
+			j = rand ( &seed ) % n;
+			rem ( &thread[j], TRUE );
+			rem ( &thread[j], FALSE );
+			if ( rand ( &seed ) % 2 && tree.size )
+			{
+				/* woken: placed at smallest vruntime */
+				t = rbtree_get ( &tree );
+				thread[j].vruntime = t->vruntime;
+			}
+			add ( &thread[j], TRUE );
+			add ( &thread[j], FALSE );
+		}
+		check_tree ();
+	}
+
+	while ( ( t = first ( TRUE ) ) )
+		ASSERT ( t == first ( FALSE ) );
+	ASSERT ( !first ( FALSE ) && !tree.root && !tree.size );
+}
+
+int main ()
+{
+	uint n;
+	unsigned long long l[2], t[2];
+
+	for ( n = 1; n <= 1000; n *= 10 )
+		compare ( n );
+
+	printf ( "Fair run queue cost per operation [ns]\n" );
+	printf ( "threads\ttick (list/tree)\tblock+wake (list/tree)\n" );
+
+	for ( n = 10; n <= MAX_THREADS; n *= 10 )
+	{
+		run ( n, FALSE, l );
+		run ( n, TRUE, t );
+
+		printf ( "%u\t%llu / %llu\t\t%llu / %llu\n", n,
+			 l[0], t[0], l[1], t[1] );
+	}
+
+	return 0;
+}
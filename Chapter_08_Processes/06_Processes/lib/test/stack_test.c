@@ -0,0 +1,245 @@
+/*!
+ * Benchmark: process stack pool (thread stacks, handler stacks, arguments)
+ *
+ * Emulated is process with LIVE_THREADS threads, where threads are constantly
+ * terminated and new ones created (random thread is replaced in each step).
+ * Some threads also receive a signal: handler stack and siginfo_t block
+ * are allocated and released with thread. Few blocks of random size stay
+ * allocated all the time (as arguments of first thread).
+ *
+ * Compared are first fit pool (ff_simple, previous implementation) and
+ * segregated fit allocator (sf_stack); cost of one step (create + exit) is
+ * measured in rounds, to show if it changes as pool gets fragmented. After
+ * last round (threads still live) free memory is split into blocks, largest
+ * first, to show how fragmented the pool is.
+ */
+
+#include <lib/ff_simple.h>
+#include <lib/sf_stack.h>
+#include <types/bits.h>
+
+#define POOL_SIZE	( 4 * 1024 * 1024 )
+#define THREAD_STACK	0x1000
+#define HANDLER_STACK	0x400
+#define ARGS_SIZE	32	/* sizeof (siginfo_t) */
+#define LIVE_THREADS	512
+#define FIXED_BLOCKS	64
+#define ROUNDS		6
+#define STEPS		100000	/* per round */
+
+struct thread
+{
+	void *stack, *handler, *args;
+};
+static struct thread thr[LIVE_THREADS];
+static void *fixed[FIXED_BLOCKS];
+
+static char mem[POOL_SIZE];
+static void *pool;
+static int use_sfs;
+
+static void *try_alloc ( size_t size )
+{
+	if ( use_sfs )
+		return sfs_alloc ( pool, size );
+	else
+		return ffs_alloc ( pool, size );
+}
+
+static void *alloc ( size_t size )
+{
+	void *p = try_alloc ( size );
+
+	ASSERT ( p );
+
+	*( (char *) p ) = 1; /* touch it, as thread would */
+
+	return p;
+}
+
+static void release ( void *p )
+{
+	if ( !p )
+		return;
+
+	if ( use_sfs )
+		sfs_free ( pool, p );
+	else
+		ffs_free ( pool, p );
+}
+
+/*! largest block that can be allocated (to 1 KB; found block is freed) */
+static size_t largest_free ()
+{
+	size_t low = 0, high = POOL_SIZE, mid;
+	void *p;
+
+	while ( high - low > 1024 )
+	{
+		mid = ( low + high ) / 2;
+		p = try_alloc ( mid );
+		if ( p )
+		{
+			release ( p );
+			low = mid;
+		}
+		else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+struct free_state
+{
+	size_t largest, total;
+	uint blocks;
+};
+
+/*! free blocks of at least 1 KB: allocate largest ones while possible */
+static void free_state ( struct free_state *fs )
+{
+	static void *block[LIVE_THREADS];
+	size_t size;
+	uint i;
+
+	fs->largest = largest_free ();
+	fs->total = 0;
+
+	for ( fs->blocks = 0; fs->blocks < LIVE_THREADS; fs->blocks++ )
+	{
+		size = largest_free ();
+		if ( size < 1024 )
+			break;
+
+		block[fs->blocks] = try_alloc ( size );
+		ASSERT ( block[fs->blocks] );
+		fs->total += size;
+	}
+
+	for ( i = 0; i < fs->blocks; i++ )
+		release ( block[i] );
+}
+
+static void thread_create ( struct thread *t, uint *seed )
+{
+	t->stack = alloc ( THREAD_STACK );
+
+	if ( rand ( seed ) % 4 == 0 )
+	{
+		t->args = alloc ( ARGS_SIZE );
+		t->handler = alloc ( HANDLER_STACK );
+	}
+	else {
+		t->args = t->handler = NULL;
+	}
+}
+
+static void thread_exit ( struct thread *t )
+{
+	release ( t->handler );
+	release ( t->args );
+	release ( t->stack );
+}
+
+static void run ( int sfs, unsigned long long result[ROUNDS],
+		  struct free_state *fs )
+{
+	size_t classes[3] = { THREAD_STACK, HANDLER_STACK, ARGS_SIZE };
+	unsigned long long t1, t2;
+	uint seed = 12345, i, r;
+	struct thread *t;
+
+	use_sfs = sfs;
+	if ( sfs )
+		pool = sfs_init ( mem, POOL_SIZE, classes, 3 );
+	else
+		pool = ffs_init ( mem, POOL_SIZE );
+	ASSERT ( pool );
+
+	for ( i = 0; i < LIVE_THREADS; i++ )
+	{
+		thread_create ( &thr[i], &seed );
+		if ( i < FIXED_BLOCKS )
+			fixed[i] = alloc ( 16 + rand ( &seed ) % 256 );
+	}
+
+	for ( r = 0; r < ROUNDS; r++ )
+	{
+		t1 = test_time_ns ();
+
+		for ( i = 0; i < STEPS; i++ )
+		{
+			t = &thr[rand ( &seed ) % LIVE_THREADS];
+
+			thread_exit ( t );
+			thread_create ( t, &seed );
+		}
+
+		t2 = test_time_ns ();
+
+		result[r] = ( t2 - t1 ) * 1000 / STEPS; /* in picoseconds */
+	}
+
+	free_state ( fs );
+
+	for ( i = 0; i < LIVE_THREADS; i++ )
+		thread_exit ( &thr[i] );
+	for ( i = 0; i < FIXED_BLOCKS; i++ )
+		release ( fixed[i] );
+}
+
+/*! blocks cached in one class must be reusable by other when pool is full */
+static void check_reclaim ()
+{
+	size_t classes[2] = { THREAD_STACK, HANDLER_STACK };
+	static void *block[POOL_SIZE / HANDLER_STACK];
+	uint i, n;
+
+	pool = sfs_init ( mem, POOL_SIZE, classes, 2 );
+	ASSERT ( pool );
+
+	for ( n = 0; ( block[n] = sfs_alloc ( pool, HANDLER_STACK ) ); n++ )
+		ASSERT ( n < POOL_SIZE / HANDLER_STACK );
+	ASSERT ( sfs_alloc ( pool, THREAD_STACK ) == NULL );
+
+	for ( i = 0; i < n; i++ )
+		sfs_free ( pool, block[i] );
+
+	/* four handler stacks (with headers) are larger than thread stack */
+	for ( i = 0; sfs_alloc ( pool, THREAD_STACK ); i++ )
+		;
+	ASSERT ( i >= n / 4 );
+}
+
+int main ()
+{
+	unsigned long long ff[ROUNDS], sf[ROUNDS];
+	struct free_state ff_free, sf_free;
+	uint r;
+
+	check_reclaim ();
+
+	run ( FALSE, ff, &ff_free );
+	run ( TRUE, sf, &sf_free );
+
+	printf ( "Thread create + exit, stack pool cost per step [ns]\n" );
+	printf ( "steps\t\tfirst fit\tsegregated fit\n" );
+
+	for ( r = 0; r < ROUNDS; r++ )
+		printf ( "%u\t\t%llu.%03llu\t\t%llu.%03llu\n",
+			 ( r + 1 ) * STEPS, ff[r] / 1000, ff[r] % 1000,
+			 sf[r] / 1000, sf[r] % 1000 );
+
+	printf ( "\nFree memory after %u steps (pool: %u KB)\n",
+		 ROUNDS * STEPS, POOL_SIZE / 1024 );
+	printf ( "largest [KB]\t%u\t\t%u\n", (uint) ff_free.largest / 1024,
+		 (uint) sf_free.largest / 1024 );
+	printf ( "blocks >= 1 KB\t%u\t\t%u\n", ff_free.blocks,
+		 sf_free.blocks );
+	printf ( "in them [KB]\t%u\t\t%u\n", (uint) ff_free.total / 1024,
+		 (uint) sf_free.total / 1024 );
+
+	return 0;
+}
@@ -0,0 +1,153 @@
+/*!
+ * Benchmark: memory copy and fill (arch/i386/string.h)
+ *
+ * Compared are byte loop (previous implementation of memcpy/memset in
+ * lib/string.c), rep movsl/stosl with alignment (arch_memcpy_words), the
+ * arch_memcpy/arch_memset used by lib/string.c (memcpy uses SSE2 for blocks of
+ * ARCH_MEM_SSE_MIN bytes or more) and host C library, for blocks from 8 B to
+ * 1 MB.
+ * Before measuring, results are compared with host C library, on unaligned
+ * addresses and for memmove also on overlapping blocks.
+ */
+
+#include <string.h>
+#include "test.h"
+#include <arch/string.h>
+#include <types/bits.h>
+
+#define MIN_SIZE	8
+#define MAX_SIZE	( 1 << 20 )
+#define BYTES_PER_TEST	( 64 << 20 )	/* bytes per measurement */
+
+static uint8 src[MAX_SIZE + 64], dst[MAX_SIZE + 64], ref[MAX_SIZE + 64];
+
+/*! previous implementations (byte by byte) */
+static void *byte_memcpy ( void *dest, const void *src, size_t n )
+{
+	volatile char *d = dest;
+	const char *s = src;
+	size_t p;
+
+	for ( p = 0; p < n; p++ )
+		d[p] = s[p];
+
+	return dest;
+}
+static void *byte_memset ( void *s, int c, size_t n )
+{
+	volatile char *m = s;
+	size_t p;
+
+	for ( p = 0; p < n; p++ )
+		m[p] = (char) c;
+
+	return s;
+}
+
+static void *words_memset ( void *s, int c, size_t n )
+{
+	return arch_memset_words ( s, c, n );
+}
+static void *words_memcpy ( void *dest, const void *src, size_t n )
+{
+	return arch_memcpy_words ( dest, src, n );
+}
+static void *arch_set ( void *s, int c, size_t n )
+{
+	return arch_memset ( s, c, n );
+}
+static void *arch_cpy ( void *dest, const void *src, size_t n )
+{
+	return arch_memcpy ( dest, src, n );
+}
+
+/*! compare with host library for all offsets and some sizes */
+static void check ()
+{
+	uint seed = 1, i;
+	size_t n, so, d_o;
+
+	for ( i = 0; i < sizeof (src); i++ )
+		src[i] = rand ( &seed );
+
+	for ( n = 0; n < 2048; n = n < 64 ? n + 1 : n * 2 + 3 )
+	for ( so = 0; so < 16; so++ )
+	for ( d_o = 0; d_o < 16; d_o++ )
+	{
+		memset ( dst, 0, n + 32 );
+		memset ( ref, 0, n + 32 );
+		arch_memcpy ( dst + d_o, src + so, n );
+		memcpy ( ref + d_o, src + so, n );
+		ASSERT ( !memcmp ( dst, ref, n + 32 ) );
+
+		arch_memset ( dst + d_o, so, n );
+		memset ( ref + d_o, so, n );
+		ASSERT ( !memcmp ( dst, ref, n + 32 ) );
+
+		/* overlapping blocks, both directions */
+		memcpy ( dst, src, n + 32 );
+		memcpy ( ref, src, n + 32 );
+		arch_memmove ( dst + d_o, dst + so, n );
+		memmove ( ref + d_o, ref + so, n );
+		ASSERT ( !memcmp ( dst, ref, n + 32 ) );
+	}
+}
+
+/*! throughput in MB/s */
+static unsigned long long cpy_speed ( void *(*f) ( void *, const void *,
+						   size_t ), size_t n )
+{
+	unsigned long long t1, t2;
+	size_t i, iters = BYTES_PER_TEST / n;
+
+	t1 = test_time_ns ();
+	for ( i = 0; i < iters; i++ )
+		f ( dst + ( i & 1 ), src, n );
+	t2 = test_time_ns ();
+
+	return (unsigned long long) iters * n * 1000 / ( t2 - t1 + 1 );
+}
+static unsigned long long set_speed ( void *(*f) ( void *, int, size_t ),
+				      size_t n )
+{
+	unsigned long long t1, t2;
+	size_t i, iters = BYTES_PER_TEST / n;
+
+	t1 = test_time_ns ();
+	for ( i = 0; i < iters; i++ )
+		f ( dst + ( i & 1 ), i, n );
+	t2 = test_time_ns ();
+
+	return (unsigned long long) iters * n * 1000 / ( t2 - t1 + 1 );
+}
+
+int main ()
+{
+	size_t n;
+
+	check ();
+
+	printf ( "Throughput [MB/s] (destination address is odd every "
+		 "second call)\n" );
+	printf ( "memcpy\n%-8s %10s %10s %10s %10s\n", "size", "bytes",
+		 "rep movsl", "arch", "host libc" );
+	for ( n = MIN_SIZE; n <= MAX_SIZE; n *= 2 )
+		printf ( "%-8lu %10llu %10llu %10llu %10llu\n",
+			 (unsigned long) n,
+			 cpy_speed ( byte_memcpy, n ),
+			 cpy_speed ( words_memcpy, n ),
+			 cpy_speed ( arch_cpy, n ),
+			 cpy_speed ( memcpy, n ) );
+
+	printf ( "memset\n%-8s %10s %10s %10s %10s\n", "size", "bytes",
+		 "rep stosl", "arch", "host libc" );
+	for ( n = MIN_SIZE; n <= MAX_SIZE; n *= 2 )
+		printf ( "%-8lu %10llu %10llu %10llu %10llu\n",
+			 (unsigned long) n,
+			 set_speed ( byte_memset, n ),
+			 set_speed ( words_memset, n ),
+			 set_speed ( arch_set, n ),
+			 set_speed ( memset, n ) );
+
+	return 0;
+}
@@ -0,0 +1,28 @@
+/*! standalone library tests (on development machine) */
+#pragma once
+
+#include <stdio.h>
+
+#define LOG(level, format, ...)	\
+printf ( "[" #level ":%s:%d]" format "\n", __FILE__, __LINE__, ##__VA_ARGS__)
+
+#define ASSERT(expr)					\
+do if ( !( expr ) )					\
+{							\
+	printf ( "[BUG:%s:%d]\n", __FILE__, __LINE__);	\
+	__builtin_trap ();				\
+} while(0)
+
+/*! time measurement in nanoseconds (host clock) */
+#include <time.h>
+
+static inline unsigned long long test_time_ns ()
+{
+	struct timespec t;
+
+	clock_gettime ( CLOCK_MONOTONIC, &t );
+
+	return (unsigned long long) t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+#undef NULL /* redefined in types/basic.h */
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <pthread.h>
 #include <time.h>
+#include <syscall.h>
 #include <arch/processor.h>
 
 char PROG_HELP[] = "EDF scheduling demonstration example.";
@@ -11,8 +12,11 @@ char EXTRA_INFO[] = "\n(manual loop calibration requied for optimal display of"
 
 #define THR_NUM	4
 #define TEST_DURATION	20 /* seconds */
+#define INFO_SIZE	200
 
 #define LOOPS	60000000 /* adjust manually per processor to be ~0,3 s */
+#define WCET	300000000 /* LOOPS duration [ns], declared at admission */
+#define CBS_BUDGET	100000000 /* [ns] per second for aperiodic thread */
 
 static timespec_t t0;
 static volatile int end;
@@ -32,16 +36,22 @@ static void *edf_thread ( void *param )
 {
 	int thr_no, i, j;
 	thr_no = (int) param;
-	timespec_t period, deadline;
+	timespec_t period, deadline, wcet;
 
 	i = thr_no;
 	period.tv_sec = thr_no * 1;
 	period.tv_nsec = 0;
 	deadline.tv_sec = thr_no / 2;
 	deadline.tv_nsec = (thr_no % 2) * 500000000;
+	wcet.tv_sec = 0;
+	wcet.tv_nsec = WCET;
 
 	message ( thr_no, "EDF_SET" );
-	edf_set ( deadline, period, EDF_TERMINATE);
+	if ( edf_set ( deadline, period, wcet, EDF_TERMINATE ) )
+	{
+		message ( thr_no, "Not admitted by EDF scheduler, exiting!" );
+		return NULL;
+	}
 
 	for ( i = 0; !end; i++ )
 	{
@@ -80,13 +90,37 @@ static void *unimportant_thread ( void *param )
 	return NULL;
 }
 
+/* aperiodic work (longer than its budget), served by CBS */
+static void *aperiodic_thread ( void *param )
+{
+	int thr_no, j;
+	timespec_t sleep;
+
+	thr_no = (int) param;
+	sleep.tv_sec = 0;
+	sleep.tv_nsec = 500000000;
+
+	while (!end)
+	{
+		message ( thr_no, "aperiodic request" );
+		for ( j = 1; j <= LOOPS / 2; j++ )
+			memory_barrier();
+		message ( thr_no, "aperiodic request done" );
+		nanosleep ( &sleep, NULL );
+	}
+
+	return NULL;
+}
+
 int edf ( char *args[] )
 {
-	pthread_t thread[THR_NUM + 1];
+	pthread_t thread[THR_NUM + 2];
 	pthread_attr_t attr;
 	sched_param_t sched_param;
-	int i;
+	int i, threads;
 	timespec_t sleep;
+	char info[INFO_SIZE];
+	char *sysinfo_args[] = { "sysinfo", "sched", NULL };
 
 	printf ( "Example program: [%s:%s]\n%s\n", __FILE__, __FUNCTION__,
 		 PROG_HELP );
@@ -105,9 +139,30 @@ int edf ( char *args[] )
 	pthread_attr_setschedparam ( &attr, &sched_param );
 
 	pthread_create ( &thread[i], &attr, unimportant_thread, (void *)(i+1) );
+	threads = THR_NUM + 1;
+
+	sched_param.sched_priority = THREAD_DEF_PRIO;
+	sched_param.supp.cbs.budget.tv_sec = 0;
+	sched_param.supp.cbs.budget.tv_nsec = CBS_BUDGET;
+	sched_param.supp.cbs.period.tv_sec = 1;
+	sched_param.supp.cbs.period.tv_nsec = 0;
+	pthread_attr_setschedpolicy ( &attr, SCHED_CBS );
+	pthread_attr_setschedparam ( &attr, &sched_param );
+
+	if ( pthread_create ( &thread[threads], &attr, aperiodic_thread,
+			      (void *) ( threads + 1 ) ) )
+		printf ( "Aperiodic thread not admitted by CBS scheduler\n" );
+	else
+		threads++;
 
 	printf ( "Threads created, giving them %d seconds\n", TEST_DURATION );
 
+	sleep.tv_sec = 0;
+	sleep.tv_nsec = 100000000;
+	nanosleep ( &sleep, NULL ); /* let EDF threads be admitted */
+	syscall ( SYSINFO, &info, INFO_SIZE, sysinfo_args );
+	printf ( "%s", info );
+
 	sleep.tv_sec = TEST_DURATION;
 	sleep.tv_nsec = 0;
 	nanosleep ( &sleep, NULL );
@@ -116,7 +171,7 @@ int edf ( char *args[] )
 
 	end = TRUE;
 
-	for ( i = 0; i < THR_NUM + 1; i++ )
+	for ( i = 0; i < threads; i++ )
 		pthread_join ( thread[i], NULL );
 
 	return 0;
@@ -0,0 +1,90 @@
+/*! Fair scheduling test example */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+#include <syscall.h>
+#include <arch/processor.h>
+
+char PROG_HELP[] = "Fair scheduling example: processor shares by nice value.";
+
+#define THR_NUM	4
+#define INNER_LOOP_COUNT 100000
+#define TEST_DURATION	10 /* seconds */
+#define INFO_SIZE	200
+
+/* last thread blocks after each outer loop iteration */
+static int nice[THR_NUM] = { -5, 0, 5, 0 };
+static int iters[THR_NUM];
+static volatile int end;
+
+/* example threads */
+static void *fair_thread ( void *param )
+{
+	int i, j, thr_no;
+	timespec_t nap = { 0, 10000000 };
+
+	thr_no = (int) param;
+
+	printf ( "Fair thread %d (nice %d) starting\n", thr_no, nice[thr_no] );
+	for ( i = 1; !end; i++ )
+	{
+		for ( j = 0; j < INNER_LOOP_COUNT && !end; j++ )
+			memory_barrier ();
+
+		iters[thr_no]++;
+
+		if ( thr_no == THR_NUM - 1 )
+			nanosleep ( &nap, NULL );
+	}
+	printf ( "Fair thread %d exiting\n", thr_no );
+
+	return NULL;
+}
+
+int fair ( char *args[] )
+{
+	pthread_t thread[THR_NUM];
+	pthread_attr_t attr;
+	sched_param_t sched_param;
+	char info[INFO_SIZE];
+	char *sysinfo_args[] = { "sysinfo", "sched", NULL };
+	int i;
+	timespec_t sleep;
+
+	printf ( "Example program: [%s:%s]\n%s\n\n", __FILE__, __FUNCTION__,
+		 PROG_HELP );
+
+	sched_param.sched_priority = THREAD_DEF_PRIO/2 + 1;
+	pthread_attr_init ( &attr );
+	pthread_attr_setschedpolicy ( &attr, SCHED_FAIR );
+
+	end = FALSE;
+
+	for ( i = 0; i < THR_NUM; i++ )
+	{
+		iters[i] = 0;
+		sched_param.supp.fair.nice = nice[i];
+		pthread_attr_setschedparam ( &attr, &sched_param );
+		pthread_create ( &thread[i], &attr, fair_thread, (void *) i );
+	}
+
+	printf ( "Threads created, giving them %d seconds\n", TEST_DURATION );
+	sleep.tv_sec = TEST_DURATION;
+	sleep.tv_nsec = 0;
+	nanosleep ( &sleep, NULL );
+
+	syscall ( SYSINFO, &info, INFO_SIZE, sysinfo_args );
+	printf ( "%s", info );
+
+	printf ( "Test over - threads are to be canceled\n");
+	end = TRUE;
+
+	for ( i = 0; i < THR_NUM; i++ )
+		pthread_join ( thread[i], NULL );
+	for ( i = 0; i < THR_NUM; i++ )
+		printf ( "Thread %d, nice=%d, count=%d\n", i, nice[i],
+			 iters[i] );
+
+	return 0;
+}
@@ -0,0 +1,191 @@
+/*! Priority tests: inheritance over chain of mutexes, priority of waiters */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+#include <lib/string.h>
+
+char PROG_HELP[] = "Priority inheritance over chain of two mutexes: high "
+		   "priority thread\nwaits on mutex of thread which waits on "
+		   "mutex of low priority thread,\nwhile middle priority "
+		   "thread would like to use processor.\nThen priority of "
+		   "thread waiting on mutex is raised above other waiter.";
+
+#define PRIO_MAIN	( THREAD_DEF_PRIO + 10 )
+#define PRIO_LOW	( THREAD_DEF_PRIO + 1 )	/* L: owns m1 */
+#define PRIO_CHAIN	( THREAD_DEF_PRIO + 2 )	/* K: owns m2, waits on m1 */
+#define PRIO_MIDDLE	( THREAD_DEF_PRIO + 3 )	/* M: only computes */
+#define PRIO_HIGH	( THREAD_DEF_PRIO + 5 )	/* H: waits on m2 */
+
+static pthread_mutex_t m1, m2, mx;
+
+/* order in which threads finished their work */
+static char order[8];
+static int finished;
+
+/* busy loop for given time */
+static void work ( int ms )
+{
+	timespec_t t, until;
+
+	clock_gettime ( CLOCK_REALTIME, &until );
+	t.tv_sec = ms / 1000;
+	t.tv_nsec = ( ms % 1000 ) * 1000000;
+	time_add ( &until, &t );
+
+	do
+		clock_gettime ( CLOCK_REALTIME, &t );
+	while ( time_cmp ( &t, &until ) < 0 );
+}
+
+static void msleep ( int ms )
+{
+	timespec_t t;
+
+	t.tv_sec = ms / 1000;
+	t.tv_nsec = ( ms % 1000 ) * 1000000;
+	nanosleep ( &t, NULL );
+}
+
+static void *low ( void *param )
+{
+	pthread_mutex_lock ( &m1 );
+	work ( 200 );
+	order[finished++] = 'L';
+	pthread_mutex_unlock ( &m1 );
+
+	return NULL;
+}
+
+static void *chain ( void *param )
+{
+	pthread_mutex_lock ( &m2 );
+	pthread_mutex_lock ( &m1 );
+	order[finished++] = 'K';
+	pthread_mutex_unlock ( &m1 );
+	pthread_mutex_unlock ( &m2 );
+
+	return NULL;
+}
+
+static void *middle ( void *param )
+{
+	work ( 1000 );
+	order[finished++] = 'M';
+
+	return NULL;
+}
+
+static void *high ( void *param )
+{
+	pthread_mutex_lock ( &m2 );
+	order[finished++] = 'H';
+	pthread_mutex_unlock ( &m2 );
+
+	return NULL;
+}
+
+static void *waiter ( void *param )
+{
+	pthread_mutex_lock ( &mx );
+	order[finished++] = (char) (int) param;
+	pthread_mutex_unlock ( &mx );
+
+	return NULL;
+}
+
+/* create thread with given (FIFO) priority */
+static void start ( pthread_t *thread, void *(*func) (void *), void *arg,
+		    int prio )
+{
+	pthread_attr_t attr;
+	sched_param_t param;
+
+	pthread_attr_init ( &attr );
+	param.sched_priority = prio;
+	pthread_attr_setschedparam ( &attr, &param );
+	pthread_create ( thread, &attr, func, arg );
+}
+
+/* L, K and H must finish before M, which has higher priority than L and K */
+static void pi_chain ()
+{
+	pthread_t thread[4];
+	pthread_mutexattr_t attr;
+	int i;
+
+	pthread_mutexattr_init ( &attr );
+	pthread_mutexattr_setprotocol ( &attr, PTHREAD_PRIO_INHERIT );
+	pthread_mutex_init ( &m1, &attr );
+	pthread_mutex_init ( &m2, &attr );
+	finished = 0;
+
+	start ( &thread[0], low, NULL, PRIO_LOW );	/* L locks m1 */
+	msleep ( 10 );
+	start ( &thread[1], chain, NULL, PRIO_CHAIN );	/* K: m2, waits m1 */
+	msleep ( 10 );
+	start ( &thread[2], middle, NULL, PRIO_MIDDLE );
+	start ( &thread[3], high, NULL, PRIO_HIGH );	/* H waits on m2 */
+
+	/* H boosts K and (through K) L above M */
+	for ( i = 0; i < 4; i++ )
+		pthread_join ( thread[i], NULL );
+
+	order[finished] = 0;
+	printf ( "Threads finished in order: %s (expected LKHM) - %s\n",
+		 order, strcmp ( order, "LKHM" ) ? "FAILED" : "OK" );
+
+	pthread_mutex_destroy ( &m1 );
+	pthread_mutex_destroy ( &m2 );
+}
+
+/* waiter whose priority is raised while blocked must get mutex first */
+static void waiters ()
+{
+	pthread_t thread[2];
+	pthread_mutexattr_t attr;
+	sched_param_t param;
+	int i;
+
+	/* kernel mutex object: waiters are in priority ordered queue */
+	pthread_mutexattr_init ( &attr );
+	attr.flags |= PTHREAD_PROCESS_SHARED;
+	pthread_mutex_init ( &mx, &attr );
+	finished = 0;
+
+	pthread_mutex_lock ( &mx );
+	start ( &thread[0], waiter, (void *) '1', PRIO_LOW );
+	start ( &thread[1], waiter, (void *) '2', PRIO_CHAIN );
+	msleep ( 10 );
+
+	/* both are blocked, '2' is first; move '1' in front of it */
+	param.sched_priority = PRIO_HIGH;
+	pthread_setschedparam ( thread[0], SCHED_FIFO, &param );
+	pthread_mutex_unlock ( &mx );
+
+	for ( i = 0; i < 2; i++ )
+		pthread_join ( thread[i], NULL );
+
+	order[finished] = 0;
+	printf ( "Waiters got mutex in order: %s (expected 12) - %s\n",
+		 order, strcmp ( order, "12" ) ? "FAILED" : "OK" );
+
+	pthread_mutex_destroy ( &mx );
+}
+
+int prio ( char *args[] )
+{
+	sched_param_t param;
+
+	printf ( "Example program: [%s:%s]\n%s\n\n", __FILE__, __FUNCTION__,
+		 PROG_HELP );
+
+	/* this thread only starts others (they run when it sleeps) */
+	param.sched_priority = PRIO_MAIN;
+	pthread_setschedparam ( pthread_self (), SCHED_FIFO, &param );
+
+	pi_chain ();
+	waiters ();
+
+	return 0;
+}
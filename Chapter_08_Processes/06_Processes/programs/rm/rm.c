@@ -0,0 +1,111 @@
+/*! Rate Monotonic scheduling test example */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+#include <syscall.h>
+
+char PROG_HELP[] = "Rate Monotonic scheduling: priorities are assigned by "
+"period,\nlast thread is rejected by response time analysis.";
+
+#define THR_NUM	4
+#define TEST_DURATION	5 /* seconds */
+#define INFO_SIZE	200
+
+/* periods and worst case execution times [ms] (last thread: U > 1) */
+static int period_ms[THR_NUM] = { 200, 400, 800, 600 };
+static int wcet_ms[THR_NUM] = { 50, 100, 200, 250 };
+
+static int jobs[THR_NUM], missed[THR_NUM];
+static volatile int end;
+
+/* busy loop for given time */
+static void work ( int ms )
+{
+	timespec_t t, until;
+
+	clock_gettime ( CLOCK_REALTIME, &until );
+	t.tv_sec = ms / 1000;
+	t.tv_nsec = ( ms % 1000 ) * 1000000;
+	time_add ( &until, &t );
+
+	do
+		clock_gettime ( CLOCK_REALTIME, &t );
+	while ( time_cmp ( &t, &until ) < 0 );
+}
+
+/* periodic RM thread */
+static void *rm_thread ( void *param )
+{
+	int thr_no;
+	timespec_t period, wcet, next, now;
+
+	thr_no = (int) param;
+	period.tv_sec = period_ms[thr_no] / 1000;
+	period.tv_nsec = ( period_ms[thr_no] % 1000 ) * 1000000;
+	wcet.tv_sec = wcet_ms[thr_no] / 1000;
+	wcet.tv_nsec = ( wcet_ms[thr_no] % 1000 ) * 1000000;
+
+	if ( rm_set ( period, wcet ) )
+	{
+		printf ( "RM thread %d (T=%d ms, C=%d ms) not admitted\n",
+			 thr_no, period_ms[thr_no], wcet_ms[thr_no] );
+		return NULL;
+	}
+	printf ( "RM thread %d (T=%d ms, C=%d ms) admitted\n",
+		 thr_no, period_ms[thr_no], wcet_ms[thr_no] );
+
+	clock_gettime ( CLOCK_REALTIME, &next );
+	while ( !end )
+	{
+		/* use a bit less than declared */
+		work ( wcet_ms[thr_no] * 3 / 4 );
+		jobs[thr_no]++;
+
+		time_add ( &next, &period );
+		clock_gettime ( CLOCK_REALTIME, &now );
+		if ( time_cmp ( &now, &next ) > 0 )
+			missed[thr_no]++;
+
+		clock_nanosleep ( CLOCK_REALTIME, TIMER_ABSTIME, &next, NULL );
+	}
+
+	return NULL;
+}
+
+int rm ( char *args[] )
+{
+	pthread_t thread[THR_NUM];
+	char info[INFO_SIZE];
+	char *sysinfo_args[] = { "sysinfo", "sched", NULL };
+	timespec_t sleep;
+	int i;
+
+	printf ( "Example program: [%s:%s]\n%s\n\n", __FILE__, __FUNCTION__,
+		 PROG_HELP );
+
+	end = FALSE;
+
+	for ( i = 0; i < THR_NUM; i++ )
+	{
+		jobs[i] = missed[i] = 0;
+		pthread_create ( &thread[i], NULL, rm_thread, (void *) i );
+	}
+
+	sleep.tv_sec = TEST_DURATION;
+	sleep.tv_nsec = 0;
+	nanosleep ( &sleep, NULL );
+
+	syscall ( SYSINFO, &info, INFO_SIZE, sysinfo_args );
+	printf ( "%s", info );
+
+	end = TRUE;
+
+	for ( i = 0; i < THR_NUM; i++ )
+		pthread_join ( thread[i], NULL );
+	for ( i = 0; i < THR_NUM; i++ )
+		printf ( "Thread %d, jobs=%d, deadlines missed=%d\n", i,
+			 jobs[i], missed[i] );
+
+	return 0;
+}
@@ -33,7 +33,7 @@ int run_all ( char *args[] )
 
 	char progs_to_start[] = {
 		"hello timer args uthreads threads semaphores "
-		"monitors messages signals rr edf" };
+		"monitors messages signals rr edf fair rm prio" };
 	progname = progs_to_start;
 
 #endif
@@ -18,6 +18,32 @@ static sem_t filled, empty, crit1, crit2;
 
 static int buffer[BUFF_SIZE], in, out;
 
+#define ITERATIONS	100000	/* for measuring wait/post cost */
+
+/* average cost of sem_wait+sem_post pair (not blocking), in nanoseconds */
+static int sem_cost ( int pshared )
+{
+	sem_t sem;
+	timespec_t t1, t2;
+	int i;
+
+	sem_init ( &sem, pshared, 1 );
+
+	clock_gettime ( CLOCK_REALTIME, &t1 );
+	for ( i = 0; i < ITERATIONS; i++ )
+	{
+		sem_wait ( &sem );
+		sem_post ( &sem );
+	}
+	clock_gettime ( CLOCK_REALTIME, &t2 );
+
+	sem_destroy ( &sem );
+
+	time_sub ( &t2, &t1 );
+
+	return ( t2.tv_sec * 1000000 + t2.tv_nsec / 1000 ) / (ITERATIONS/1000);
+}
+
 /* consumer thread */
 static void *consumer ( void *param )
 {
@@ -105,6 +131,9 @@ int semaphores ( char *args[] )
 	printf ( "Example program: [%s:%s]\n%s\n\n", __FILE__, __FUNCTION__,
 		 PROG_HELP );
 
+	printf ( "Uncontended wait+post: %d ns (futex), ", sem_cost ( FALSE ) );
+	printf ( "%d ns (kernel object)\n\n", sem_cost ( TRUE ) );
+
 	sleep.tv_sec = 1;
 	sleep.tv_nsec = 0;
 
@@ -2,7 +2,6 @@
 
 #include <stdio.h>
 #include <lib/string.h>
-#include <time.h>
 #include <syscall.h>
 #include <pthread.h>
 
@@ -39,7 +38,6 @@ int shell ( char *args[] )
 {
 	char cmd[MAXCMDLEN + 1];
 	int i, key, rv;
-	timespec_t t;
 	int argnum;
 	char *argval[MAXARGS + 1];
 	pthread_t thr;
@@ -47,9 +45,6 @@ int shell ( char *args[] )
 	printf ( "\n*** Simple shell interpreter ***\n\n" );
 	help ();
 
-	t.tv_sec = 0;
-	t.tv_nsec = 100000000; /* 100 ms */
-
 	while (1)
 	{
 		new_cmd:
@@ -61,13 +56,11 @@ int shell ( char *args[] )
 		/* get command - get chars until new line is received */
 		while ( i < MAXCMDLEN )
 		{
+			/* blocks until key is pressed */
 			key = get_char ();
 
 			if ( !key )
-			{
-				nanosleep ( &t, NULL );
-				continue;
-			}
+				continue; /* interrupted read */
 
 			if ( key == '\n' || key == '\r')
 			{
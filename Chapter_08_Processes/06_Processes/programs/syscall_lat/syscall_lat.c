@@ -0,0 +1,111 @@
+/*! System call latency: cost of returning from kernel with/without switch */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+#include <syscall.h>
+#include <lib/string.h>
+
+char PROG_HELP[] = "Syscall latency: average duration of the same system "
+		   "call (pthread_setschedparam)\nwhen it does not change "
+		   "ready threads (rescheduling is skipped) and when it\n"
+		   "changes priority of active thread (full rescheduling).";
+
+#define CALLS		100000
+#define INFO_SIZE	400
+
+/*! average time per call in nanoseconds, from t0 to now */
+static int per_call ( timespec_t *t0, int calls )
+{
+	timespec_t t;
+
+	clock_gettime ( CLOCK_REALTIME, &t );
+	time_sub ( &t, t0 );
+
+	return ( t.tv_sec * 1000000 + t.tv_nsec / 1000 ) * 10 / ( calls / 100 );
+}
+
+/*! number following 'name' in 'info' (0 if not found) */
+static uint info_field ( char *info, char *name )
+{
+	char *p = strstr ( info, name );
+	uint n = 0;
+
+	if ( p )
+		for ( p += strlen ( name ); *p >= '0' && *p <= '9'; p++ )
+			n = n * 10 + *p - '0';
+
+	return n;
+}
+
+/*! master scheduler counters: kthreads_schedule calls and full ones */
+static void sched_counters ( uint *calls, uint *full )
+{
+	char info[INFO_SIZE];
+	char *sysinfo_args[] = { "sysinfo", "sched", NULL };
+
+	syscall ( SYSINFO, &info, INFO_SIZE, sysinfo_args );
+	*calls = info_field ( info, "calls=" );
+	*full = info_field ( info, "full=" );
+}
+
+/*! print average duration and skipped/full rescheduling since last call */
+static void report ( char *name, timespec_t *t0, int calls )
+{
+	static uint last_calls, last_full;
+	uint sched_calls, full;
+	int ns;
+
+	if ( name )
+	{
+		ns = per_call ( t0, calls );
+		sched_counters ( &sched_calls, &full );
+		printf ( "%s\t%d ns (reschedule skipped: %u, full: %u)\n",
+			 name, ns, sched_calls - last_calls - full + last_full,
+			 full - last_full );
+	}
+
+	/* without calls from sched_counters itself */
+	sched_counters ( &last_calls, &last_full );
+}
+
+int syscall_lat ( char *args[] )
+{
+	pthread_t self;
+	sched_param_t param, other;
+	timespec_t t0, t;
+	int i;
+
+	printf ( "Example program: [%s:%s]\n%s\n\n", __FILE__, __FUNCTION__,
+		 PROG_HELP );
+
+	self = pthread_self ();
+	param.sched_priority = THREAD_DEF_PRIO;
+	other.sched_priority = THREAD_DEF_PRIO + 1;
+	pthread_setschedparam ( self, SCHED_FIFO, &param );
+
+	report ( NULL, NULL, 0 );
+
+	/* no scheduling in syscall */
+	clock_gettime ( CLOCK_REALTIME, &t0 );
+	for ( i = 0; i < CALLS; i++ )
+		clock_gettime ( CLOCK_REALTIME, &t );
+	report ( "clock_gettime:\t\t", &t0, CALLS );
+
+	/* same priority: nothing changed, kthreads_schedule returns early */
+	clock_gettime ( CLOCK_REALTIME, &t0 );
+	for ( i = 0; i < CALLS; i++ )
+		pthread_setschedparam ( self, SCHED_FIFO, &param );
+	report ( "setschedparam (same):\t", &t0, CALLS );
+
+	/* priority changes each time: thread is requeued, full rescheduling */
+	clock_gettime ( CLOCK_REALTIME, &t0 );
+	for ( i = 0; i < CALLS; i++ )
+		pthread_setschedparam ( self, SCHED_FIFO,
+					i % 2 ? &param : &other );
+	report ( "setschedparam (changed):", &t0, CALLS );
+
+	pthread_setschedparam ( self, SCHED_FIFO, &param );
+
+	return 0;
+}
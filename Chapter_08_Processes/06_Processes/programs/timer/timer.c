@@ -3,9 +3,11 @@
 #include <stdio.h>
 #include <time.h>
 
-char PROG_HELP[] = "Timer interface demonstration: periodic timer activations.";
+char PROG_HELP[] = "Timer interface demonstration: periodic timer activations"
+		   ",\nprocessor time clock and budget timer.";
 
 static timespec_t t0;
+static volatile int budget_spent;
 
 static void alarm_nt ( sigval_t param )
 {
@@ -20,6 +22,27 @@ static void alarm_nt ( sigval_t param )
 		t.tv_sec, t.tv_nsec/100000000, num, num );
 }
 
+static void budget_nt ( sigval_t param )
+{
+	budget_spent = TRUE;
+}
+
+/*! use 'ms' milliseconds of processor time */
+static void spend ( int ms )
+{
+	timespec_t t, end;
+
+	clock_gettime ( CLOCK_THREAD_CPUTIME_ID, &end );
+	t.tv_sec = ms / 1000;
+	t.tv_nsec = ( ms % 1000 ) * 1000000;
+	time_add ( &end, &t );
+
+	do {
+		clock_gettime ( CLOCK_THREAD_CPUTIME_ID, &t );
+	}
+	while ( time_cmp ( &t, &end ) < 0 );
+}
+
 int timer ( char *args[] )
 {
 	timespec_t t;
@@ -69,5 +92,36 @@ int timer ( char *args[] )
 	timer_delete ( &timer1 );
 	timer_delete ( &timer2 );
 
+	/* budget timer: expires after thread uses 300 ms of processor time */
+	budget_spent = FALSE;
+	evp.sigev_notify_function = budget_nt;
+	evp.sigev_value.sival_int = 0;
+	timer_create ( CLOCK_THREAD_CPUTIME_ID, &evp, &timer1 );
+
+	t1.it_interval.tv_sec = t1.it_interval.tv_nsec = 0;
+	t1.it_value.tv_sec = 0;
+	t1.it_value.tv_nsec = 300000000;
+	timer_settime ( &timer1, 0, &t1, NULL );
+
+	/* notification thread has same priority as this one: it runs only
+	 * when this thread blocks, so processor is used in short bursts */
+	while ( !budget_spent )
+	{
+		spend ( 10 );
+
+		t.tv_sec = 0;
+		t.tv_nsec = 1000000;
+		clock_nanosleep ( CLOCK_REALTIME, 0, &t, NULL );
+	}
+
+	clock_gettime ( CLOCK_THREAD_CPUTIME_ID, &t );
+	printf ( "Budget spent: thread time %d ms, ",
+		 t.tv_sec * 1000 + t.tv_nsec / 1000000 );
+	clock_gettime ( CLOCK_PROCESS_CPUTIME_ID, &t );
+	printf ( "process time %d ms\n",
+		 t.tv_sec * 1000 + t.tv_nsec / 1000000 );
+
+	timer_delete ( &timer1 );
+
 	return 0;
 }
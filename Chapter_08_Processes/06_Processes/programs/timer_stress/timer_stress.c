@@ -0,0 +1,117 @@
+/*! Timer stress test: many armed timers (cost of timer queue operations) */
+
+#include <stdio.h>
+#include <malloc.h>
+#include <time.h>
+#include <types/bits.h>
+
+char PROG_HELP[] = "Timer stress: create, arm, re-arm, disarm and delete "
+		   "many timers; average cost of each operation.";
+
+#define TIMERS		10000
+
+/* expiration times are spread over [BASE_SEC, BASE_SEC + SPREAD_MS/1000) */
+#define BASE_SEC	1000
+#define SPREAD_MS	60000
+
+static timer_t *timer;
+
+/*! average time per operation in nanoseconds, from t0 to now */
+static int per_op ( timespec_t *t0, int ops )
+{
+	timespec_t t;
+
+	clock_gettime ( CLOCK_REALTIME, &t );
+	time_sub ( &t, t0 );
+
+	return ( t.tv_sec * 1000000 + t.tv_nsec / 1000 ) * 10 / ( ops / 100 );
+}
+
+/*! arm all timers with pseudo random expiration times (relative) */
+static int arm_all ( int n, uint *seed )
+{
+	itimerspec_t it;
+	timespec_t t0;
+	int i, ms, errors = 0;
+
+	it.it_interval.tv_sec = 0;
+	it.it_interval.tv_nsec = 0;
+
+	clock_gettime ( CLOCK_REALTIME, &t0 );
+
+	for ( i = 0; i < n; i++ )
+	{
+		ms = rand ( seed ) % SPREAD_MS;
+		it.it_value.tv_sec = BASE_SEC + ms / 1000;
+		it.it_value.tv_nsec = ( ms % 1000 ) * 1000000;
+		if ( timer_settime ( &timer[i], 0, &it, NULL ) )
+			errors++;
+	}
+
+	if ( errors )
+		printf ( "timer_settime failed %d times!\n", errors );
+
+	return per_op ( &t0, n );
+}
+
+int timer_stress ( char *args[] )
+{
+	sigevent_t evp;
+	itimerspec_t it;
+	timespec_t t0;
+	int i, n, cost;
+	uint seed = 1;
+
+	printf ( "Example program: [%s:%s]\n%s\n\n", __FILE__, __FUNCTION__,
+		 PROG_HELP );
+
+	timer = malloc ( TIMERS * sizeof (timer_t) );
+	if ( !timer )
+	{
+		printf ( "Not enough memory for %d timers!\n", TIMERS );
+		return -1;
+	}
+
+	evp.sigev_notify = SIGEV_NONE;
+	evp.sigev_notify_attributes = NULL;
+	evp.sigev_value.sival_int = 0;
+
+	/* create */
+	clock_gettime ( CLOCK_REALTIME, &t0 );
+	for ( n = 0; n < TIMERS; n++ )
+		if ( timer_create ( CLOCK_REALTIME, &evp, &timer[n] ) )
+			break;
+	if ( n < 100 )
+	{
+		printf ( "Only %d timers created!\n", n );
+		return -1;
+	}
+	cost = per_op ( &t0, n );
+	printf ( "Timers: %d\n", n );
+	printf ( "create:\t%d ns\n", cost );
+
+	/* arm: heap grows from 0 to n timers */
+	printf ( "arm:\t%d ns\n", arm_all ( n, &seed ) );
+
+	/* re-arm: each timer is removed and inserted again, n timers armed */
+	printf ( "re-arm:\t%d ns\n", arm_all ( n, &seed ) );
+
+	/* disarm: in creation order, i.e. from random positions in queue */
+	it.it_value.tv_sec = it.it_value.tv_nsec = 0;
+	it.it_interval.tv_sec = it.it_interval.tv_nsec = 0;
+	clock_gettime ( CLOCK_REALTIME, &t0 );
+	for ( i = 0; i < n; i++ )
+		timer_settime ( &timer[i], 0, &it, NULL );
+	printf ( "disarm:\t%d ns\n", per_op ( &t0, n ) );
+
+	/* delete armed timers */
+	arm_all ( n, &seed );
+	clock_gettime ( CLOCK_REALTIME, &t0 );
+	for ( i = 0; i < n; i++ )
+		timer_delete ( &timer[i] );
+	printf ( "delete:\t%d ns (armed timers)\n", per_op ( &t0, n ) );
+
+	free ( timer );
+
+	return 0;
+}